@@ -23,6 +23,16 @@
  
 #define DEBUG_LOG_ENABLE 
 
+/**
+ * @brief Tokenized binary records instead of text lines
+ * @details Each call sends its message string's flash address, the tick and
+ *          the integer arguments (ws_logtok.h) and skips snprintf; lines are
+ *          3-4x shorter on UART and in the SD status log. An RTC TIME record
+ *          precedes the first line of each minute. Decode with
+ *          tools/ws_protocol_host `ws_logdecode` and the ELF of the same build.
+ */
+//#define DEBUG_LOG_TOKENIZED
+
 /**
  * @brief Enable individual log categories
  * @details Comment out specific categories to reduce log verbosity
@@ -42,12 +52,94 @@
  */
 #define DEBUG_HEARTBEAT_INTERVAL_MS 60000U  /* 1 minute */
 
+/* ============================================================================
+ * RUNTIME LEVELS
+ * ========================================================================== */
+
+/**
+ * @brief Modules with their own runtime log level
+ * @details A source file selects its module by defining DEBUG_LOG_MODULE
+ *          before its first include; files that do not default to SYS.
+ */
+typedef enum {
+  DEBUG_MOD_SYS = 0U,  /**< Boot, resets, everything uncategorised */
+  DEBUG_MOD_RADIO,     /**< nRF24 cycles and link (NRF:) */
+  DEBUG_MOD_SD,        /**< SD logger (SD:) */
+  DEBUG_MOD_UI,        /**< Menu actions and view transitions */
+  DEBUG_MOD_RTC,       /**< DS3231 alarms (RTC:) */
+  DEBUG_MOD_POWER,     /**< STOP mode entry and exit (PWR:) */
+  DEBUG_MOD_COUNT      /**< Number of modules */
+} Debug_Module_t;
+
+/** @brief Log levels; a line is sent when its level <= the module's level */
+#define DEBUG_LVL_OFF   0U  /**< Module silent */
+#define DEBUG_LVL_ERROR 1U  /**< Failures that lose data or need recovery */
+#define DEBUG_LVL_WARN  2U  /**< Retries, drops, degraded operation */
+#define DEBUG_LVL_INFO  3U  /**< State changes worth a line in normal use */
+#define DEBUG_LVL_DEBUG 4U  /**< Per-cycle and per-packet tracing */
+
+/** @brief Level of every module after reset */
+#define DEBUG_LVL_DEFAULT DEBUG_LVL_INFO
+
+#ifndef DEBUG_LOG_MODULE
+#define DEBUG_LOG_MODULE DEBUG_MOD_SYS
+#endif
+
+/**
+ * @brief Runtime log configuration
+ */
+typedef struct {
+  uint8_t level[DEBUG_MOD_COUNT];  /**< DEBUG_LVL_* per Debug_Module_t */
+} Debug_Config_t;
+
 /* ============================================================================
  * PUBLIC API
  * ========================================================================== */
 
 #ifdef DEBUG_LOG_ENABLE
 
+/** @brief Current levels; written by the UART command handler */
+extern volatile Debug_Config_t debug_config;
+
+/** @brief Whether @p module logs at @p lvl (a single byte compare) */
+#define Debug_On(module, lvl) (debug_config.level[(module)] >= (uint8_t)(lvl))
+
+/** @brief Debug_Log() filtered by the file's DEBUG_LOG_MODULE */
+#define Debug_LogAt(lvl, msg) \
+  do { if (Debug_On(DEBUG_LOG_MODULE, (lvl))) { Debug_Log(msg); } } while (0)
+
+/** @brief Debug_LogValue() filtered by the file's DEBUG_LOG_MODULE */
+#define Debug_LogValueAt(lvl, msg, value) \
+  do { if (Debug_On(DEBUG_LOG_MODULE, (lvl))) { Debug_LogValue((msg), (value)); } } while (0)
+
+/** @brief Debug_LogHex() filtered by the file's DEBUG_LOG_MODULE */
+#define Debug_LogHexAt(lvl, msg, value) \
+  do { if (Debug_On(DEBUG_LOG_MODULE, (lvl))) { Debug_LogHex((msg), (value)); } } while (0)
+
+/**
+ * @brief Set the runtime level of one module
+ * @param[in] module Debug_Module_t value
+ * @param[in] level DEBUG_LVL_OFF..DEBUG_LVL_DEBUG
+ * @retval 0 Success
+ * @retval 1 Module or level out of range
+ * @note Safe from interrupt handlers (single byte store).
+ */
+uint8_t Debug_SetLevel(uint8_t module, uint8_t level);
+
+/**
+ * @brief Get the runtime level of one module
+ * @param[in] module Debug_Module_t value
+ * @retval Level, or DEBUG_LVL_OFF for an unknown module
+ */
+uint8_t Debug_GetLevel(uint8_t module);
+
+/**
+ * @brief Short module name used by the UART command (SYS, RADIO, ...)
+ * @param[in] module Debug_Module_t value
+ * @retval Name, or NULL for an unknown module
+ */
+const char *Debug_ModuleName(uint8_t module);
+
 /**
  * @brief Initialize debug logging system
  * @details Must be called after UART init and RTC init
@@ -141,6 +233,13 @@ void Debug_LogBoot(void);
 #else
 
 /* Empty macros when debug is disabled */
+#define Debug_On(module, lvl) (0)
+#define Debug_LogAt(lvl, msg)
+#define Debug_LogValueAt(lvl, msg, value)
+#define Debug_LogHexAt(lvl, msg, value)
+#define Debug_SetLevel(module, level) (1U)
+#define Debug_GetLevel(module) (DEBUG_LVL_OFF)
+#define Debug_ModuleName(module) ((const char *)0)
 #define Debug_Init()
 #define Debug_Log(msg)
 #define Debug_LogValue(msg, value)
@@ -1,6 +1,7 @@
 /**
  * @file sd_logger.h
- * @brief Append measurement JSON Lines to SD (picoserver-compatible)
+ * @brief Append measurements to SD as JSON Lines (picoserver-compatible)
+ *        and/or compact binary day files
  * @details Requires MX_SPI1_Init(), MX_FATFS_Init(), then SD_Logger_Init().
  *          Missing or failed media is non-fatal: the station keeps running
  *          and retries the mount every 30 s.
@@ -18,6 +19,59 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Write picoserver JSON Lines to `log_Sn.json` (1) or not (0).
+ */
+#ifndef SD_LOGGER_JSON
+#define SD_LOGGER_JSON 1
+#endif
+
+/**
+ * @brief Write 32-byte binary records to per-day `Sn_YYMMDD.wsb` files (1)
+ *        or not (0); see ws_logfmt.h for the layout and
+ *        tools/ws_protocol_host/ws_binlog2json.c for the converter.
+ */
+#ifndef SD_LOGGER_BINARY
+#define SD_LOGGER_BINARY 0
+#endif
+
+/**
+ * @brief Start a new JSON file per station and day, `log_Sn_YYYYMMDD.json`
+ *        (1), or keep appending to `log_Sn.json` (0). Files are size-capped
+ *        and old days are deleted when the card runs low in both modes.
+ */
+#ifndef SD_LOGGER_ROTATE_DAILY
+#define SD_LOGGER_ROTATE_DAILY 1
+#endif
+
+/** @name SD_Logger_ReadLog() results
+ * @{ */
+#define SD_LOGGER_READ_OK     0U  /**< `max_lines` delivered; more may follow */
+#define SD_LOGGER_READ_EOF    1U  /**< End of the file reached */
+#define SD_LOGGER_READ_NOFILE 2U  /**< No such file (or invalid parameters) */
+#define SD_LOGGER_READ_BUSY   3U  /**< Volume unavailable, busy, or read failed */
+#define SD_LOGGER_READ_LONG   4U  /**< Line at `*offset` exceeds the line buffer */
+/** @} */
+
+/**
+ * @brief Receives one exported log line (without the line break, NUL-terminated).
+ */
+typedef void (*SD_Logger_LineFn_t)(const char *line, uint16_t len);
+
+/**
+ * @brief Running logger counters since boot (see SD_Logger_ReportStats()).
+ */
+typedef struct {
+  uint32_t bytes_written;   /**< Bytes appended through f_write */
+  uint32_t writes;          /**< f_write calls */
+  uint64_t write_us_total;  /**< Sum of f_write durations (avg = total / writes) */
+  uint32_t write_us_max;    /**< Longest f_write, incl. sector flushes it caused */
+  uint32_t syncs;           /**< f_sync calls */
+  uint32_t sync_us_max;     /**< Longest f_sync */
+  uint32_t remounts;        /**< Successful remounts after a failure */
+  uint32_t queue_dropped;   /**< Records lost to a full write-behind queue */
+} SD_Logger_Stats_t;
+
 /**
  * @brief Mount the FatFs USER volume after SPI1 and FatFs initialization.
  * @retval 0 Volume mounted.
@@ -28,28 +82,48 @@ extern "C" {
 uint8_t SD_Logger_Init(void);
 
 /**
- * @brief Append one measurement for station Sn to `log_Sn.json`.
+ * @brief Queue one measurement for station Sn (`log_Sn_YYYYMMDD.json` /
+ *        `Sn_YYMMDD.wsb`, day taken from @p rtc_now).
  * @param station_idx Node index (0 → S0).
  * @param readings    Decoded measurement payload.
  * @param rtc_now     Timestamp snapshot (NULL → zeros).
- * @retval 0 Success, or SD currently unavailable (non-blocking).
+ * @retval 0 Queued, or dropped because the write-behind queue is full.
  * @retval non-zero Hard JSON format error (line would not fit).
- * @note I/O failures log the FatFs stage (OPEN/SEEK/WRITE/CLOSE) and code,
- *       then mark the volume unavailable until the retry period elapses.
+ * @note Never touches the card: SD_Logger_Task() writes the line later.
+ *       I/O failures there log the FatFs stage (OPEN/SEEK/WRITE/SYNC/CLOSE)
+ *       and code, then mark the volume unavailable until the retry period
+ *       elapses; queued lines wait for the remount.
  */
 uint8_t SD_Logger_AppendMeasurement(uint8_t station_idx,
                                     const WS_Readings_t *readings,
                                     const DS3231_DateTime *rtc_now);
 
 /**
- * @brief Append one already-formatted debug line to `status_log`.
+ * @brief Queue one already-formatted debug line for `status_log`.
  * @param line UART `LOG:` bytes (including newline).
  * @param len  Byte count.
- * @retval 0 Success, SD unavailable, or skipped (re-entrant / empty).
- * @note Does not remount. No-op until `SD_Logger_Init()` has succeeded.
+ * @retval 0 Queued, SD unavailable, queue full, or empty line.
+ * @note Does not remount. No-op while the volume is not mounted.
  */
 uint8_t SD_Logger_AppendStatus(const char *line, uint16_t len);
 
+/**
+ * @brief Write every queued line and sync every open log file to the card.
+ * @note Call before STOP mode so no line waits in RAM across sleep.
+ *       No-op when nothing is pending or the volume is unavailable.
+ */
+void SD_Logger_Flush(void);
+
+/**
+ * @brief Write-behind step: drain up to one sector of queued lines, retry
+ *        the mount when lines wait for it, sync files whose oldest
+ *        pending line exceeds the sync period, and run the hourly
+ *        free-space retention check.
+ * @note Call from the main loop while the radio is idle; cheap when
+ *       nothing is pending.
+ */
+void SD_Logger_Task(void);
+
 /**
  * @brief Report whether the volume is mounted and the last I/O succeeded.
  * @retval 1 Ready to append.
@@ -57,6 +131,46 @@ uint8_t SD_Logger_AppendStatus(const char *line, uint16_t len);
  */
 uint8_t SD_Logger_IsReady(void);
 
+/**
+ * @brief Return the running counters (durations from DWT->CYCCNT).
+ */
+const SD_Logger_Stats_t *SD_Logger_GetStats(void);
+
+/**
+ * @brief Log the running counters and the driver's wait_ready() busy-time
+ *        histogram as `SD:` lines (`CMD:SD`).
+ */
+void SD_Logger_ReportStats(void);
+
+/**
+ * @brief Measure the card with a scratch file `bench.tmp` (`CMD:SD:BENCH`).
+ * @details Flushes the queue, re-initializes the card and remounts (logged
+ *          as mount time), then times 64 KiB single-block and multi-block
+ *          writes and reads and logs KiB/s plus the busy-wait histogram of
+ *          the run. The scratch file is deleted afterwards.
+ * @note Blocks the main loop for a few seconds; run it while the radio
+ *       is idle. Status lines logged meanwhile are not written to SD.
+ */
+void SD_Logger_Benchmark(void);
+
+/**
+ * @brief Read complete lines of a station's JSON log back (`CMD:EXPORT`).
+ * @param station_idx Node index (0 → S0).
+ * @param day_key     YYYYMMDD of the file (0 → undated `log_Sn` name).
+ * @param part        File part, 0 for the first (see SD_LOGGER_ROTATE_DAILY).
+ * @param offset      In: byte offset to resume at; out: offset after the
+ *                    last delivered line.
+ * @param max_lines   Lines delivered at most.
+ * @param fn          Called once per line, before the next read.
+ * @retval SD_LOGGER_READ_OK, SD_LOGGER_READ_EOF, SD_LOGGER_READ_NOFILE,
+ *         SD_LOGGER_READ_BUSY or SD_LOGGER_READ_LONG.
+ * @note Flushes the write-behind queue first and borrows the measurement
+ *       file handle, so the next append reopens its file. Run it while the
+ *       radio is idle. Binary `.wsb` logs are not exported.
+ */
+uint8_t SD_Logger_ReadLog(uint8_t station_idx, uint32_t day_key, uint8_t part, uint32_t *offset,
+                          uint8_t max_lines, SD_Logger_LineFn_t fn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,7 +14,9 @@
 #define UART_CMD_TARGET_ACTIVE 0xFFU
 #define UART_CMD_TARGET_ALL    0xFEU
 
-void UartCmd_Init(UART_HandleTypeDef *huart, WS_Manager_t *ws);
-void UartCmd_FlushReply(void);
+/* cfg: runtime radio settings changed by CMD:CFG:RADIO (kept for re-init). */
+void UartCmd_Init(UART_HandleTypeDef *huart, WS_Manager_t *ws, WS_RuntimeConfig_t *cfg);
+/* Parse and run queued command lines; call on WS_EVT_UART_LINE. */
+void UartCmd_Process(void);
 
 #endif /* UART_CMD_H */
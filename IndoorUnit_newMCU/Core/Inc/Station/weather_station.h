@@ -25,8 +25,30 @@
  * PUBLIC CONSTANTS
  * ========================================================================== */
 
-/** @brief Maximum number of outdoor nodes supported */
-#define WS_MAX_NODES 4U
+/**
+ * @brief Size of the outdoor node table
+ * @note  Override from the build for larger networks; every entry costs about
+ *        210 B of RAM. Node masks and reply demultiplexing scale to
+ *        WS_NODE_MASK_BITS nodes on the WS_REPLY_PIPES hardware pipes.
+ */
+#ifndef WS_MAX_NODES
+#define WS_MAX_NODES 8U
+#endif
+
+#if (WS_MAX_NODES > WS_NODE_MASK_BITS)
+#error "WS_MAX_NODES exceeds the WS_NodeMask_t width"
+#endif
+
+/** @brief Minutes between scheduled cycles after reset (RTC alarm 2 fires every minute) */
+#define WS_MEASURE_INTERVAL_DEFAULT_MIN 1U
+/**
+ * @brief Longest measurement interval accepted by WS_SetMeasureInterval()
+ * @details Intervals must divide it, so cycles stay evenly spaced across midnight.
+ */
+#define WS_MEASURE_INTERVAL_MAX_MIN 60U
+
+/** @brief Late (backlog) frames buffered between radio IRQ and UART/SD output */
+#define WS_BACKLOG_RX_DEPTH 6U
 
 #define SCREEN_SAVER_TIMEOUT_MS  15000U /* 15 seconds */
 
@@ -95,34 +117,65 @@ typedef struct {
   GPIO_TypeDef *led_port;        /**< LED GPIO port (can be NULL) */
   uint16_t led_pin;              /**< LED GPIO pin */
   uint8_t channel;               /**< nRF24 RF channel (0-125) */
+  uint8_t data_rate;             /**< NRF24_DataRate_t; must match the outdoor units */
+  uint8_t pa_level;              /**< NRF24_PALevel_t of the central's transmitter */
   uint8_t cmd_measure;           /**< Measurement command byte */
   uint8_t cmd_size;              /**< Command packet size (bytes) */
   uint8_t payload_size;          /**< Data payload size (bytes) */
   uint32_t tx_irq_timeout_ms;    /**< TX interrupt timeout (ms) */
   uint32_t rx_timeout_ms;        /**< RX response timeout (ms) */
+  uint16_t slot_lead_ms;         /**< Command to first reply slot (ms) */
+  uint8_t slot_len_ms;           /**< Reply slot per node (ms); 0 = wait rx_timeout_ms */
+  uint8_t slot_guard_ms;         /**< Margin after the last slot before closing a cycle (ms) */
   uint32_t comm_watchdog_timeout_ms; /**< Max allowed time without valid RX data (ms) */
   UART_HandleTypeDef *huart_pico;/**< UART handle for Pico W CSV output (can be NULL) */
   const uint8_t *broadcast_addr; /**< 5-byte broadcast TX address for parallel cycles */
 } WS_RuntimeConfig_t;
 
+/**
+ * @brief Per-node link quality statistics
+ * @details Drives the retry budget, reply slot order and poll backoff of a node.
+ */
+typedef struct {
+  uint16_t polls;                      /**< Measure commands addressed to this node */
+  uint16_t replies;                    /**< Measurements received from this node */
+  uint16_t rx_timeouts;                /**< Polls that ended without a reply */
+  uint8_t miss_streak;                 /**< Consecutive polls without a reply */
+  uint8_t success_q8;                  /**< Moving reply ratio (255 = every poll answered) */
+  uint8_t backoff_shift;               /**< Poll backoff level: 2^shift - 1 cycles skipped */
+  uint8_t skip_cycles;                 /**< Parallel cycles left before the node is polled again */
+} WS_LinkStats_t;
+
 /**
  * @brief Node state tracking structure
  * @details Maintains state for a single outdoor sensor node including
  *          addresses, flags, timestamps, and measurement data.
  */
 typedef struct {
-  uint8_t tx_addr[5];                  /**< Transmit address for this node */
-  uint8_t rx_addr[5];                  /**< Receive address for this node */
-  uint8_t rx_pipe;                     /**< RX pipe number on central (1-5) */
+  uint8_t rx_pipe;                     /**< RX pipe number on central (1-5), shared by nodes WS_REPLY_PIPES apart */
   volatile uint8_t measurement_pending;/**< Flag: measurement request pending */
   uint32_t tx_start_tick;              /**< Timestamp: TX start time */
   uint32_t response_start_tick;        /**< Timestamp: response wait start */
   uint8_t last_status;                 /**< Last nRF24 status register value */
   uint8_t retry_count;                 /**< Retry counter for failures */
+  WS_LinkStats_t link;                 /**< Link quality statistics */
   WS_NodeStateEnum_t state;            /**< Current node state */
   WS_NodeReadings_t data;              /**< Latest measurement readings */
+  WS_FragAssembly_t frag;              /**< Reassembly of fragmented replies */
+  WS_DeltaKey_t rx_key;                /**< Last keyframe, reference for delta replies */
 } WS_NodeState_t;
 
+/**
+ * @brief Backlog frame received from a node, waiting for UART/SD output
+ */
+typedef struct {
+  uint8_t node_idx;                          /**< Sending node index */
+  uint8_t len;                               /**< Frame length in bytes */
+  uint8_t rx_time_valid;                     /**< 1 when rx_time holds the RTC time of reception */
+  DS3231_DateTime rx_time;                   /**< RTC time of reception (the frame's age counts from here) */
+  uint8_t frame[WS_PROTOCOL_MAX_FRAME];      /**< Raw WS_PROTOCOL_VERSION_BACKLOG frame (envelope removed) */
+} WS_BacklogRx_t;
+
 /**
  * @brief Weather Station Manager main context structure
  * @details Central context managing all nodes and application state.
@@ -140,16 +193,27 @@ typedef struct {
   volatile uint8_t comm_watchdog_tripped; /**< 1 when communication watchdog timed out */
   uint8_t cycle_nodes_remaining;       /**< Nodes left in scheduled multi-node cycle (legacy sequential) */
   uint32_t next_measure_earliest_tick; /**< Earliest tick for next TX in a multi-node cycle */
-  uint8_t cycle_id;                    /**< Current/last broadcast measure cycle id */
-  uint8_t expected_mask;               /**< Bitmask of nodes expected in parallel cycle */
-  uint8_t received_mask;               /**< Bitmask of nodes that replied in parallel cycle */
+  uint8_t cycle_id;                    /**< Last full-cycle id (WS_CMD_CYCLE_SEQ_MASK bits) */
+  uint8_t poll_id;                     /**< Last retry/single-node poll id (WS_CMD_CYCLE_PARTIAL set) */
+  WS_NodeMask_t expected_mask;         /**< Bitmask of nodes expected in parallel cycle */
+  WS_NodeMask_t received_mask;         /**< Bitmask of nodes that replied in parallel cycle */
+  WS_NodeMask_t keyframe_mask;         /**< Bitmask of nodes asked to send a keyframe next */
+  WS_NodeMask_t cycle_retry_mask;      /**< Nodes re-polled by the next parallel cycle (0 = fresh cycle) */
   uint8_t cycle_pending;               /**< 1 when a parallel cycle is queued */
   uint8_t parallel_cycle;              /**< 1 while a parallel broadcast cycle is active */
   uint8_t cycle_tx_done;               /**< 1 when broadcast command TX_DS was observed */
   uint32_t cycle_tx_start_tick;        /**< Tick when broadcast TX started */
   uint32_t cycle_rx_start_tick;        /**< Tick when waiting for parallel replies started */
+  uint32_t cycle_window_ms;            /**< Reply window of the last command (end of its last slot) */
   WS_AppState_t app_state;             /**< Current application state */
+  uint8_t pipe_tx_addr[WS_REPLY_PIPES][5]; /**< PTX/ACK address used while polling a node on reply pipe N+1 */
+  uint8_t pipe_rx_addr[WS_REPLY_PIPES][5]; /**< Reply pipe N+1 RX address (shared by its nodes) */
   WS_NodeState_t nodes[WS_MAX_NODES];  /**< Array of node state structures */
+  WS_BacklogRx_t backlog[WS_BACKLOG_RX_DEPTH]; /**< Late measurements queued by ws_handle_irq */
+  uint8_t backlog_head;                /**< Index of the oldest queued backlog frame */
+  uint8_t backlog_count;               /**< Number of queued backlog frames */
+  uint8_t measure_interval_min;        /**< Minutes between scheduled cycles (WS_IsMeasurementDue) */
+  WS_NodeMask_t enabled_mask;          /**< Nodes polled by parallel cycles */
 } WS_Manager_t;
 
 /* ============================================================================
@@ -159,8 +223,8 @@ typedef struct {
 /**
  * @brief Initializes the Weather Station Manager
  * @param[out] ctx Manager context to initialize (must not be NULL)
- * @param[in] tx_addrs Array of TX addresses for each node (5 bytes each)
- * @param[in] rx_addrs Array of RX addresses for each node (5 bytes each)
+ * @param[in] tx_addrs PTX/ACK address per reply pipe, WS_REPLY_PIPES rows of 5 bytes
+ * @param[in] rx_addrs RX address per reply pipe, WS_REPLY_PIPES rows of 5 bytes
  * @param[in] node_count Number of outdoor nodes to manage (1-WS_MAX_NODES)
  */
 void WS_InitManager(WS_Manager_t *ctx, const uint8_t tx_addrs[][5], const uint8_t rx_addrs[][5], uint8_t node_count);
@@ -230,6 +294,34 @@ void WS_RequestMeasurementCycle(WS_Manager_t *ctx);
  */
 void WS_ConsumePendingForActiveNode(WS_Manager_t *ctx);
 
+/**
+ * @brief Checks whether the scheduled cycle is due at this RTC minute
+ * @param[in] ctx Manager context
+ * @param[in] now RTC time of the minute alarm
+ * @return true when the minute of the day is a multiple of measure_interval_min
+ * @note Intervals that do not divide 1440 leave a shorter gap before midnight.
+ */
+bool WS_IsMeasurementDue(const WS_Manager_t *ctx, const DS3231_DateTime *now);
+
+/**
+ * @brief Sets the scheduled measurement interval
+ * @param[in,out] ctx Manager context
+ * @param[in] minutes Divisor of WS_MEASURE_INTERVAL_MAX_MIN (1, 2, 3, 4, 5, 6,
+ *                    10, 12, 15, 20, 30 or 60)
+ * @retval 0 Applied
+ * @retval 1 Out of range or not a divisor
+ */
+uint8_t WS_SetMeasureInterval(WS_Manager_t *ctx, uint8_t minutes);
+
+/**
+ * @brief Selects the nodes polled by parallel cycles
+ * @param[in,out] ctx Manager context
+ * @param[in] mask Non-empty subset of the managed nodes
+ * @retval 0 Applied from the next cycle
+ * @retval 1 Empty mask or unknown node
+ */
+uint8_t WS_SetEnabledNodes(WS_Manager_t *ctx, WS_NodeMask_t mask);
+
 /* ============================================================================
  * PUBLIC API - TRANSMISSION MANAGEMENT
  * ========================================================================== */
@@ -343,6 +435,21 @@ void WS_ScheduleNextNode(WS_Manager_t *ctx);
  */
 HAL_StatusTypeDef WS_InitRadioAndStart(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg);
 
+/**
+ * @brief Changes RF channel, data rate and PA level of the running radio
+ * @param[in] ctx Manager context
+ * @param[in,out] cfg Runtime configuration; updated so recovery keeps the setting
+ * @param[in] channel RF channel (0-125)
+ * @param[in] data_rate NRF24_DataRate_t
+ * @param[in] pa_level NRF24_PALevel_t
+ * @return HAL_OK when applied, HAL_BUSY during a TX/RX or cycle, HAL_ERROR
+ *         on an invalid value or SPI failure
+ * @note Channel and data rate are fixed in the outdoor firmware; changing
+ *       them here only makes sense together with a matching outdoor build.
+ */
+HAL_StatusTypeDef WS_SetRadioConfig(const WS_Manager_t *ctx, WS_RuntimeConfig_t *cfg,
+                                    uint8_t channel, uint8_t data_rate, uint8_t pa_level);
+
 /**
  * @brief Main event processing loop - must be called periodically
  * @param[in,out] ctx Manager context
@@ -29,21 +29,33 @@
 
 /** @brief RF channel number (76 → 2476 MHz) */
 #define NRF_CHANNEL      76
+/** @brief Air data rate (must match the outdoor units) */
+#define NRF_DATA_RATE    NRF24_DR_1MBPS
+/** @brief Transmit power of the central station */
+#define NRF_PA_LEVEL     NRF24_PA_MAX
 /** @brief Fixed RX/TX payload size (matches protocol) */
 #define NRF_PAYLOAD_SIZE WS_PROTOCOL_MAX_PAYLOAD
+/** @brief 1 = dynamic payload length on reply pipes (OutdoorUnit sends short delta frames) */
+#define NRF_DYNAMIC_PAYLOAD 1
 /** @brief Command field size in protocol frames */
 #define NRF_CMD_SIZE     WS_CMD_SIZE
 /** @brief Measure command token */
 #define CMD_MEASURE      WS_CMD_MEASURE
 /** @brief TX IRQ wait timeout in milliseconds */
 #define NRF_TX_IRQ_TIMEOUT_MS 120U
-/** @brief RX response timeout in milliseconds */
+/** @brief RX response timeout in milliseconds (cap; slotted commands close earlier) */
 #define NRF_RX_TIMEOUT_MS 4500U
+/** @brief Command to first reply slot: outdoor wake-up plus TSL2561 402 ms integration */
+#define NRF_SLOT_LEAD_MS 600U
+/** @brief Reply slot per node: one 3-frame burst with retries plus backlog upload (0 = no slots) */
+#define NRF_SLOT_LEN_MS  40U
+/** @brief Margin after the last slot for tick skew between indoor and outdoor units */
+#define NRF_SLOT_GUARD_MS 20U
 /** @brief Communication watchdog timeout in milliseconds */
 #define NRF_COMM_WATCHDOG_TIMEOUT_MS 600000U
 /** @brief Window watchdog refresh period in milliseconds */
 #define WWDG_REFRESH_PERIOD_MS 10U
-/** @brief Number of outdoor nodes managed by this central unit */
+/** @brief Number of outdoor nodes managed by this central unit (1..WS_MAX_NODES; NODE_ID 0..N-1) */
 #define WS_NODE_COUNT 2U
 /** @brief Hold time for manual RTC set gesture in milliseconds */
 #define RTC_MANUAL_SET_HOLD_MS 1200U
@@ -116,35 +128,42 @@ char g_nrf_message[64];
  *
  * Central station RX pipes (static, configured once at init):
  *   Pipe 0: Reserved for auto-ACK (dynamically set to match TX_ADDR)
- *   Pipe 1: Node 0 data reception  (full 5-byte addr)
- *   Pipe 2: Node 1 data reception  (only LSByte differs from Pipe 1)
- *   Pipe 3: Node 2 data reception  (only LSByte differs from Pipe 1)
- *   Pipe 4: Node 3 data reception  (only LSByte differs from Pipe 1)
+ *   Pipe 1: Replies of nodes 0, 5, 10, ...  (full 5-byte addr)
+ *   Pipe 2: Replies of nodes 1, 6, 11, ...  (only LSByte differs from Pipe 1)
+ *   Pipe 3: Replies of nodes 2, 7, 12, ...  (only LSByte differs from Pipe 1)
+ *   Pipe 4: Replies of nodes 3, 8, 13, ...  (only LSByte differs from Pipe 1)
+ *   Pipe 5: Replies of nodes 4, 9, 14, ...  (only LSByte differs from Pipe 1)
+ *
+ * Nodes sharing a pipe are told apart by the node id envelope byte
+ * (WS_Reply_Unwrap) and kept off the air together by their TDMA slots, so
+ * WS_NODE_COUNT is limited by WS_MAX_NODES rather than by the five pipes.
  *
  * Broadcast TX address (NRF_BROADCAST_ADDR):
  *   One NoAck measure command heard by all outdoor units in parallel.
  *   Outdoor units listen on this address on a dedicated RX pipe (no Auto-ACK).
  *
- * Unicast TX addresses: used for single-node CMD:MEASURE:N.
- *   Only LSByte differs between nodes (outdoor nodes use same scheme).
+ * PTX addresses: Pipe 0 / TX_ADDR while polling a node of reply pipe N.
+ *   Only LSByte differs between pipes and none equals a reply address.
  *
  * Byte order: addr[0] = LSByte (transmitted first on-air).
  */
 
-/** @brief Unicast TX addresses per outdoor node (central → node commands) */
-static const uint8_t WS_NODE_TX_ADDRS[WS_MAX_NODES][5] = {
-  {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Node 0 */
-  {0xE8, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Node 1 (LSB=0xE8) */
-  {0xE9, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Node 2 (LSB=0xE9) */
-  {0xEA, 0xE7, 0xE7, 0xE7, 0xE7}   /**< Node 3 (LSB=0xEA) */
+/** @brief PTX/ACK address per reply pipe (pipe 0 while a node of that pipe is active) */
+static const uint8_t WS_NODE_TX_ADDRS[WS_REPLY_PIPES][5] = {
+  {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Reply pipe 1 */
+  {0xE8, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Reply pipe 2 (LSB=0xE8) */
+  {0xE9, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Reply pipe 3 (LSB=0xE9) */
+  {0xEA, 0xE7, 0xE7, 0xE7, 0xE7},  /**< Reply pipe 4 (LSB=0xEA) */
+  {0xEB, 0xE7, 0xE7, 0xE7, 0xE7}   /**< Reply pipe 5 (LSB=0xEB) */
 };
 
-/** @brief Multiceiver RX addresses per outdoor node (node → central data) */
-static const uint8_t WS_NODE_RX_ADDRS[WS_MAX_NODES][5] = {
-  {0xC2, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 1 - Node 0 (full addr) */
-  {0xC3, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 2 - Node 1 (LSB=0xC3) */
-  {0xC4, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 3 - Node 2 (LSB=0xC4) */
-  {0xC5, 0xC2, 0xC2, 0xC2, 0xC2}   /**< Pipe 4 - Node 3 (LSB=0xC5) */
+/** @brief Multiceiver RX address per reply pipe (node N -> pipe WS_REPLY_PIPE(N)) */
+static const uint8_t WS_NODE_RX_ADDRS[WS_REPLY_PIPES][5] = {
+  {0xC2, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 1 (full addr) */
+  {0xC3, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 2 (LSB=0xC3) */
+  {0xC4, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 3 (LSB=0xC4) */
+  {0xC5, 0xC2, 0xC2, 0xC2, 0xC2},  /**< Pipe 4 (LSB=0xC5) */
+  {0xC6, 0xC2, 0xC2, 0xC2, 0xC2}   /**< Pipe 5 (LSB=0xC6) */
 };
 
 #endif
@@ -0,0 +1,86 @@
+/**
+ * @file    ws_event.h
+ * @brief   Lock-free ISR -> main loop event flags for the Indoor Unit
+ * @details Interrupt handlers mark one pending flag per event type; the main
+ *          loop takes the pending types and runs only their handlers, then
+ *          sleeps once none is left. Repeated posts of a type that is still
+ *          pending coalesce into one dispatch instead of being dropped, so a
+ *          level-latched source (DS3231 INT/SQW, nRF24 IRQ) can never lose
+ *          the single edge it raises before its flags are cleared.
+ */
+
+#ifndef WS_EVENT_H
+#define WS_EVENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Event sources, in dispatch priority order (lowest value first)
+ */
+typedef enum {
+  WS_EVT_UART_LINE = 0U, /**< UART command line queued by the RX DMA/IDLE handler */
+  WS_EVT_RTC_ALARM,      /**< DS3231 SQW/INT pin (EXTI) */
+  WS_EVT_NRF_IRQ,        /**< nRF24 IRQ pin (EXTI) */
+  WS_EVT_BUTTON,         /**< Encoder push button edge (EXTI) */
+  WS_EVT_ENCODER,        /**< Encoder rotation (TIM1 input capture) */
+  WS_EVT_COUNT           /**< Number of event types */
+} WS_EventType_t;
+
+/**
+ * @brief One dispatched event
+ */
+typedef struct {
+  uint8_t type;          /**< WS_EventType_t */
+  uint32_t tick;         /**< HAL tick of the first post since the last dispatch */
+} WS_Event_t;
+
+/**
+ * @brief Per-type dispatch statistics
+ */
+typedef struct {
+  uint32_t count;            /**< Events dispatched */
+  uint32_t max_latency_ms;   /**< Longest post -> dispatch delay */
+  uint32_t total_latency_ms; /**< Sum of post -> dispatch delays (mean = total / count) */
+} WS_EventStats_t;
+
+/**
+ * @brief   Posts an event (producer side: interrupt context only)
+ * @param   type  Event source
+ * @retval  true  Event marked pending
+ * @retval  false Invalid type, or already pending and merged into that
+ *                dispatch; merges are counted in WS_Event_Coalesced()
+ * @note    All posting IRQs share NVIC priority 0 and never nest, so every
+ *          ISR together forms the single producer.
+ */
+bool WS_Event_Post(WS_EventType_t type);
+
+/**
+ * @brief   Takes the highest-priority pending event (consumer side: main loop only)
+ * @param   out  Receives the event
+ * @retval  true  Event returned and its latency recorded
+ * @retval  false Nothing pending
+ * @note    The flag is cleared before the caller runs the handler, so a post
+ *          that races with the handler is dispatched again on the next call.
+ */
+bool WS_Event_Get(WS_Event_t *out);
+
+/**
+ * @brief   Checks whether any event is pending
+ * @retval  true  Nothing pending
+ */
+bool WS_Event_IsEmpty(void);
+
+/**
+ * @brief   Returns the number of posts merged into an already pending event
+ */
+uint32_t WS_Event_Coalesced(void);
+
+/**
+ * @brief   Returns dispatch statistics of one event type
+ * @param   type  Event source
+ * @retval  Pointer to the statistics, or NULL for an invalid type
+ */
+const WS_EventStats_t *WS_Event_GetStats(WS_EventType_t type);
+
+#endif /* WS_EVENT_H */
@@ -0,0 +1,190 @@
+/**
+ * @file ws_logfmt.h
+ * @brief SD log record formats: JSON Lines and compact binary day files
+ * @details Hardware-independent so the host converter (tools/ws_protocol_host,
+ *          ws_binlog2json) formats exactly the lines the logger writes.
+ *
+ * JSON line (picoserver log_<station>.json):
+ *   {"station_id":"S0","timestamp":"2026-05-09T11:06:01","status":"OK",
+ *    "si7021_temp":23.4,...,"bme280_hum":null}\n
+ *
+ * Binary day file (one per station and day, e.g. S0_260509.wsb):
+ *   header (64 B):
+ *     [0]  "WSLB"                 magic
+ *     [4]  version                WS_LOGFMT_BIN_VERSION
+ *     [5]  record size            WS_LOGFMT_BIN_RECORD_SIZE
+ *     [6]  header size            WS_LOGFMT_BIN_HEADER_SIZE
+ *     [7]  station index
+ *     [8]  day_epoch LE32         00:00:00 of the file's day
+ *     [12] index[24] LE16         record number of the first record logged in
+ *                                 hour h (0xFFFF = none yet); sparse time index
+ *     [60] record count LE32      logical end; the file is preallocated
+ *                                 and bytes after the last record are undefined
+ *   record (32 B, never straddles a 512 B sector):
+ *     [0]  epoch LE32             measurement time
+ *     [4]  station index
+ *     [5]  frame length
+ *     [6]  v2 frame (22 B, zero padded): status, channel bitmap, fixed-point values
+ *     [28] sequence LE16          record number in the file (low 16 bits)
+ *     [30] CRC-16 LE              CRC-16/CCITT-FALSE over the header's day_epoch
+ *                                 (LE32) and record bytes [0..29]
+ *   The sequence and CRC let the logger recover records that reached the
+ *   card after the last synced record count, and reject stale data left
+ *   in reused clusters (another day or station never verifies).
+ *   Epoch seconds count from 1970-01-01 in the station's RTC time (no zone);
+ *   epoch 0 means the RTC time was unknown. Backlog records carry their
+ *   measurement time and may therefore appear out of order in the file.
+ *
+ * JSON rebuilt from binary records matches the logged line except where the
+ * 0.01 °C v2 step rounds a temperature across a 0.05 boundary (last digit).
+ */
+
+#ifndef WS_LOGFMT_H
+#define WS_LOGFMT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ws_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Binary file magic, first 4 header bytes */
+#define WS_LOGFMT_BIN_MAGIC        "WSLB"
+/** @brief Binary day file layout version */
+#define WS_LOGFMT_BIN_VERSION      3U
+/** @brief Binary file header size in bytes */
+#define WS_LOGFMT_BIN_HEADER_SIZE  64U
+/** @brief Binary record size in bytes (16 records per 512 B sector) */
+#define WS_LOGFMT_BIN_RECORD_SIZE  32U
+/** @brief Hour slots in the sparse time index */
+#define WS_LOGFMT_BIN_INDEX_SLOTS  24U
+/** @brief Index slot value meaning "no record in this hour yet" */
+#define WS_LOGFMT_BIN_INDEX_NONE   0xFFFFU
+/** @brief File offset of index slot @p hour */
+#define WS_LOGFMT_BIN_INDEX_OFFSET(hour) (12U + (2U * (uint32_t)(hour)))
+/** @brief File offset of the record count */
+#define WS_LOGFMT_BIN_COUNT_OFFSET 60U
+/** @brief Seconds per day */
+#define WS_LOGFMT_DAY_S            86400UL
+
+/**
+ * @brief Calendar time as kept by the DS3231 (two-digit year, 20YY)
+ */
+typedef struct {
+  uint8_t year;     /**< 0..99 → 2000..2099 */
+  uint8_t month;    /**< 1..12 (0 = unknown) */
+  uint8_t date;     /**< 1..31 */
+  uint8_t hours;    /**< 0..23 */
+  uint8_t minutes;  /**< 0..59 */
+  uint8_t seconds;  /**< 0..59 */
+} WS_LogTime_t;
+
+/**
+ * @brief Formats one JSON Lines record (including the trailing newline)
+ * @param station_idx Node index (0 → "S0")
+ * @param t           Timestamp (NULL → all zeros)
+ * @param readings    Measurement to format
+ * @param buf         Destination buffer
+ * @param buf_size    Capacity of @p buf
+ * @param out_len     Receives the line length without terminator
+ * @retval true  Line formatted
+ * @retval false Invalid parameters or line would not fit
+ */
+bool WS_LogFmt_Json(uint8_t station_idx, const WS_LogTime_t *t, const WS_Readings_t *readings,
+                    char *buf, size_t buf_size, uint16_t *out_len);
+
+/**
+ * @brief Converts a calendar time to epoch seconds
+ * @retval Seconds since 1970-01-01, or 0 when @p t is NULL or invalid
+ */
+uint32_t WS_LogFmt_TimeToEpoch(const WS_LogTime_t *t);
+
+/**
+ * @brief Converts epoch seconds back to a calendar time
+ * @note  Epoch 0 and times before 2000 yield all-zero fields (unknown time).
+ */
+void WS_LogFmt_EpochToTime(uint32_t epoch, WS_LogTime_t *t);
+
+/**
+ * @brief Builds a binary day file header with an empty time index
+ * @param station_idx Node index
+ * @param day_epoch   Epoch of 00:00:00 of the file's day
+ * @param buf         Receives WS_LOGFMT_BIN_HEADER_SIZE bytes
+ */
+void WS_LogFmt_BinHeader(uint8_t station_idx, uint32_t day_epoch, uint8_t *buf);
+
+/**
+ * @brief Validates a binary day file header
+ * @param buf             WS_LOGFMT_BIN_HEADER_SIZE bytes from the file start
+ * @param out_station_idx Receives the station index (may be NULL)
+ * @param out_day_epoch   Receives the day epoch (may be NULL)
+ * @retval true  Magic, version and sizes match this build
+ */
+bool WS_LogFmt_BinCheckHeader(const uint8_t *buf, uint8_t *out_station_idx, uint32_t *out_day_epoch);
+
+/**
+ * @brief Reads time index slot @p hour from a header
+ * @retval Record number, or WS_LOGFMT_BIN_INDEX_NONE
+ */
+uint16_t WS_LogFmt_BinIndexGet(const uint8_t *header, uint8_t hour);
+
+/**
+ * @brief Reads the record count (logical end of the file) from a header
+ */
+uint32_t WS_LogFmt_BinCount(const uint8_t *header);
+
+/**
+ * @brief Stores the record count in a header image
+ */
+void WS_LogFmt_BinSetCount(uint8_t *header, uint32_t count);
+
+/**
+ * @brief Encodes one binary record
+ * @param epoch       Measurement time (WS_LogFmt_TimeToEpoch)
+ * @param station_idx Node index
+ * @param readings    Measurement (quantized to v2 fixed point)
+ * @param buf         Receives WS_LOGFMT_BIN_RECORD_SIZE bytes
+ * @retval true  Record encoded
+ * @retval false Invalid parameters or readings (see WS_Protocol_EncodeV2)
+ */
+bool WS_LogFmt_BinEncode(uint32_t epoch, uint8_t station_idx, const WS_Readings_t *readings, uint8_t *buf);
+
+/**
+ * @brief Seals an encoded record with its sequence number and CRC
+ * @param buf       Record from WS_LogFmt_BinEncode()
+ * @param seq       Record number in the file
+ * @param day_epoch Day epoch from the file header
+ */
+void WS_LogFmt_BinSeal(uint8_t *buf, uint16_t seq, uint32_t day_epoch);
+
+/**
+ * @brief Checks that a record was sealed at position @p seq of this file
+ * @param buf         WS_LOGFMT_BIN_RECORD_SIZE bytes
+ * @param seq         Expected record number
+ * @param station_idx Station index from the file header
+ * @param day_epoch   Day epoch from the file header
+ * @retval true  Sequence, station and CRC match
+ */
+bool WS_LogFmt_BinVerify(const uint8_t *buf, uint16_t seq, uint8_t station_idx, uint32_t day_epoch);
+
+/**
+ * @brief Decodes one binary record
+ * @param buf             WS_LOGFMT_BIN_RECORD_SIZE bytes
+ * @param out_epoch       Receives the measurement time
+ * @param out_station_idx Receives the station index
+ * @param out             Receives the readings
+ * @retval true  Record valid
+ * @retval false Malformed frame
+ */
+bool WS_LogFmt_BinDecode(const uint8_t *buf, uint32_t *out_epoch, uint8_t *out_station_idx,
+                         WS_Readings_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WS_LOGFMT_H */
@@ -0,0 +1,95 @@
+/**
+ * @file ws_logtok.h
+ * @brief Tokenized debug log records (deferred formatting)
+ * @details Hardware-independent and shared verbatim by both units and the
+ *          host decoder (tools/ws_protocol_host, ws_logdecode). Instead of a
+ *          formatted line the MCU sends the flash address of the message
+ *          string, the HAL tick and the integer arguments; the decoder reads
+ *          the strings back from the matching firmware ELF and formats there.
+ *
+ * Record line (one per log call, mixed freely with text lines):
+ *   0x1E, escaped body, '\n'
+ *   body:
+ *     [0]  kind (bits 0..3) | argument count (bits 4..6)
+ *          id varint            string address - WS_LOGTOK_ID_BASE (0 for TIME)
+ *          tick varint          HAL_GetTick() in ms
+ *          args zigzag varints  int32 arguments, in order
+ *          CRC-8                poly 0x07, init 0, over all preceding body bytes
+ *   Body bytes 0x0A, 0x0D, 0x1B and 0x1E are sent as 0x1B, byte ^ 0x20, so a
+ *   record never contains a line break and line-based readers skip it.
+ *
+ * Varints are LEB128 (7 bits per byte, least significant first). A
+ * value-only record is typically 10..14 bytes against 40..60 for the
+ * timestamped text line.
+ */
+
+#ifndef WS_LOGTOK_H
+#define WS_LOGTOK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief First byte of every record line */
+#define WS_LOGTOK_SYNC      0x1EU
+/** @brief Escape byte; the next byte is XOR 0x20 */
+#define WS_LOGTOK_ESC       0x1BU
+/** @brief Flash base subtracted from string addresses (STM32F1 main flash) */
+#define WS_LOGTOK_ID_BASE   0x08000000UL
+/** @brief Maximum integer arguments per record */
+#define WS_LOGTOK_MAX_ARGS  4U
+/** @brief Maximum unescaped body size */
+#define WS_LOGTOK_BODY_MAX  (1U + 5U + 5U + (5U * WS_LOGTOK_MAX_ARGS) + 1U)
+/** @brief Maximum record line size (sync, escaped body, newline) */
+#define WS_LOGTOK_LINE_MAX  (2U * WS_LOGTOK_BODY_MAX + 2U)
+
+/**
+ * @brief How the decoder turns the string and arguments into text
+ */
+typedef enum {
+  WS_LOGTOK_TEXT = 0U,  /**< String as is, no arguments (Debug_Log) */
+  WS_LOGTOK_VALUE,      /**< String then args[0] in decimal (Debug_LogValue) */
+  WS_LOGTOK_HEX,        /**< String then args[0] as 0x%08lX (Debug_LogHex) */
+  WS_LOGTOK_FMT,        /**< String is a printf format; %s arguments are string addresses */
+  WS_LOGTOK_TIME,       /**< No string; args = 20YYMMDD, HHMMSS of the RTC at `tick` */
+  WS_LOGTOK_KIND_COUNT  /**< Number of record kinds */
+} WS_LogTokKind_t;
+
+/**
+ * @brief One decoded record
+ */
+typedef struct {
+  uint8_t kind;                          /**< WS_LogTokKind_t */
+  uint8_t nargs;                         /**< Valid entries in args */
+  uint32_t id;                           /**< String address - WS_LOGTOK_ID_BASE */
+  uint32_t tick;                         /**< Milliseconds since boot */
+  int32_t args[WS_LOGTOK_MAX_ARGS];      /**< Integer arguments */
+} WS_LogTok_Record_t;
+
+/**
+ * @brief Encodes a record as one line
+ * @param rec  Record to encode
+ * @param buf  Destination
+ * @param size Capacity of @p buf (WS_LOGTOK_LINE_MAX always suffices)
+ * @retval Line length including sync byte and newline, or 0 on invalid input
+ */
+uint16_t WS_LogTok_Encode(const WS_LogTok_Record_t *rec, uint8_t *buf, size_t size);
+
+/**
+ * @brief Decodes one record line
+ * @param line Bytes from the sync byte up to, not including, the newline
+ * @param len  Number of bytes
+ * @param out  Receives the record
+ * @retval true  Well-formed record with a matching CRC
+ */
+bool WS_LogTok_Decode(const uint8_t *line, size_t len, WS_LogTok_Record_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WS_LOGTOK_H */
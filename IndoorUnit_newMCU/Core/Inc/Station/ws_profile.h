@@ -0,0 +1,110 @@
+/**
+ * @file    ws_profile.h
+ * @brief   Cycle-accurate zone profiling on the DWT cycle counter (Indoor Unit)
+ * @details Wrap a hot path in WS_PROFILE_BEGIN(zone) / WS_PROFILE_END(zone)
+ *          to accumulate count, min, max and mean duration in CYCCNT ticks
+ *          (1 tick = 1 / SystemCoreClock). Dump with `CMD:PROF` on the
+ *          command UART, clear with `CMD:PROF:RESET`. With WS_PROFILE_ENABLE
+ *          set to 0 every macro and API call compiles to nothing.
+ */
+
+#ifndef WS_PROFILE_H
+#define WS_PROFILE_H
+
+#include <stdint.h>
+
+/* ============================================================================
+ * CONFIGURATION
+ * ========================================================================== */
+
+/**
+ * @brief Master enable switch for zone profiling
+ * @details Set to 0 to remove all instrumentation from the build
+ */
+#ifndef WS_PROFILE_ENABLE
+#define WS_PROFILE_ENABLE 1
+#endif
+
+/**
+ * @brief Profiled zones
+ */
+typedef enum {
+  WS_PROF_NRF_IRQ = 0U,   /**< ws_handle_irq(): drain RX FIFO and TX status */
+  WS_PROF_SD_APPEND,      /**< SD_Logger_AppendMeasurement(): format and queue */
+  WS_PROF_SD_DRAIN,       /**< SD_Logger_Task(): write-behind drain incl. FatFs and SPI */
+  WS_PROF_LCD_UPDATE,     /**< PCD8544_UpdateScreen() (DMA mode: start of transfer only) */
+  WS_PROF_UI_VIEW,        /**< WS_UI_ViewTask() incl. rendering */
+  WS_PROF_ZONE_COUNT      /**< Number of zones */
+} WS_ProfileZone_t;
+
+/* ============================================================================
+ * PUBLIC API
+ * ========================================================================== */
+
+#if WS_PROFILE_ENABLE
+
+#include "main.h"
+
+/**
+ * @brief Accumulated timing of one zone
+ */
+typedef struct {
+  uint32_t count;         /**< Completed BEGIN/END pairs */
+  uint32_t min_cycles;    /**< Shortest run (UINT32_MAX until the first run) */
+  uint32_t max_cycles;    /**< Longest run */
+  uint64_t total_cycles;  /**< Sum of all runs (mean = total / count) */
+} WS_ProfileStats_t;
+
+/**
+ * @brief Starts timing a zone; opens a local in the current scope
+ * @note  Zones are recorded from the main loop only; BEGIN and END must sit
+ *        in the same scope, with END before every return in between.
+ */
+#define WS_PROFILE_BEGIN(zone) const uint32_t ws_prof_start_##zone = DWT->CYCCNT
+
+/** @brief Stops timing a zone opened by WS_PROFILE_BEGIN() in this scope */
+#define WS_PROFILE_END(zone) WS_Profile_Record((zone), DWT->CYCCNT - ws_prof_start_##zone)
+
+/**
+ * @brief Enables the DWT cycle counter and clears all zones
+ * @note  CYCCNT is free-running: other users (NRF_DelayUs) must only read
+ *        it, never reset it, or open zones record garbage.
+ */
+void WS_Profile_Init(void);
+
+/**
+ * @brief Clears all zone statistics
+ */
+void WS_Profile_Reset(void);
+
+/**
+ * @brief Adds one run to a zone
+ * @param zone    Zone id
+ * @param cycles  Duration in CYCCNT ticks
+ */
+void WS_Profile_Record(WS_ProfileZone_t zone, uint32_t cycles);
+
+/**
+ * @brief Returns the statistics of one zone
+ * @retval Pointer to the statistics, or NULL for an invalid zone
+ */
+const WS_ProfileStats_t *WS_Profile_GetStats(WS_ProfileZone_t zone);
+
+/**
+ * @brief Writes one `PROF:` line per zone to a UART (blocking)
+ * @param huart UART to write to
+ */
+void WS_Profile_Dump(UART_HandleTypeDef *huart);
+
+#else
+
+#define WS_PROFILE_BEGIN(zone)
+#define WS_PROFILE_END(zone)
+#define WS_Profile_Init()
+#define WS_Profile_Reset()
+#define WS_Profile_Record(zone, cycles)
+#define WS_Profile_Dump(huart)
+
+#endif /* WS_PROFILE_ENABLE */
+
+#endif /* WS_PROFILE_H */
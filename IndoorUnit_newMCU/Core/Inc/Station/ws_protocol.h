@@ -2,11 +2,44 @@
  * @file ws_protocol.h
  * @brief Shared measurement payload protocol for Weather Station nRF24 / UART
  *
- * nRF24 binary frame (max 32 B):
- *   [version][sensor_status][count][channel_id+float] * count
+ * nRF24 binary frame v1 (max 32 B, up to 5 readings):
+ *   [0x01][sensor_status][count][channel_id+float] * count
  *
- * nRF24 measure command (8 B):
- *   [WS_CMD_MEASURE][cycle_id][target_mask][padding]
+ * nRF24 binary frame v2 (fixed-point, all 8 registry channels fit in 22 B):
+ *   [0x02][sensor_status][channel_bitmap][value] * popcount(channel_bitmap)
+ *   bitmap bit N = channel id N+1; values follow in ascending channel order,
+ *   little-endian two's complement: temperature int16 (0.01 °C),
+ *   humidity int16 (0.1 %RH), pressure int24 (0.01 hPa), lux int24 (1 lux).
+ *
+ * nRF24 fragment frame (one of `total` frames sharing a sequence number):
+ *   [0x03][sensor_status][seq][index<<4 | total][count][channel_id+float] * count
+ *   every fragment but the last carries WS_PROTOCOL_FRAG_MAX_READINGS records.
+ *
+ * nRF24 keyframe / delta frames (values relative to the last acknowledged keyframe):
+ *   [0x04][sensor_status][key_seq][channel_bitmap][value] * popcount   (v2 encoding)
+ *   [0x05][sensor_status][key_seq][channel_bitmap][int8 delta] * popcount
+ *   a delta is the difference in v2 raw counts against keyframe key_seq.
+ *
+ * nRF24 backlog frame (measurement buffered during a link outage, sent late):
+ *   [0x06][sensor_status][age_s lo][age_s hi][channel_bitmap][value] * popcount   (v2 encoding)
+ *
+ * nRF24 reply envelope (every frame above, node -> indoor):
+ *   [node_id][frame]
+ *   several nodes share one indoor RX pipe (node N uses WS_REPLY_PIPE(N)),
+ *   so the receiver demultiplexes on node_id rather than on the pipe number.
+ *
+ * nRF24 measure command (20 B, node masks are WS_NodeMask_t LE32):
+ *   [WS_CMD_MEASURE][cycle_id][target_mask][keyframe_mask][clock_s LE32][lead][slot_ms][late_mask]
+ *   clock_s is the indoor RTC in seconds; outdoor nodes have no clock of their
+ *   own (SysTick stops in STOP mode) and age backlog records against it.
+ *   Reply slots (TDMA): the first slot opens lead * 10 ms after the command,
+ *   each lasts slot_ms, and a node's slot index is the rank of its bit in
+ *   target_mask (lowest set bit = slot 0). slot_ms = 0 means no schedule.
+ *   Nodes in late_mask (weak links) take the slots after all other nodes.
+ *   cycle_id bit 7 clear: full cycle, numbered consecutively (mod 128), so a
+ *   node detects a missed one. Bit 7 set (WS_CMD_CYCLE_PARTIAL): re-poll of
+ *   the missed nodes or a single-node poll, counted separately so nodes it
+ *   does not target see no gap.
  *
  * UART line to Pico (example, BMP280 station):
  *   DATA:2026-05-09T11:06:01,S0,01:23.45,02:65.20,03:18.10,04:1013.25,05:120.0,OK\n
@@ -22,8 +55,18 @@
 #include <stddef.h>
 #include <stdint.h>
 
-/** @brief Protocol version byte in wire frame header */
+/** @brief Protocol version byte in wire frame header (v1: float records) */
 #define WS_PROTOCOL_VERSION      0x01U
+/** @brief Protocol version byte of the fixed-point channel-bitmap frame */
+#define WS_PROTOCOL_VERSION_V2   0x02U
+/** @brief Protocol version byte of a fragment of a multi-frame reply */
+#define WS_PROTOCOL_VERSION_FRAG 0x03U
+/** @brief Protocol version byte of a keyframe (v2 values + key sequence) */
+#define WS_PROTOCOL_VERSION_KEY   0x04U
+/** @brief Protocol version byte of a delta frame against a keyframe */
+#define WS_PROTOCOL_VERSION_DELTA 0x05U
+/** @brief Protocol version byte of a buffered measurement sent after a link outage */
+#define WS_PROTOCOL_VERSION_BACKLOG 0x06U
 /** @brief Maximum nRF24 payload size (bytes) */
 #define WS_PROTOCOL_MAX_PAYLOAD  32U
 /** @brief Header size: version + sensor_status + count */
@@ -31,25 +74,81 @@
 /** @brief Size of one reading record: channel_id (1 B) + float (4 B) */
 #define WS_PROTOCOL_RECORD_SIZE  5U
 /**
- * @brief Maximum number of readings per frame
+ * @brief Maximum number of readings in one v1 frame
  * @note 32 B payload allows at most 5 records: 3 + 5 * 5 = 28 B
  */
-#define WS_MAX_READINGS          5U
+#define WS_PROTOCOL_V1_MAX_READINGS 5U
+/** @brief v2 header size: version + sensor_status + channel_bitmap */
+#define WS_PROTOCOL_V2_HEADER_SIZE  3U
+/** @brief Keyframe / delta header size: version + sensor_status + key_seq + channel_bitmap */
+#define WS_PROTOCOL_KEY_HEADER_SIZE 4U
+/** @brief v2 frame size with every registry channel present: 3 + 5 * 2 + 3 * 3 */
+#define WS_PROTOCOL_V2_MAX_SIZE     22U
+/** @brief Backlog header size: version + sensor_status + age_s (2) + channel_bitmap */
+#define WS_PROTOCOL_BACKLOG_HEADER_SIZE 5U
+/** @brief Highest channel id in the registry (one v2 bitmap bit per channel) */
+#define WS_CH_MAX                0x08U
+/**
+ * @brief Maximum number of readings per node and cycle
+ * @note One per registry channel; a v2 frame carries all of them at once.
+ */
+#define WS_MAX_READINGS          WS_CH_MAX
+/** @brief Reply envelope header size: node_id in front of every node -> indoor frame */
+#define WS_PROTOCOL_REPLY_HEADER_SIZE 1U
+/** @brief Largest frame that fits in one reply payload behind the envelope header */
+#define WS_PROTOCOL_MAX_FRAME    (WS_PROTOCOL_MAX_PAYLOAD - WS_PROTOCOL_REPLY_HEADER_SIZE)
+/** @brief Fragment header size: version + sensor_status + seq + index/total + count */
+#define WS_PROTOCOL_FRAG_HEADER_SIZE  5U
+/** @brief Float records per fragment: 5 + 5 * 5 = 30 B */
+#define WS_PROTOCOL_FRAG_MAX_READINGS 5U
+/** @brief Largest fragment count expressible in the index/total nibble */
+#define WS_PROTOCOL_FRAG_MAX_TOTAL    15U
 
 /* ============================================================================
- * Measure command (nRF24, 8-byte fixed payload)
+ * Node addressing
+ * ============================================================================ */
+
+/** @brief Node bitset: bit N = NODE_ID N (command masks, cycle bookkeeping) */
+typedef uint32_t WS_NodeMask_t;
+/** @brief Highest node count a WS_NodeMask_t can address */
+#define WS_NODE_MASK_BITS        32U
+/** @brief Mask bit of NODE_ID @p id (id < WS_NODE_MASK_BITS) */
+#define WS_NODE_BIT(id)          ((WS_NodeMask_t)1U << (id))
+/** @brief Indoor RX pipes available for replies (nRF24 pipes 1-5; pipe 0 is the PTX ACK pipe) */
+#define WS_REPLY_PIPES           5U
+/** @brief Indoor RX pipe a node replies on; nodes WS_REPLY_PIPES apart share a pipe */
+#define WS_REPLY_PIPE(id)        ((uint8_t)(((id) % WS_REPLY_PIPES) + 1U))
+
+/* ============================================================================
+ * Measure command (nRF24, 20-byte fixed payload)
  * ============================================================================ */
 
 /** @brief Measure command byte (nRF24 command payload) */
 #define WS_CMD_MEASURE           0x01U
 /** @brief Fixed command payload size used by Indoor/Outdoor radios */
-#define WS_CMD_SIZE              8U
+#define WS_CMD_SIZE              20U
 /** @brief Byte offset of cycle_id inside the measure command payload */
 #define WS_CMD_CYCLE_ID_OFFSET   1U
-/** @brief Byte offset of target node bitmask (bit N = NODE_ID N) */
+/** @brief cycle_id flag of retry and single-node polls */
+#define WS_CMD_CYCLE_PARTIAL     0x80U
+/** @brief cycle_id counter bits (full cycles and partial polls count separately) */
+#define WS_CMD_CYCLE_SEQ_MASK    0x7FU
+/** @brief Byte offset of target node bitmask (WS_NodeMask_t LE, bit N = NODE_ID N) */
 #define WS_CMD_TARGET_MASK_OFFSET 2U
+/** @brief Byte offset of keyframe request bitmask (WS_NodeMask_t LE, bit N = NODE_ID N) */
+#define WS_CMD_KEYFRAME_MASK_OFFSET 6U
+/** @brief Byte offset of the indoor clock (uint32 LE, seconds; 0 = unknown) */
+#define WS_CMD_CLOCK_OFFSET      10U
+/** @brief Byte offset of the first reply slot delay (units of WS_CMD_LEAD_UNIT_MS) */
+#define WS_CMD_SLOT_LEAD_OFFSET  14U
+/** @brief Byte offset of the reply slot length in milliseconds (0 = no schedule) */
+#define WS_CMD_SLOT_LEN_OFFSET   15U
+/** @brief Byte offset of the late slot mask (WS_NodeMask_t LE; bit N = NODE_ID N replies after the others) */
+#define WS_CMD_SLOT_LATE_OFFSET  16U
+/** @brief Resolution of the first reply slot delay */
+#define WS_CMD_LEAD_UNIT_MS      10U
 /** @brief target_mask value meaning "all nodes" */
-#define WS_CMD_TARGET_ALL        0xFFU
+#define WS_CMD_TARGET_ALL        0xFFFFFFFFUL
 
 /* ============================================================================
  * Measurement payload types and API
@@ -101,33 +200,231 @@ typedef struct {
 } WS_Readings_t;
 
 /**
- * @brief   Calculates encoded frame size for a given reading count
- * @param   count  Number of readings (clamped to WS_MAX_READINGS)
+ * @brief   Calculates encoded v1 frame size for a given reading count
+ * @param   count  Number of readings (clamped to WS_PROTOCOL_V1_MAX_READINGS)
  * @retval  uint8_t  Required buffer size in bytes
  */
 uint8_t WS_Protocol_MaxEncodedSize(uint8_t count);
 
 /**
- * @brief   Encodes readings into binary wire format
+ * @brief   Encodes readings into binary wire format v1 (float records)
  * @param   in       Source readings structure
  * @param   buf      Destination buffer
  * @param   buf_size Buffer capacity
  * @param   out_len  Receives encoded length on success
  * @retval  true     Encoding successful
- * @retval  false    Invalid parameters or buffer too small
+ * @retval  false    Invalid parameters, more than WS_PROTOCOL_V1_MAX_READINGS
+ *                   readings, or buffer too small
  */
 bool WS_Protocol_Encode(const WS_Readings_t *in, uint8_t *buf, uint8_t buf_size, uint8_t *out_len);
 
 /**
- * @brief   Decodes binary wire format into readings structure
+ * @brief   Calculates encoded v2 frame size for a channel bitmap
+ * @param   channel_mask  Bit N set for channel id N+1
+ * @retval  uint8_t       Required buffer size in bytes
+ */
+uint8_t WS_Protocol_V2EncodedSize(uint8_t channel_mask);
+
+/**
+ * @brief   Encodes readings into binary wire format v2 (fixed-point, bitmap)
+ * @param   in       Source readings structure (any channel order)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Encoding successful; values outside a channel's range saturate
+ * @retval  false    Invalid parameters, unknown or duplicate channel id,
+ *                   non-finite value, or buffer too small
+ */
+bool WS_Protocol_EncodeV2(const WS_Readings_t *in, uint8_t *buf, uint8_t buf_size, uint8_t *out_len);
+
+/**
+ * @brief   Decodes a v1 or v2 binary frame into readings structure
  * @param   buf  Source buffer
  * @param   len  Buffer length in bytes
- * @param   out  Destination readings structure
+ * @param   out  Destination readings structure (v2: ascending channel order)
  * @retval  true     Decoding successful
- * @retval  false    Invalid parameters, version mismatch, or truncated frame
+ * @retval  false    Invalid parameters, unknown version, or truncated frame
  */
 bool WS_Protocol_Decode(const uint8_t *buf, uint8_t len, WS_Readings_t *out);
 
+/* ============================================================================
+ * Keyframe / delta frames
+ * ============================================================================ */
+
+/**
+ * @brief Reference values a delta frame is relative to (one per sender)
+ */
+typedef struct {
+  uint8_t valid;            /**< 1 once a keyframe has been stored */
+  uint8_t key_seq;          /**< Sequence number of the stored keyframe */
+  uint8_t channel_mask;     /**< Channel bitmap of the stored keyframe */
+  int32_t raw[WS_CH_MAX];   /**< v2 raw counts indexed by channel_id - 1 */
+} WS_DeltaKey_t;
+
+/**
+ * @brief   Encodes a keyframe (v2 values tagged with a key sequence number)
+ * @param   in       Source readings structure (any channel order)
+ * @param   key_seq  Key sequence number later deltas refer to (e.g. cycle id)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @param   key      Receives the reference state for WS_Protocol_EncodeDelta;
+ *                   adopt it only once the receiver acknowledged the frame
+ * @retval  true     Keyframe encoded
+ * @retval  false    Invalid parameters or readings (see WS_Protocol_EncodeV2)
+ */
+bool WS_Protocol_EncodeKeyframe(const WS_Readings_t *in, uint8_t key_seq, uint8_t *buf,
+                                uint8_t buf_size, uint8_t *out_len, WS_DeltaKey_t *key);
+
+/**
+ * @brief   Encodes readings as int8 deltas against an acknowledged keyframe
+ * @param   in       Source readings structure (any channel order)
+ * @param   key      Reference state from WS_Protocol_EncodeKeyframe
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Delta frame encoded
+ * @retval  false    No valid key, channel set changed, a delta exceeds int8,
+ *                   or buffer too small — send a keyframe instead
+ */
+bool WS_Protocol_EncodeDelta(const WS_Readings_t *in, const WS_DeltaKey_t *key, uint8_t *buf,
+                             uint8_t buf_size, uint8_t *out_len);
+
+/**
+ * @brief   Decodes any frame type, tracking keyframe state for delta frames
+ * @param   buf  Source buffer
+ * @param   len  Buffer length in bytes
+ * @param   key  Per-sender reference state; updated by keyframes
+ * @param   out  Destination readings structure
+ * @retval  true     Decoding successful
+ * @retval  false    Invalid or truncated frame, or a delta frame whose
+ *                   keyframe is unknown (request a keyframe from the sender)
+ */
+bool WS_Protocol_DecodeKeyed(const uint8_t *buf, uint8_t len, WS_DeltaKey_t *key, WS_Readings_t *out);
+
+/* ============================================================================
+ * Backlog frames
+ * ============================================================================ */
+
+/**
+ * @brief   Encodes a buffered (late) measurement with its age
+ * @param   in       Source readings structure (any channel order)
+ * @param   age_s    Seconds since the measurement was taken (saturate at 0xFFFF)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Backlog frame encoded
+ * @retval  false    Invalid parameters or readings (see WS_Protocol_EncodeV2)
+ */
+bool WS_Protocol_EncodeBacklog(const WS_Readings_t *in, uint16_t age_s, uint8_t *buf,
+                               uint8_t buf_size, uint8_t *out_len);
+
+/**
+ * @brief   Decodes a backlog frame
+ * @param   buf    Source buffer
+ * @param   len    Buffer length in bytes
+ * @param   age_s  Receives the measurement age in seconds (may be NULL)
+ * @param   out    Destination readings structure (ascending channel order)
+ * @retval  true   Decoding successful
+ * @retval  false  Invalid parameters, not a backlog frame, or truncated
+ * @note    WS_Protocol_Decode rejects backlog frames so they are never
+ *          mistaken for a live reply.
+ */
+bool WS_Protocol_DecodeBacklog(const uint8_t *buf, uint8_t len, uint16_t *age_s, WS_Readings_t *out);
+
+/* ============================================================================
+ * Fragmented replies
+ * ============================================================================ */
+
+/**
+ * @brief Result of feeding one fragment into a reassembly buffer
+ */
+typedef enum {
+  WS_FRAG_INVALID = 0U,  /**< Not a well-formed fragment; buffer unchanged */
+  WS_FRAG_PENDING,       /**< Stored; more fragments of this sequence outstanding */
+  WS_FRAG_DUPLICATE,     /**< Already stored or sequence already completed (TX retry) */
+  WS_FRAG_COMPLETE,      /**< Last missing fragment stored; readings are valid */
+} WS_FragResult_t;
+
+/**
+ * @brief Per-sender reassembly buffer for fragmented replies
+ */
+typedef struct {
+  uint8_t seq;                /**< Sequence number being collected */
+  uint8_t total;              /**< Fragment count announced by the sender */
+  uint8_t complete;           /**< 1 once @ref seq has been delivered */
+  uint8_t collecting;         /**< 1 while fragments of @ref seq are outstanding */
+  uint16_t received_mask;     /**< Bit N set when fragment N was stored */
+  WS_Readings_t readings;     /**< Reassembled readings (valid on WS_FRAG_COMPLETE) */
+} WS_FragAssembly_t;
+
+/**
+ * @brief   Number of fragment frames needed for @p count readings
+ * @param   count  Number of readings
+ * @retval  uint8_t  Fragment count (at least 1)
+ */
+uint8_t WS_Protocol_FragmentCount(uint8_t count);
+
+/**
+ * @brief   Encodes fragment @p index of a multi-frame reply
+ * @param   in       Source readings (all fragments are cut from the same set)
+ * @param   seq      Sequence number shared by all fragments (e.g. cycle id)
+ * @param   index    Fragment index, 0 .. WS_Protocol_FragmentCount(in->count) - 1
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Fragment encoded
+ * @retval  false    Invalid parameters, index out of range, or buffer too small
+ */
+bool WS_Protocol_EncodeFragment(const WS_Readings_t *in, uint8_t seq, uint8_t index,
+                                uint8_t *buf, uint8_t buf_size, uint8_t *out_len);
+
+/**
+ * @brief   Clears a reassembly buffer
+ * @param   fa  Reassembly buffer
+ */
+void WS_Frag_Reset(WS_FragAssembly_t *fa);
+
+/**
+ * @brief   Feeds a received fragment frame into a reassembly buffer
+ * @param   fa   Reassembly buffer of the sending node
+ * @param   buf  Received frame (version byte must be WS_PROTOCOL_VERSION_FRAG)
+ * @param   len  Frame length in bytes
+ * @retval  WS_FragResult_t  See enum; a new sequence number discards a partial set
+ */
+WS_FragResult_t WS_Frag_Accept(WS_FragAssembly_t *fa, const uint8_t *buf, uint8_t len);
+
+/* ============================================================================
+ * Reply envelope
+ * ============================================================================ */
+
+/**
+ * @brief   Prefixes an encoded frame with the sender's node id
+ * @param   node_id    NODE_ID of the sending node
+ * @param   frame      Encoded frame (any WS_PROTOCOL_VERSION_*)
+ * @param   frame_len  Frame length, at most WS_PROTOCOL_MAX_FRAME
+ * @param   buf        Destination buffer (must not overlap @p frame)
+ * @param   buf_size   Buffer capacity
+ * @param   out_len    Receives the payload length on success
+ * @retval  true       Envelope written
+ * @retval  false      Invalid parameters, frame too long, or buffer too small
+ */
+bool WS_Reply_Wrap(uint8_t node_id, const uint8_t *frame, uint8_t frame_len, uint8_t *buf,
+                   uint8_t buf_size, uint8_t *out_len);
+
+/**
+ * @brief   Splits a received reply payload into node id and frame
+ * @param   buf            Received payload
+ * @param   len            Payload length in bytes
+ * @param   out_node_id    Receives the sender's NODE_ID (may be NULL)
+ * @param   out_frame      Receives a pointer to the frame inside @p buf
+ * @param   out_frame_len  Receives the frame length
+ * @retval  true           Payload carries a node id and a non-empty frame
+ * @retval  false          Invalid parameters or payload too short
+ */
+bool WS_Reply_Unwrap(const uint8_t *buf, uint8_t len, uint8_t *out_node_id, const uint8_t **out_frame,
+                     uint8_t *out_frame_len);
+
 /**
  * @brief   Looks up a channel value in decoded readings
  * @param   r          Readings structure to search
@@ -157,7 +454,7 @@ bool WS_Protocol_SelfCheck(void);
  * ============================================================================ */
 
 /**
- * @brief   Encodes a broadcast measure command into an 8-byte nRF24 payload
+ * @brief   Encodes a broadcast measure command into a WS_CMD_SIZE nRF24 payload
  * @param   cycle_id  Measurement cycle identifier (0–255, wraps)
  * @param   buf       Destination buffer (must be at least WS_CMD_SIZE bytes)
  * @param   buf_size  Capacity of @p buf
@@ -176,7 +473,20 @@ bool WS_Cmd_EncodeMeasure(uint8_t cycle_id, uint8_t *buf, uint8_t buf_size);
  * @retval  true         Command encoded
  * @retval  false        Invalid buffer or insufficient size
  */
-bool WS_Cmd_EncodeMeasureTo(uint8_t cycle_id, uint8_t target_mask, uint8_t *buf, uint8_t buf_size);
+bool WS_Cmd_EncodeMeasureTo(uint8_t cycle_id, WS_NodeMask_t target_mask, uint8_t *buf, uint8_t buf_size);
+
+/**
+ * @brief   Encodes a measure command with target and keyframe request masks
+ * @param   cycle_id       Measurement cycle identifier
+ * @param   target_mask    Bit N set selects NODE_ID N; WS_CMD_TARGET_ALL = all nodes
+ * @param   keyframe_mask  Bit N set asks NODE_ID N to reply with a keyframe
+ * @param   buf            Destination buffer (must be at least WS_CMD_SIZE bytes)
+ * @param   buf_size       Capacity of @p buf
+ * @retval  true           Command encoded
+ * @retval  false          Invalid buffer or insufficient size
+ */
+bool WS_Cmd_EncodeMeasureEx(uint8_t cycle_id, WS_NodeMask_t target_mask, WS_NodeMask_t keyframe_mask,
+                            uint8_t *buf, uint8_t buf_size);
 
 /**
  * @brief   Decodes a measure command payload (cycle id only)
@@ -198,7 +508,73 @@ bool WS_Cmd_DecodeMeasure(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id
  * @retval  true             Valid WS_CMD_MEASURE frame
  * @retval  false            NULL buffer, too short, or wrong command byte
  */
-bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id, uint8_t *out_target_mask);
+bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id, WS_NodeMask_t *out_target_mask);
+
+/**
+ * @brief   Reads the keyframe request mask of a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  WS_NodeMask_t  Bit N set when NODE_ID N must send a keyframe; 0 when absent
+ */
+WS_NodeMask_t WS_Cmd_KeyframeMask(const uint8_t *buf, uint8_t len);
+
+/**
+ * @brief   Stamps the sender's clock into an encoded measure command
+ * @param   buf       Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size  Capacity of @p buf
+ * @param   clock_s   Indoor clock in seconds (0 = unknown)
+ * @retval  true      Clock written
+ * @retval  false     Invalid buffer or insufficient size
+ */
+bool WS_Cmd_SetClock(uint8_t *buf, uint8_t buf_size, uint32_t clock_s);
+
+/**
+ * @brief   Reads the sender's clock from a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  uint32_t  Indoor clock in seconds; 0 when absent or unknown
+ */
+uint32_t WS_Cmd_GetClock(const uint8_t *buf, uint8_t len);
+
+/**
+ * @brief   Writes the reply slot schedule into an encoded measure command
+ * @param   buf       Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size  Capacity of @p buf
+ * @param   lead_ms   Delay from command to the first slot (rounded up to WS_CMD_LEAD_UNIT_MS)
+ * @param   slot_ms   Length of every slot; 0 clears the schedule
+ * @retval  true      Schedule written
+ * @retval  false     Invalid buffer, insufficient size, or @p lead_ms too large
+ */
+bool WS_Cmd_SetSlots(uint8_t *buf, uint8_t buf_size, uint16_t lead_ms, uint8_t slot_ms);
+
+/**
+ * @brief   Reads the reply slot schedule from a measure command
+ * @param   buf          Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len          Buffer length in bytes
+ * @param   out_lead_ms  Receives the delay to the first slot (may be NULL)
+ * @param   out_slot_ms  Receives the slot length (may be NULL)
+ * @retval  true         Command carries a schedule
+ * @retval  false        Fields absent or slot length 0 (node picks its own delay)
+ */
+bool WS_Cmd_GetSlots(const uint8_t *buf, uint8_t len, uint16_t *out_lead_ms, uint8_t *out_slot_ms);
+
+/**
+ * @brief   Writes the late slot mask into an encoded measure command
+ * @param   buf        Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size   Capacity of @p buf
+ * @param   late_mask  Bit N set moves NODE_ID N behind every node not in the mask
+ * @retval  true       Mask written
+ * @retval  false      Invalid buffer or insufficient size
+ */
+bool WS_Cmd_SetLateMask(uint8_t *buf, uint8_t buf_size, WS_NodeMask_t late_mask);
+
+/**
+ * @brief   Reads the late slot mask of a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  WS_NodeMask_t  Bit N set when NODE_ID N replies after the others; 0 when absent
+ */
+WS_NodeMask_t WS_Cmd_LateMask(const uint8_t *buf, uint8_t len);
 
 /**
  * @brief   Detects a duplicate measurement cycle id
@@ -210,12 +586,22 @@ bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_
  */
 bool WS_Cmd_IsDuplicateCycle(uint8_t cycle_id, uint8_t last_cycle_id, uint8_t have_last);
 
+/**
+ * @brief   Detects a missed full measurement cycle
+ * @param   cycle_id      Incoming cycle id from command payload
+ * @param   last_full_id  Last accepted full-cycle id
+ * @param   have_last     Non-zero when @p last_full_id is valid
+ * @retval  true          Full-cycle id that does not follow @p last_full_id
+ * @retval  false         Partial poll (WS_CMD_CYCLE_PARTIAL), first cycle, or next id
+ */
+bool WS_Cmd_IsCycleGap(uint8_t cycle_id, uint8_t last_full_id, uint8_t have_last);
+
 /**
  * @brief   Builds the expected response bitmask for a parallel measurement cycle
- * @param   node_count  Number of outdoor nodes (0–8)
- * @retval  uint8_t     Bit mask with bits 0..(node_count-1) set; 0xFF when node_count >= 8
+ * @param   node_count  Number of outdoor nodes (0–WS_NODE_MASK_BITS)
+ * @retval  WS_NodeMask_t  Bits 0..(node_count-1) set; all bits when node_count >= WS_NODE_MASK_BITS
  */
-uint8_t WS_Cycle_ExpectedMask(uint8_t node_count);
+WS_NodeMask_t WS_Cycle_ExpectedMask(uint8_t node_count);
 
 /**
  * @brief   Checks whether all expected node responses were received
@@ -224,6 +610,25 @@ uint8_t WS_Cycle_ExpectedMask(uint8_t node_count);
  * @retval  true           Every expected bit is present in @p received_mask
  * @retval  false          At least one expected node has not responded
  */
-bool WS_Cycle_IsComplete(uint8_t expected_mask, uint8_t received_mask);
+bool WS_Cycle_IsComplete(WS_NodeMask_t expected_mask, WS_NodeMask_t received_mask);
+
+/**
+ * @brief   Returns the reply slot index of a node in a measure command
+ * @param   target_mask  Command target mask (WS_CMD_TARGET_ALL = all nodes)
+ * @param   late_mask    Nodes placed after all others (from WS_Cmd_LateMask)
+ * @param   node_id      NODE_ID of the replying node (0 .. WS_NODE_MASK_BITS - 1)
+ * @retval  uint8_t      Targeted nodes in the same group with a lower NODE_ID, plus
+ *                       every targeted node outside late_mask when @p node_id is late
+ */
+uint8_t WS_Cycle_SlotIndex(WS_NodeMask_t target_mask, WS_NodeMask_t late_mask, uint8_t node_id);
+
+/**
+ * @brief   Returns the time from command to the end of the last reply slot
+ * @param   target_mask  Command target mask (one slot per set bit)
+ * @param   lead_ms      Delay to the first slot
+ * @param   slot_ms      Slot length
+ * @retval  uint32_t     lead_ms + slot count * slot_ms
+ */
+uint32_t WS_Cycle_WindowMs(WS_NodeMask_t target_mask, uint16_t lead_ms, uint8_t slot_ms);
 
 #endif /* WS_PROTOCOL_H */
@@ -7,6 +7,7 @@
 
 #include "PCD8544.h"
 #include "stm32f1xx_hal_gpio.h"
+#include "ws_profile.h"
 
 /**
  * @brief Initializes the PCD8544 controller, framebuffer, and default font.
@@ -331,6 +332,7 @@ PCD_Status PCD8544_ClearScreen (PCD8544_t *PCD)
 PCD_Status PCD8544_UpdateScreen (PCD8544_t *PCD)
 {
 	PCD_Status status;
+	WS_PROFILE_BEGIN(WS_PROF_LCD_UPDATE);
 	
 	// Use appropriate communication mode
 	if (PCD->PCD8544_SPI_Mode == PCD_SPI_MODE_DMA)
@@ -342,6 +344,7 @@ PCD_Status PCD8544_UpdateScreen (PCD8544_t *PCD)
 		status = PCD8544_SendDataFromBuffer(PCD, PCD->buffer.PCD8544_BUFFER);
 	}
 	
+	WS_PROFILE_END(WS_PROF_LCD_UPDATE);
 	return status;
 }
 
@@ -2,8 +2,14 @@
  * @file debug_log.c
  * @brief UART debug logging implementation
  * @details Formats timestamped lines from the DS3231 snapshot (`rtcNow`) and
- *          sends them on USART1. Compiled only when `DEBUG_LOG_ENABLE` is set.
- *          Timestamp format: `LOG:[YYYY-MM-DD HH:MM:SS] ...`.
+ *          queues them for USART1 (uart_tx) and the SD status log, so a
+ *          call only formats and copies. Compiled only when `DEBUG_LOG_ENABLE`
+ *          is set.
+ *          Timestamp format: `LOG:[YYYY-MM-DD HH:MM:SS] ...`. With
+ *          `DEBUG_LOG_TOKENIZED` the same calls send ws_logtok records.
+ *          The `*At()` macros and the event helpers below drop a line before
+ *          any formatting when its module's runtime level (`debug_config`,
+ *          set with `CMD:LOG:<MOD>=<n>`) is lower than the line's level.
  */
 
 #include "debug_log.h"
@@ -13,36 +19,65 @@
 #include "usart.h"
 #include "ds3231.h"
 #include "sd_logger.h"
+#include "uart_tx.h"
+#include "ws_logtok.h"
 #include <stdio.h>
 #include <string.h>
 
 /** Current RTC date/time snapshot updated by `DS3231_EventHandler()`. */
 extern DS3231_DateTime rtcNow;
-/** USART1 handle used for blocking debug TX. */
+/** USART1 handle shared with the UART command replies. */
 extern UART_HandleTypeDef huart1;
 
 /* ============================================================================
  * PRIVATE VARIABLES
  * ========================================================================== */
 
+/** Runtime level of each module; set by the UART command handler. */
+volatile Debug_Config_t debug_config = {
+  .level = {
+    [DEBUG_MOD_SYS]   = DEBUG_LVL_DEFAULT,
+    [DEBUG_MOD_RADIO] = DEBUG_LVL_DEFAULT,
+    [DEBUG_MOD_SD]    = DEBUG_LVL_DEFAULT,
+    [DEBUG_MOD_UI]    = DEBUG_LVL_DEFAULT,
+    [DEBUG_MOD_RTC]   = DEBUG_LVL_DEFAULT,
+    [DEBUG_MOD_POWER] = DEBUG_LVL_DEFAULT,
+  },
+};
+/** Names accepted by `CMD:LOG:<MOD>=`, indexed by Debug_Module_t. */
+static const char *const debug_module_names[DEBUG_MOD_COUNT] = {
+  "SYS", "RADIO", "SD", "UI", "RTC", "PWR"
+};
 /** Scratch buffer for a single formatted log line. */
 static char debug_buffer[128];
 /** `HAL_GetTick()` of the last heartbeat line. */
 static uint32_t last_heartbeat_tick = 0;
 /** Number of heartbeat lines emitted since `Debug_Init()`. */
 static uint32_t heartbeat_count = 0;
+/** `UartTx_GetDropped()` value already reported with `LOG:TX_DROPPED=`. */
+static uint32_t tx_dropped_reported = 0;
+#ifdef DEBUG_LOG_TOKENIZED
+/** RTC day (YYMMDD) and minute (hhmm) of the last TIME record. */
+static uint32_t token_day = 0;
+static uint32_t token_hhmm = 0;
+#endif
 
 /* ============================================================================
  * PRIVATE FUNCTIONS
  * ========================================================================== */
 
 /**
- * @brief Send a buffer via UART (blocking)
+ * @brief Queue a buffer for UART TX (never blocks)
  * @param[in] str Bytes to transmit
  * @param[in] len Number of bytes
+ * @details Once a line fits again after lines were dropped on a full ring,
+ *          the number dropped so far follows it.
  */
 static void debug_send(const char *str, uint16_t len) {
-  HAL_UART_Transmit(&huart1, (uint8_t *)str, len, 100);
+  if ((UartTx_Write(&huart1, str, len) == 0U) && (UartTx_GetDropped() != tx_dropped_reported)) {
+    tx_dropped_reported = UartTx_GetDropped();
+    Debug_LogValue("LOG:TX_DROPPED=", (int32_t)tx_dropped_reported);
+  }
 }
 
 /**
@@ -51,10 +86,66 @@ static void debug_send(const char *str, uint16_t len) {
  * @param[in] len Number of bytes
  */
 static void debug_emit(const char *str, uint16_t len) {
-  debug_send(str, len);
   (void)SD_Logger_AppendStatus(str, len);
+  debug_send(str, len);
+}
+
+#ifdef DEBUG_LOG_TOKENIZED
+/**
+ * @brief Check that a string lives in flash, where the decoder can find it
+ */
+static uint8_t debug_in_flash(const char *str) {
+  uint32_t addr = (uint32_t)(uintptr_t)str;
+  return ((addr >= FLASH_BASE) && (addr <= FLASH_BANK1_END)) ? 1U : 0U;
 }
 
+/**
+ * @brief Send one tokenized record in place of a formatted line
+ * @param[in] kind  How the decoder expands @p str and the arguments
+ * @param[in] str   Message string or printf format (flash address = id)
+ * @param[in] nargs Number of valid arguments (0..2)
+ * @param[in] a0    First argument
+ * @param[in] a1    Second argument
+ * @retval 0 Record sent
+ * @retval 1 @p str is not in flash; the caller formats a text line instead
+ * @details The first record of each RTC minute is preceded by a TIME record
+ *          so the decoder can turn ticks back into wall-clock time.
+ */
+static uint8_t debug_token(WS_LogTokKind_t kind, const char *str, uint8_t nargs, int32_t a0, int32_t a1) {
+  WS_LogTok_Record_t rec;
+  uint8_t line[WS_LOGTOK_LINE_MAX];
+  uint16_t len;
+  uint32_t day = ((((uint32_t)rtcNow.year * 100U) + rtcNow.month) * 100U) + rtcNow.date;
+  uint32_t hhmm = ((uint32_t)rtcNow.hours * 100U) + rtcNow.minutes;
+
+  if (debug_in_flash(str) == 0U) {
+    return 1U;
+  }
+
+  rec.tick = HAL_GetTick();
+  if (((day != token_day) || (hhmm != token_hhmm)) && (rtcNow.month != 0U)) {
+    token_day = day;
+    token_hhmm = hhmm;
+    rec.kind = (uint8_t)WS_LOGTOK_TIME;
+    rec.nargs = 2U;
+    rec.id = 0U;
+    rec.args[0] = (int32_t)(20000000UL + day);
+    rec.args[1] = (int32_t)((hhmm * 100U) + rtcNow.seconds);
+    len = WS_LogTok_Encode(&rec, line, sizeof(line));
+    debug_emit((const char *)line, len);
+  }
+
+  rec.kind = (uint8_t)kind;
+  rec.nargs = nargs;
+  rec.id = (uint32_t)(uintptr_t)str - WS_LOGTOK_ID_BASE;
+  rec.args[0] = a0;
+  rec.args[1] = a1;
+  len = WS_LogTok_Encode(&rec, line, sizeof(line));
+  debug_emit((const char *)line, len);
+  return 0U;
+}
+#endif
+
 /**
  * @brief Format and send a message with a date/time prefix
  * @param[in] msg NULL-terminated payload after the timestamp
@@ -135,12 +226,51 @@ void Debug_Init(void) {
   Debug_LogBoot();
 }
 
+/**
+ * @brief Set the runtime level of one module
+ * @param[in] module Debug_Module_t value
+ * @param[in] level DEBUG_LVL_OFF..DEBUG_LVL_DEBUG
+ * @retval 0 Success, 1 out of range
+ */
+uint8_t Debug_SetLevel(uint8_t module, uint8_t level) {
+  if ((module >= (uint8_t)DEBUG_MOD_COUNT) || (level > DEBUG_LVL_DEBUG)) {
+    return 1U;
+  }
+  debug_config.level[module] = level;
+  return 0U;
+}
+
+/**
+ * @brief Get the runtime level of one module
+ * @param[in] module Debug_Module_t value
+ */
+uint8_t Debug_GetLevel(uint8_t module) {
+  if (module >= (uint8_t)DEBUG_MOD_COUNT) {
+    return DEBUG_LVL_OFF;
+  }
+  return debug_config.level[module];
+}
+
+/**
+ * @brief Short module name used by the UART command
+ * @param[in] module Debug_Module_t value
+ */
+const char *Debug_ModuleName(uint8_t module) {
+  if (module >= (uint8_t)DEBUG_MOD_COUNT) {
+    return NULL;
+  }
+  return debug_module_names[module];
+}
+
 /**
  * @brief Log a simple message
  * @param[in] msg NULL-terminated message string
  */
 void Debug_Log(const char *msg) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_TEXT, msg, 0U, 0, 0) == 0U) return;
+#endif
   debug_print_timestamped(msg);
 }
 
@@ -151,6 +281,9 @@ void Debug_Log(const char *msg) {
  */
 void Debug_LogValue(const char *msg, int32_t value) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_VALUE, msg, 1U, value, 0) == 0U) return;
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "LOG:[20%02u-%02u-%02u %02u:%02u:%02u] %s%ld\r\n",
                      rtcNow.year, rtcNow.month, rtcNow.date,
@@ -168,6 +301,9 @@ void Debug_LogValue(const char *msg, int32_t value) {
  */
 void Debug_LogHex(const char *msg, uint32_t value) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_HEX, msg, 1U, (int32_t)value, 0) == 0U) return;
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "LOG:[20%02u-%02u-%02u %02u:%02u:%02u] %s0x%08lX\r\n",
                      rtcNow.year, rtcNow.month, rtcNow.date,
@@ -180,20 +316,22 @@ void Debug_LogHex(const char *msg, uint32_t value) {
 
 /**
  * @brief Log RTC alarm 1 event (screen update)
- * @note Compiled only when `DEBUG_LOG_RTC1_EVENTS` is defined.
+ * @note Compiled only when `DEBUG_LOG_RTC1_EVENTS` is defined; RTC at DEBUG.
  */
 void Debug_LogRtcAlarm1(void) {
 #ifdef DEBUG_LOG_RTC1_EVENTS
+  if (!Debug_On(DEBUG_MOD_RTC, DEBUG_LVL_DEBUG)) return;
   Debug_Log("RTC:ALM1 (screen update)");
 #endif
 }
 
 /**
  * @brief Log RTC alarm 2 event (measurement trigger)
- * @note Compiled only when `DEBUG_LOG_RTC2_EVENTS` is defined.
+ * @note Compiled only when `DEBUG_LOG_RTC2_EVENTS` is defined; RTC at INFO.
  */
 void Debug_LogRtcAlarm2(void) {
 #ifdef DEBUG_LOG_RTC2_EVENTS
+  if (!Debug_On(DEBUG_MOD_RTC, DEBUG_LVL_INFO)) return;
   Debug_Log("RTC:ALM2 (measurement trigger)");
 #endif
 }
@@ -204,6 +342,7 @@ void Debug_LogRtcAlarm2(void) {
  * @param[in] node_idx Node index being addressed
  */
 void Debug_LogNrfTxStart(uint8_t node_idx) {
+  if (!Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_DEBUG)) return;
   Debug_LogValue("NRF:TX_START node=", node_idx);
 }
 
@@ -213,9 +352,9 @@ void Debug_LogNrfTxStart(uint8_t node_idx) {
  */
 void Debug_LogNrfTxResult(uint8_t success) {
   if (success) {
-    Debug_Log("NRF:TX_OK (ACK received)");
+    if (Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_DEBUG)) Debug_Log("NRF:TX_OK (ACK received)");
   } else {
-    Debug_Log("NRF:TX_FAIL (MAX_RT)");
+    if (Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_WARN)) Debug_Log("NRF:TX_FAIL (MAX_RT)");
   }
 }
 
@@ -223,6 +362,7 @@ void Debug_LogNrfTxResult(uint8_t success) {
  * @brief Log NRF NoAck TX success (TX_DS without peer ACK)
  */
 void Debug_LogNrfTxNoAck(void) {
+  if (!Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_DEBUG)) return;
   Debug_Log("NRF:TX_OK (NoAck sent)");
 }
 
@@ -231,6 +371,7 @@ void Debug_LogNrfTxNoAck(void) {
  * @param[in] node_idx Node index data came from
  */
 void Debug_LogNrfRxData(uint8_t node_idx) {
+  if (!Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_DEBUG)) return;
   Debug_LogValue("NRF:RX_DATA from node=", node_idx);
 }
 
@@ -239,6 +380,7 @@ void Debug_LogNrfRxData(uint8_t node_idx) {
  * @param[in] is_tx 1 if TX timeout, 0 if RX timeout
  */
 void Debug_LogNrfTimeout(uint8_t is_tx) {
+  if (!Debug_On(DEBUG_MOD_RADIO, DEBUG_LVL_WARN)) return;
   if (is_tx) {
     Debug_Log("NRF:TX_TIMEOUT");
   } else {
@@ -259,6 +401,13 @@ void Debug_LogNrfTimeout(uint8_t is_tx) { (void)is_tx; }
  * @param[in] action_name Action name string
  */
 void Debug_LogMenuAction(const char *action_name) {
+  if (!Debug_On(DEBUG_MOD_UI, DEBUG_LVL_INFO)) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if ((debug_in_flash(action_name) != 0U) &&
+      (debug_token(WS_LOGTOK_FMT, "MENU:%s", 1U, (int32_t)(uintptr_t)action_name, 0) == 0U)) {
+    return;
+  }
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "LOG:[20%02u-%02u-%02u %02u:%02u:%02u] MENU:%s\r\n",
                      rtcNow.year, rtcNow.month, rtcNow.date,
@@ -278,6 +427,10 @@ void Debug_LogMenuAction(const char *action_name) { (void)action_name; }
  * @param[in] to_state New state
  */
 void Debug_LogViewTransition(uint8_t from_state, uint8_t to_state) {
+  if (!Debug_On(DEBUG_MOD_UI, DEBUG_LVL_DEBUG)) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_FMT, "VIEW:%u->%u", 2U, from_state, to_state) == 0U) return;
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "LOG:[20%02u-%02u-%02u %02u:%02u:%02u] VIEW:%u->%u\r\n",
                      rtcNow.year, rtcNow.month, rtcNow.date,
@@ -6,9 +6,13 @@
  *          configuration is retained across Power Down.
  */
 
+#define DEBUG_LOG_MODULE DEBUG_MOD_POWER
+
 #include "power_mgr.h"
 
 #include "debug_log.h"
+#include "uart_tx.h"
+#include "ws_event.h"
 #include "wwdg.h"
 
 /** 1 if NRF was powered down by `PowerMgr_EnterIdleStop()`. */
@@ -27,23 +31,36 @@ void PowerMgr_Init(void)
 /**
  * @brief Power down NRF (if awake), enter STOP, restore clocks on wake
  * @param[in] nrf Radio handle
- * @note Returns immediately if `nrf` is NULL. After STOP, `SystemClock_Config()`
- *       must re-enable HSE/PLL because STOP disables them.
+ * @note Returns immediately if `nrf` is NULL or an event is queued. After STOP,
+ *       `SystemClock_Config()` must re-enable HSE/PLL because STOP disables them.
  */
 void PowerMgr_EnterIdleStop(NRF24_Handle_t *nrf)
 {
-  if (nrf == NULL)
+  if ((nrf == NULL) || !WS_Event_IsEmpty())
   {
     return;
   }
 
   if (radio_asleep == 0U)
   {
-    Debug_Log("PWR:ENTER");
+    Debug_LogAt(DEBUG_LVL_DEBUG, "PWR:ENTER");
     (void)NRF24_PowerDown(nrf);
     radio_asleep = 1U;
   }
 
+  /* STOP halts the USART mid-byte and wakes on HSI: finish queued lines. */
+  UartTx_Flush(UART_TX_FLUSH_TIMEOUT_MS);
+
+  /* Close the check-then-sleep race: an event posted after the last check
+   * would otherwise wait for the next wake-up. WFI still wakes on a pending
+   * IRQ with PRIMASK set; its handler runs once clocks are restored. */
+  __disable_irq();
+  if (!WS_Event_IsEmpty())
+  {
+    __enable_irq();
+    return;
+  }
+
   HAL_SuspendTick();
   HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
 
@@ -51,6 +68,7 @@ void PowerMgr_EnterIdleStop(NRF24_Handle_t *nrf)
   /* Keep SysTick disabled until the WWDG has been serviced. */
   WWDG_WaitRefresh();
   HAL_ResumeTick();
+  __enable_irq();
 }
 
 /**
@@ -68,7 +86,7 @@ void PowerMgr_WakeRadio(NRF24_Handle_t *nrf)
 
   (void)NRF24_PowerUp(nrf);
   radio_asleep = 0U;
-  Debug_Log("PWR:EXIT");
+  Debug_LogAt(DEBUG_LVL_DEBUG, "PWR:EXIT");
 }
 
 /**
@@ -1,148 +1,245 @@
 /**
  * @file sd_logger.c
- * @brief JSON Lines SD logger matching picoserver log_<station>.json format
+ * @brief SD logger: picoserver JSON Lines and/or compact binary day files
  * @details Mount is best-effort. I/O errors unmount the volume and retry
  *          after SD_LOGGER_RETRY_PERIOD_MS. Requires LFN (`_USE_LFN`) because
  *          `log_Sn.json` is not a legal 8.3 name.
+ *
+ *          Producers only format a line and queue it (SD_LOGGER_QUEUE_SIZE
+ *          byte ring, main-loop context only); SD_Logger_Task() writes it
+ *          out one sector's worth at a time while the radio is idle, so the
+ *          radio path never waits for the card.
+ *
+ *          Files stay open between appends: `status_log` in one handle and the
+ *          most recent measurement file in the other (`_FS_LOCK` = 2); with
+ *          both formats enabled the measurement handle alternates between
+ *          the JSON file and `Sn_YYMMDD.wsb`. Lines land
+ *          in the FatFs sector buffer and reach the card on f_sync, issued
+ *          after SD_LOGGER_SYNC_BYTES, after SD_LOGGER_SYNC_PERIOD_MS, on a
+ *          file switch, and from SD_Logger_Flush() before STOP mode. The
+ *          drain writes the queued records of the oldest record's file
+ *          before moving on, up to the one-sector budget of the call, so
+ *          several stations interleaved in the queue cost one file switch
+ *          each rather than one per record.
+ *
+ *          Binary day files are preallocated to SD_LOGGER_BIN_PREALLOC_RECORDS
+ *          when created, so a day's records usually sit in one contiguous
+ *          cluster run. The header's record count marks the logical end and
+ *          is updated on every sync. The handle runs in FatFs fast-seek mode
+ *          (CLMT), so seeks and cluster changes do not walk the FAT.
+ *
+ *          Power loss: every handle is reopened after a (re)mount, and the
+ *          first open of a file repairs it before anything is appended.
+ *          Text files already checked since the mount are remembered by
+ *          path hash and not re-read when the handle comes back to them.
+ *          - Text files lose a torn last line, so picoserver's JSON reader
+ *            never sees half a record.
+ *          - Binary files resume after the synced record count, plus every
+ *            following record whose sequence number and CRC still verify.
+ *            Records in sectors that reached the card survive without an
+ *            f_sync, because the preallocated size already covers them.
+ *
+ *          Rotation keeps every file bounded:
+ *          - Measurement lines go to one file per station and day,
+ *            `log_Sn_YYYYMMDD.json` (SD_LOGGER_ROTATE_DAILY).
+ *          - A file that reaches SD_LOGGER_FILE_MAX_BYTES continues in
+ *            `_1`, `_2`... parts.
+ *          - `status_log` is renamed to `status_log.1` at the cap.
+ *          - Once an hour, and after each mount, the oldest dated files
+ *            (JSON and `.wsb`, never today's) are deleted while free space
+ *            is below SD_LOGGER_MIN_FREE_KB.
+ *
+ *          Running counters (SD_Logger_GetStats(), `CMD:SD`) and a blocking
+ *          throughput benchmark (`CMD:SD:BENCH`) help pick cards and tune
+ *          the sync policy.
  */
 
+#define DEBUG_LOG_MODULE DEBUG_MOD_SD
+
 #include "sd_logger.h"
 
 #include "debug_log.h"
 #include "fatfs.h"
 #include "user_diskio_spi.h"
 #include "wwdg.h"
+#include "ws_logfmt.h"
 
 #include <stdio.h>
 #include <string.h>
 
 #define SD_LOGGER_LINE_MAX 320U
 #define SD_LOGGER_RETRY_PERIOD_MS 30000U
+/** Unsynced bytes in one file that force an f_sync. */
+#define SD_LOGGER_SYNC_BYTES 2048U
+/** Longest time appended bytes may stay unsynced while the loop is awake. */
+#define SD_LOGGER_SYNC_PERIOD_MS 10000U
+#define SD_LOGGER_PATH_MAX 32U
+/** Write-behind ring capacity in bytes (power of two; ~7 JSON lines). */
+#define SD_LOGGER_QUEUE_SIZE 2048U
+/** Queued bytes written per SD_Logger_Task() call (one sector). */
+#define SD_LOGGER_DRAIN_BYTES 512U
+/** Records preallocated per binary day file (one a minute plus backlog headroom). */
+#define SD_LOGGER_BIN_PREALLOC_RECORDS 2048U
+/** Cluster link map size in DWORDs: 2 + 2 per fragment (7 fragments). */
+#define SD_LOGGER_CLMT_ITEMS 16U
+/** Size cap of one JSON/status file; further lines go to the next part. */
+#define SD_LOGGER_FILE_MAX_BYTES (1024UL * 1024UL)
+/** JSON parts per station and day; the last part takes lines past the cap. */
+#define SD_LOGGER_MAX_PARTS 10U
+/** Free space below which the oldest dated log files are deleted. */
+#define SD_LOGGER_MIN_FREE_KB 8192UL
+/** Period of the free-space check. */
+#define SD_LOGGER_RETENTION_PERIOD_MS 3600000UL
+/** Files deleted per check at most (bounds one SD_Logger_Task() call). */
+#define SD_LOGGER_RETENTION_MAX_DELETE 8U
+/** Text files remembered as tail-checked since the mount (round robin). */
+#define SD_LOGGER_RECOVERED_MAX 16U
+/** Scratch file size per benchmark pass. */
+#define SD_LOGGER_BENCH_BYTES (64UL * 1024UL)
+
+#define SD_QUEUE_MASK (SD_LOGGER_QUEUE_SIZE - 1U)
+/** Record header: target, length LE16, measurement year, month, date. */
+#define SD_QUEUE_HDR_SIZE 6U
+/** Record target for `status_log`; lower values are station indices. */
+#define SD_QUEUE_TARGET_STATUS 0xFFU
+/** Target flag of binary records (`Sn_YYMMDD.wsb`); clear for JSON lines. */
+#define SD_QUEUE_TARGET_BINARY 0x80U
+/** Record already written by an earlier file batch; skipped by the drain. */
+#define SD_QUEUE_TARGET_DONE 0xFEU
+
+#if ((SD_LOGGER_QUEUE_SIZE & SD_QUEUE_MASK) != 0U)
+#error "SD_LOGGER_QUEUE_SIZE must be a power of two"
+#endif
+
+/** Persistent append handles (`_FS_LOCK` allows two open files). */
+typedef enum {
+  SD_SLOT_STATUS = 0,   /**< `status_log` */
+  SD_SLOT_MEASUREMENT,  /**< Last written JSON or `.wsb` file */
+  SD_SLOT_COUNT
+} SD_Slot_t;
+
+/** One file kept open for appending. */
+typedef struct {
+  FIL file;
+  char path[SD_LOGGER_PATH_MAX];
+  uint8_t open;          /**< 1 while `file` is a valid open handle */
+  uint16_t dirty_bytes;  /**< Bytes appended since the last f_sync */
+  uint32_t dirty_tick;   /**< `HAL_GetTick()` of the first unsynced append */
+  uint8_t bin_ready;     /**< Binary file: header checked and end aligned */
+  uint32_t bin_hours;    /**< Binary file: bit h set when index slot h is filled */
+  uint32_t bin_count;    /**< Binary file: records written (logical end) */
+  uint32_t bin_count_saved; /**< Binary file: record count stored in the header */
+  uint32_t bin_day_epoch; /**< Binary file: day epoch from the header (CRC seed) */
+  uint8_t bin_station;   /**< Binary file: station index from the header */
+  uint8_t tail_ok;       /**< Text file: torn-line check done since the mount */
+} SD_OpenFile_t;
 
 static uint8_t sd_ready = 0U;
 static uint8_t sd_io_busy = 0U;
 static uint32_t sd_next_retry_tick = 0U;
 static char sd_line[SD_LOGGER_LINE_MAX];
-static FIL sd_file;
-
-static const uint8_t SD_FIELD_CHANNELS[] = {
-    (uint8_t)WS_CH_SI7021_TEMP,
-    (uint8_t)WS_CH_SI7021_HUM,
-    (uint8_t)WS_CH_BMP280_TEMP,
-    (uint8_t)WS_CH_BMP280_PRESS,
-    (uint8_t)WS_CH_TSL2561_LUX,
-    (uint8_t)WS_CH_BME280_TEMP,
-    (uint8_t)WS_CH_BME280_PRESS,
-    (uint8_t)WS_CH_BME280_HUM,
-};
-
-static const char *const SD_FIELD_NAMES[] = {
-    "si7021_temp",
-    "si7021_hum",
-    "bmp280_temp",
-    "bmp280_press",
-    "tsl2561_lux",
-    "bme280_temp",
-    "bme280_press",
-    "bme280_hum",
-};
-
-#define SD_FIELD_COUNT (sizeof(SD_FIELD_CHANNELS) / sizeof(SD_FIELD_CHANNELS[0]))
+static SD_OpenFile_t sd_files[SD_SLOT_COUNT];
+/* Fast-seek table of the binary file in SD_SLOT_MEASUREMENT. */
+static DWORD sd_bin_clmt[SD_LOGGER_CLMT_ITEMS];
+
+/* Last JSON part written, so appends resume there instead of probing. */
+static uint8_t sd_json_station = 0xFFU;
+static uint32_t sd_json_day = 0U;
+static uint8_t sd_json_part = 0U;
+
+/* Newest measurement day (YYYYMMDD); retention never deletes it. */
+static uint32_t sd_today_key = 0U;
+static uint8_t sd_retention_due = 0U;
+static uint32_t sd_retention_tick = 0U;
+
+/* Write-behind queue: records appended by producers, written by SD_Logger_Task(). */
+static uint8_t sd_queue[SD_LOGGER_QUEUE_SIZE];
+static uint16_t sd_queue_head = 0U;
+static uint16_t sd_queue_tail = 0U;
+static uint16_t sd_queue_used = 0U;
+static uint32_t sd_queue_dropped = 0U;
+static uint32_t sd_queue_dropped_reported = 0U;
+
+/* FNV-1a hashes of text files whose tail was checked since the mount. */
+static uint32_t sd_recovered[SD_LOGGER_RECOVERED_MAX];
+static uint8_t sd_recovered_count = 0U;
+static uint8_t sd_recovered_next = 0U;
+
+static SD_Logger_Stats_t sd_stats;
+/* Set while SD_Logger_Benchmark() borrows sd_queue as its transfer buffer. */
+static uint8_t sd_bench_active = 0U;
+
+/* Labels of the USER_SPI_Stats wait histogram buckets. */
+static const char *const sd_wait_labels[USER_SPI_WAIT_BUCKETS] = {
+    "SD:WAIT_LT64US=", "SD:WAIT_LT256US=", "SD:WAIT_LT1MS=",  "SD:WAIT_LT4MS=",
+    "SD:WAIT_LT16MS=", "SD:WAIT_LT64MS=",  "SD:WAIT_LT256MS=", "SD:WAIT_GE256MS="};
 
 /**
- * @brief Mark the volume unavailable and log a FatFs/driver code.
- * @param reason UART prefix ending with `=` or similar (value is appended).
- * @param code   FRESULT or USER_SPI_Error value.
+ * @brief Microseconds since a DWT->CYCCNT sample (valid up to ~59 s).
  */
-static void sd_logger_mark_unavailable(const char *reason, int32_t code) {
-  sd_ready = 0U;
-  sd_next_retry_tick = HAL_GetTick() + SD_LOGGER_RETRY_PERIOD_MS;
-  Debug_LogValue(reason, code);
+static uint32_t sd_elapsed_us(uint32_t start_cycles) {
+  uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+  return (cycles_per_us != 0U) ? ((DWT->CYCCNT - start_cycles) / cycles_per_us) : 0U;
 }
 
 /**
- * @brief Format a float as a fixed-point decimal string without libc `%f`.
- * @param dst      Destination buffer.
- * @param dst_size Capacity in bytes.
- * @param value    Value to print.
- * @param decimals Digits after the decimal point (0 = integer).
+ * @brief FNV-1a hash of a path, the key of the tail-check memory.
  */
-static void sd_format_fixed(char *dst, size_t dst_size, float value, uint8_t decimals) {
-  int32_t scale = 1;
-  float scaled_f;
-  int32_t scaled;
-  int32_t abs_scaled;
-  int32_t int_part;
-  int32_t frac_part;
-
-  for (uint8_t i = 0U; i < decimals; i++) {
-    scale *= 10;
-  }
+static uint32_t sd_path_hash(const char *path) {
+  uint32_t hash = 2166136261UL;
 
-  scaled_f = value * (float)scale;
-  if (scaled_f >= 0.0f) {
-    scaled_f += 0.5f;
-  } else {
-    scaled_f -= 0.5f;
-  }
-
-  scaled = (int32_t)scaled_f;
-  abs_scaled = (scaled < 0) ? -scaled : scaled;
-  int_part = abs_scaled / scale;
-  frac_part = abs_scaled % scale;
-
-  if (decimals == 0U) {
-    (void)snprintf(dst, dst_size, "%s%ld", (scaled < 0) ? "-" : "", (long)int_part);
-  } else {
-    (void)snprintf(dst, dst_size, "%s%ld.%0*ld", (scaled < 0) ? "-" : "", (long)int_part,
-                   (int)decimals, (long)frac_part);
+  while (*path != '\0') {
+    hash = (hash ^ (uint8_t)*path++) * 16777619UL;
   }
+  return hash;
 }
 
 /**
- * @brief Format sensor_status as picoserver `OK` / `ERR:SI7021_BMP280`.
- * @param dst           Destination buffer.
- * @param dst_size      Capacity in bytes.
- * @param sensor_status Bitmask of WS_SENSOR_ERR_*.
+ * @brief Whether the tail of `path` was already checked since the mount.
  */
-static void sd_format_status(char *dst, size_t dst_size, uint8_t sensor_status) {
-  uint8_t known = sensor_status &
-      ((uint8_t)WS_SENSOR_ERR_SI7021 | (uint8_t)WS_SENSOR_ERR_BMP280 |
-       (uint8_t)WS_SENSOR_ERR_TSL2561 | (uint8_t)WS_SENSOR_ERR_BME280);
-  size_t used;
+static uint8_t sd_path_recovered(const char *path) {
+  uint32_t hash = sd_path_hash(path);
 
-  if ((dst == NULL) || (dst_size == 0U)) {
-    return;
+  for (uint8_t i = 0U; i < sd_recovered_count; i++) {
+    if (sd_recovered[i] == hash) {
+      return 1U;
+    }
   }
+  return 0U;
+}
 
-  if (known == (uint8_t)WS_SENSOR_OK) {
-    (void)snprintf(dst, dst_size, "OK");
+/**
+ * @brief Remember `path` as tail-checked, replacing the oldest entry when full.
+ */
+static void sd_path_mark_recovered(const char *path) {
+  if (sd_path_recovered(path) != 0U) {
     return;
   }
-
-  /* Match picoserver _normalize_status: ERR:SI7021_BMP280 (underscores). */
-  (void)snprintf(dst, dst_size, "ERR:");
-  used = strlen(dst);
-
-  if ((known & (uint8_t)WS_SENSOR_ERR_SI7021) != 0U) {
-    (void)snprintf(dst + used, dst_size - used, "%sSI7021", (used == 4U) ? "" : "_");
-    used = strlen(dst);
-  }
-  if ((known & (uint8_t)WS_SENSOR_ERR_BMP280) != 0U) {
-    (void)snprintf(dst + used, dst_size - used, "%sBMP280", (used == 4U) ? "" : "_");
-    used = strlen(dst);
-  }
-  if ((known & (uint8_t)WS_SENSOR_ERR_TSL2561) != 0U) {
-    (void)snprintf(dst + used, dst_size - used, "%sTSL2561", (used == 4U) ? "" : "_");
-    used = strlen(dst);
-  }
-  if ((known & (uint8_t)WS_SENSOR_ERR_BME280) != 0U) {
-    (void)snprintf(dst + used, dst_size - used, "%sBME280", (used == 4U) ? "" : "_");
+  sd_recovered[sd_recovered_next] = sd_path_hash(path);
+  sd_recovered_next = (uint8_t)((sd_recovered_next + 1U) % SD_LOGGER_RECOVERED_MAX);
+  if (sd_recovered_count < SD_LOGGER_RECOVERED_MAX) {
+    sd_recovered_count++;
   }
+}
 
-  if (strlen(dst) <= 4U) {
-    (void)snprintf(dst, dst_size, "ERR:UNKNOWN");
+/**
+ * @brief Mark the volume unavailable and log a FatFs/driver code.
+ * @param reason UART prefix ending with `=` or similar (value is appended).
+ * @param code   FRESULT or USER_SPI_Error value.
+ */
+static void sd_logger_mark_unavailable(const char *reason, int32_t code) {
+  /* Handles die with the volume; f_mount(NULL) in sd_ensure_ready() frees their locks. */
+  for (uint8_t i = 0U; i < (uint8_t)SD_SLOT_COUNT; i++) {
+    sd_files[i].open = 0U;
+    sd_files[i].dirty_bytes = 0U;
   }
+  /* The card may be swapped before the remount: check every tail again. */
+  sd_recovered_count = 0U;
+  sd_recovered_next = 0U;
+  sd_ready = 0U;
+  sd_next_retry_tick = HAL_GetTick() + SD_LOGGER_RETRY_PERIOD_MS;
+  Debug_LogValueAt(DEBUG_LVL_ERROR, reason, code);
 }
 
 /**
@@ -154,7 +251,7 @@ static uint8_t sd_try_mount(void) {
   FRESULT fr;
   DWORD sectors = 0U;
 
-  Debug_Log("SD:INIT_START");
+  Debug_LogAt(DEBUG_LVL_INFO, "SD:INIT_START");
 
   if (retUSER != 0U) {
     sd_logger_mark_unavailable("SD:LINK_FAIL ret=", (int32_t)retUSER);
@@ -166,18 +263,22 @@ static uint8_t sd_try_mount(void) {
   WWDG_TryRefresh();
 
   if (fr != FR_OK) {
-    Debug_LogValue("SD:MOUNT_FAIL fr=", (int32_t)fr);
+    Debug_LogValueAt(DEBUG_LVL_ERROR, "SD:MOUNT_FAIL fr=", (int32_t)fr);
     sd_logger_mark_unavailable("SD:DRV_ERR=", (int32_t)USER_SPI_get_last_error());
     return 1U;
   }
 
+  /* No recovery scan here: files reopen on demand, and each first open
+   * repairs its own tail (sd_text_recover(), sd_bin_recover()). */
   sd_ready = 1U;
-  Debug_LogValue("SD:TYPE=", (int32_t)USER_SPI_get_card_type());
+  sd_retention_due = 1U;
+  Debug_LogValueAt(DEBUG_LVL_INFO, "SD:TYPE=", (int32_t)USER_SPI_get_card_type());
+  Debug_LogValueAt(DEBUG_LVL_INFO, "SD:SPI_KHZ=", (int32_t)(USER_SPI_get_clock_hz() / 1000U));
   if (disk_ioctl(USER_SPI_PDRV, GET_SECTOR_COUNT, &sectors) == RES_OK) {
-    Debug_LogValue("SD:SECTORS=", (int32_t)sectors);
-    Debug_LogValue("SD:SIZE_KB=", (int32_t)(sectors / 2U));
+    Debug_LogValueAt(DEBUG_LVL_INFO, "SD:SECTORS=", (int32_t)sectors);
+    Debug_LogValueAt(DEBUG_LVL_INFO, "SD:SIZE_KB=", (int32_t)(sectors / 2U));
   }
-  Debug_Log("SD:INIT_OK");
+  Debug_LogAt(DEBUG_LVL_INFO, "SD:INIT_OK");
   return 0U;
 }
 
@@ -190,69 +291,669 @@ uint8_t SD_Logger_IsReady(void) {
 }
 
 /**
- * @brief Open-always, seek end, write `len` bytes, close.
- * @retval 0 Success or I/O failure (volume marked unavailable).
+ * @brief Overwrite `len` header bytes of a binary file and return to its end.
+ * @retval 0 Written.
+ * @retval 1 Seek/write failed (volume marked unavailable).
  */
-static uint8_t sd_append_bytes(const char *path, const void *data, UINT len) {
+static uint8_t sd_bin_patch_header(SD_OpenFile_t *slot, DWORD offset, const uint8_t *data, UINT len) {
+  DWORD end = f_tell(&slot->file);
+  UINT done = 0U;
+  FRESULT fr = f_lseek(&slot->file, offset);
+
+  if (fr == FR_OK) {
+    fr = f_write(&slot->file, data, len, &done);
+  }
+  if (fr == FR_OK) {
+    fr = f_lseek(&slot->file, end);
+  }
+  if ((fr != FR_OK) || (done != len)) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:BIN_HDR_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  return 0U;
+}
+
+/**
+ * @brief Write the FatFs sector buffer and directory entry of one open file.
+ * @details Binary files first store their record count in the header, so the
+ *          synced logical end never covers unsynced records.
+ * @retval 0 Synced or nothing to sync.
+ * @retval 1 f_sync failed (volume marked unavailable).
+ */
+static uint8_t sd_sync_slot(SD_OpenFile_t *slot) {
   FRESULT fr;
-  UINT written = 0U;
+  uint32_t start;
+  uint32_t elapsed;
 
-  if ((path == NULL) || (data == NULL) || (len == 0U)) {
+  if ((slot->open == 0U) || (slot->dirty_bytes == 0U)) {
     return 0U;
   }
 
-  if (sd_io_busy != 0U) {
+  if ((slot->bin_ready != 0U) && (slot->bin_count != slot->bin_count_saved)) {
+    uint8_t count[4] = {(uint8_t)slot->bin_count, (uint8_t)(slot->bin_count >> 8),
+                        (uint8_t)(slot->bin_count >> 16), (uint8_t)(slot->bin_count >> 24)};
+    if (sd_bin_patch_header(slot, WS_LOGFMT_BIN_COUNT_OFFSET, count, sizeof(count)) != 0U) {
+      return 1U;
+    }
+    slot->bin_count_saved = slot->bin_count;
+  }
+
+  WWDG_TryRefresh();
+  start = DWT->CYCCNT;
+  fr = f_sync(&slot->file);
+  elapsed = sd_elapsed_us(start);
+  WWDG_TryRefresh();
+  if (fr != FR_OK) {
+    sd_logger_mark_unavailable("SD:SYNC_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  sd_stats.syncs++;
+  if (elapsed > sd_stats.sync_us_max) {
+    sd_stats.sync_us_max = elapsed;
+  }
+  slot->dirty_bytes = 0U;
+  return 0U;
+}
+
+/**
+ * @brief Sync and close one handle.
+ * @retval 0 Closed or not open.
+ * @retval 1 Sync/close failed (volume marked unavailable).
+ */
+static uint8_t sd_close_slot(SD_OpenFile_t *slot) {
+  FRESULT fr;
+
+  if (slot->open == 0U) {
     return 0U;
   }
-  sd_io_busy = 1U;
+  if (sd_sync_slot(slot) != 0U) {
+    return 1U;
+  }
+
+  WWDG_TryRefresh();
+  fr = f_close(&slot->file);
+  slot->open = 0U;
+  slot->dirty_bytes = 0U;
+  if (fr != FR_OK) {
+    sd_logger_mark_unavailable("SD:CLOSE_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  return 0U;
+}
+
+/**
+ * @brief Make `slot` an open append handle on `path`.
+ * @details Keeps the handle when it already points at `path`; otherwise
+ *          closes the previous file (flushing it) and opens `path` at its end.
+ * @retval 0 Handle ready.
+ * @retval 1 Close/open/seek failed (volume marked unavailable).
+ */
+static uint8_t sd_open_slot(SD_OpenFile_t *slot, const char *path) {
+  FRESULT fr;
+
+  if ((slot->open != 0U) && (strcmp(slot->path, path) == 0)) {
+    return 0U;
+  }
+
+  if (sd_close_slot(slot) != 0U) {
+    return 1U;
+  }
 
   WWDG_TryRefresh();
   /* FatFs R0.11: OPEN_ALWAYS + seek end ≈ append. */
-  fr = f_open(&sd_file, path, FA_OPEN_ALWAYS | FA_WRITE);
+  fr = f_open(&slot->file, path, FA_OPEN_ALWAYS | FA_WRITE | FA_READ);
   if (fr != FR_OK) {
-    sd_io_busy = 0U;
     sd_logger_mark_unavailable("SD:OPEN_FAIL fr=", (int32_t)fr);
-    return 0U;
+    return 1U;
   }
-  fr = f_lseek(&sd_file, f_size(&sd_file));
+  fr = f_lseek(&slot->file, f_size(&slot->file));
   if (fr != FR_OK) {
-    (void)f_close(&sd_file);
-    sd_io_busy = 0U;
+    (void)f_close(&slot->file);
     sd_logger_mark_unavailable("SD:SEEK_FAIL fr=", (int32_t)fr);
-    return 0U;
+    return 1U;
   }
 
+  (void)snprintf(slot->path, sizeof(slot->path), "%s", path);
+  slot->open = 1U;
+  slot->dirty_bytes = 0U;
+  slot->bin_ready = 0U;
+  slot->tail_ok = sd_path_recovered(path);
+  return 0U;
+}
+
+/**
+ * @brief Append to an open handle and apply the sync policy.
+ * @details Syncs once SD_LOGGER_SYNC_BYTES are pending or the oldest pending
+ *          byte is SD_LOGGER_SYNC_PERIOD_MS old.
+ * @retval 0 Written.
+ * @retval 1 Write failed (volume marked unavailable).
+ */
+static uint8_t sd_write_slot(SD_OpenFile_t *slot, const void *data, UINT len) {
+  FRESULT fr;
+  UINT written = 0U;
+  uint32_t now;
+  uint32_t start;
+  uint32_t elapsed;
+
   WWDG_TryRefresh();
-  fr = f_write(&sd_file, data, len, &written);
+  start = DWT->CYCCNT;
+  fr = f_write(&slot->file, data, len, &written);
+  elapsed = sd_elapsed_us(start);
   WWDG_TryRefresh();
-  {
-    FRESULT fr_close = f_close(&sd_file);
-    sd_io_busy = 0U;
-    if ((fr != FR_OK) || (written != len)) {
-      sd_logger_mark_unavailable("SD:WRITE_FAIL fr=", (int32_t)fr);
-      if ((fr == FR_OK) && (written != len)) {
-        Debug_LogValue("SD:WRITE_FAIL n=", (int32_t)written);
+  if ((fr != FR_OK) || (written != len)) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:WRITE_FAIL fr=", (int32_t)fr);
+    if ((fr == FR_OK) && (written != len)) {
+      Debug_LogValueAt(DEBUG_LVL_ERROR, "SD:WRITE_FAIL n=", (int32_t)written);
+    }
+    return 1U;
+  }
+  sd_stats.bytes_written += len;
+  sd_stats.writes++;
+  sd_stats.write_us_total += elapsed;
+  if (elapsed > sd_stats.write_us_max) {
+    sd_stats.write_us_max = elapsed;
+  }
+
+  now = HAL_GetTick();
+  if (slot->dirty_bytes == 0U) {
+    slot->dirty_tick = now;
+  }
+  slot->dirty_bytes = (uint16_t)(slot->dirty_bytes + len);
+  if ((slot->dirty_bytes >= SD_LOGGER_SYNC_BYTES) ||
+      ((now - slot->dirty_tick) >= SD_LOGGER_SYNC_PERIOD_MS)) {
+    return sd_sync_slot(slot);
+  }
+  return 0U;
+}
+
+/**
+ * @brief Cut a torn last line off a text log after power loss.
+ * @details Runs once per file and mount. A file whose last byte is not '\n' is
+ *          truncated after its last complete line, searched for within the
+ *          last SD_LOGGER_LINE_MAX bytes.
+ * @retval 0 Tail clean or repaired; position at the end of the file.
+ * @retval 1 I/O failure (volume marked unavailable).
+ */
+static uint8_t sd_text_recover(SD_OpenFile_t *slot) {
+  uint8_t chunk[32];
+  DWORD size = f_size(&slot->file);
+  DWORD pos = size;
+  DWORD keep = 0U;
+  FRESULT fr = FR_OK;
+  UINT done = 0U;
+
+  slot->tail_ok = 1U;
+  while ((pos > 0U) && ((size - pos) < SD_LOGGER_LINE_MAX)) {
+    UINT n = (pos < sizeof(chunk)) ? (UINT)pos : (UINT)sizeof(chunk);
+
+    /* The first pass reads just the last byte: the common, clean case. */
+    if (pos == size) {
+      n = 1U;
+    }
+    pos -= n;
+    fr = f_lseek(&slot->file, pos);
+    if (fr == FR_OK) {
+      fr = f_read(&slot->file, chunk, n, &done);
+    }
+    if ((fr != FR_OK) || (done != n)) {
+      break;
+    }
+    while ((n > 0U) && (chunk[n - 1U] != (uint8_t)'\n')) {
+      n--;
+    }
+    if (n > 0U) {
+      keep = pos + n;
+      break;
+    }
+    keep = pos;
+  }
+
+  if ((fr == FR_OK) && (done != 0U) && (keep != size)) {
+    fr = f_lseek(&slot->file, keep);
+    if (fr == FR_OK) {
+      fr = f_truncate(&slot->file);
+    }
+    if (fr == FR_OK) {
+      Debug_LogValueAt(DEBUG_LVL_WARN, "SD:TAIL_CUT=", (int32_t)(size - keep));
+      slot->dirty_tick = HAL_GetTick();
+      slot->dirty_bytes = 1U;
+    }
+  }
+  if (fr == FR_OK) {
+    fr = f_lseek(&slot->file, f_size(&slot->file));
+  }
+  if (fr != FR_OK) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:RECOVER_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  sd_path_mark_recovered(slot->path);
+  return 0U;
+}
+
+/**
+ * @brief Append one line to `status_log`, rotating it at the size cap.
+ * @details At SD_LOGGER_FILE_MAX_BYTES the file becomes `status_log.1`
+ *          (replacing the previous one) and a new `status_log` starts.
+ */
+static void sd_append_status(const void *data, UINT len) {
+  SD_OpenFile_t *slot = &sd_files[SD_SLOT_STATUS];
+  char path[SD_LOGGER_PATH_MAX];
+  char old_path[SD_LOGGER_PATH_MAX];
+  FRESULT fr;
+
+  (void)snprintf(path, sizeof(path), "%sstatus_log", USERPath);
+  if ((sd_open_slot(slot, path) != 0U) ||
+      ((slot->tail_ok == 0U) && (sd_text_recover(slot) != 0U))) {
+    return;
+  }
+
+  if ((f_size(&slot->file) + len) > SD_LOGGER_FILE_MAX_BYTES) {
+    if (sd_close_slot(slot) != 0U) {
+      return;
+    }
+    (void)snprintf(old_path, sizeof(old_path), "%sstatus_log.1", USERPath);
+    fr = f_unlink(old_path);
+    if ((fr == FR_OK) || (fr == FR_NO_FILE)) {
+      fr = f_rename(path, old_path);
+    }
+    if (fr != FR_OK) {
+      sd_logger_mark_unavailable("SD:ROTATE_FAIL fr=", (int32_t)fr);
+      return;
+    }
+    if (sd_open_slot(slot, path) != 0U) {
+      return;
+    }
+  }
+
+  (void)sd_write_slot(slot, data, len);
+}
+
+/**
+ * @brief Build the JSON log path of a station, day and part.
+ * @details `log_Sn_YYYYMMDD.json`, then `log_Sn_YYYYMMDD_1.json` and so on.
+ *          Without a known date, or with SD_LOGGER_ROTATE_DAILY = 0, the
+ *          base name is `log_Sn`.
+ */
+static void sd_json_path(char *path, size_t size, uint8_t station_idx, uint32_t day_key, uint8_t part) {
+  char part_suffix[4] = "";
+
+  if (part != 0U) {
+    (void)snprintf(part_suffix, sizeof(part_suffix), "_%u", (unsigned int)part);
+  }
+#if SD_LOGGER_ROTATE_DAILY
+  if (day_key != 0U) {
+    (void)snprintf(path, size, "%slog_S%u_%08lu%s.json", USERPath, (unsigned int)station_idx,
+                   (unsigned long)day_key, part_suffix);
+    return;
+  }
+#else
+  (void)day_key;
+#endif
+  (void)snprintf(path, size, "%slog_S%u%s.json", USERPath, (unsigned int)station_idx, part_suffix);
+}
+
+/**
+ * @brief Append one JSON line to its station/day file, moving on to the
+ *        next part once the current one would exceed SD_LOGGER_FILE_MAX_BYTES.
+ */
+static void sd_append_json(uint8_t station_idx, uint32_t day_key, const void *data, UINT len) {
+  SD_OpenFile_t *slot = &sd_files[SD_SLOT_MEASUREMENT];
+  char path[SD_LOGGER_PATH_MAX];
+  uint8_t part = 0U;
+
+  if ((station_idx == sd_json_station) && (day_key == sd_json_day)) {
+    part = sd_json_part;
+  }
+
+  for (;;) {
+    sd_json_path(path, sizeof(path), station_idx, day_key, part);
+    if ((sd_open_slot(slot, path) != 0U) ||
+        ((slot->tail_ok == 0U) && (sd_text_recover(slot) != 0U))) {
+      return;
+    }
+    if (((f_size(&slot->file) + len) <= SD_LOGGER_FILE_MAX_BYTES) ||
+        ((uint8_t)(part + 1U) >= SD_LOGGER_MAX_PARTS)) {
+      break;
+    }
+    part++;
+  }
+
+  sd_json_station = station_idx;
+  sd_json_day = day_key;
+  sd_json_part = part;
+  (void)sd_write_slot(slot, data, len);
+}
+
+/**
+ * @brief Day key (YYYYMMDD) of a rotated log file name.
+ * @details Matches `log_Sn_YYYYMMDD[_k].json` and `Sn_YYMMDD.wsb`.
+ * @retval Day key, or 0 for any other file.
+ */
+static uint32_t sd_name_day_key(const char *name) {
+  const char *p = name;
+  uint32_t key = 0U;
+  uint8_t expected;
+  uint8_t digits = 0U;
+
+  if (strncmp(p, "log_S", 5U) == 0) {
+    p += 5;
+    expected = 8U;
+  } else if (p[0] == 'S') {
+    p += 1;
+    expected = 6U;
+  } else {
+    return 0U;
+  }
+
+  if ((*p < '0') || (*p > '9')) {
+    return 0U;
+  }
+  while ((*p >= '0') && (*p <= '9')) {
+    p++;
+  }
+  if (*p != '_') {
+    return 0U;
+  }
+  p++;
+  while ((*p >= '0') && (*p <= '9') && (digits < expected)) {
+    key = (key * 10U) + (uint32_t)(*p - '0');
+    p++;
+    digits++;
+  }
+  if (digits != expected) {
+    return 0U;
+  }
+
+  if (expected == 6U) {
+    return (strcmp(p, ".wsb") == 0) ? (20000000UL + key) : 0U;
+  }
+  return ((*p == '.') || (*p == '_')) ? key : 0U;
+}
+
+/**
+ * @brief Find the oldest rotated log file from a day before `before`.
+ * @param name Receives the file name (without drive prefix).
+ * @retval Day key of that file, 0 when there is none.
+ */
+static uint32_t sd_find_oldest(uint32_t before, char *name, size_t name_size) {
+  DIR dir;
+  FILINFO fno;
+  char lfn[SD_LOGGER_PATH_MAX];
+  uint32_t oldest = 0U;
+
+  /* Longer names do not fit lfn and come back as 8.3 aliases (no match). */
+  fno.lfname = lfn;
+  fno.lfsize = sizeof(lfn);
+  if (f_opendir(&dir, USERPath) != FR_OK) {
+    return 0U;
+  }
+
+  while ((f_readdir(&dir, &fno) == FR_OK) && (fno.fname[0] != '\0')) {
+    const char *fn = (lfn[0] != '\0') ? lfn : fno.fname;
+    uint32_t key;
+
+    if ((fno.fattrib & AM_DIR) != 0U) {
+      continue;
+    }
+    key = sd_name_day_key(fn);
+    if ((key != 0U) && (key < before) && ((oldest == 0U) || (key < oldest))) {
+      oldest = key;
+      (void)snprintf(name, name_size, "%s", fn);
+    }
+    WWDG_TryRefresh();
+  }
+
+  (void)f_closedir(&dir);
+  return oldest;
+}
+
+/**
+ * @brief Delete the oldest dated log files while free space is low.
+ * @details Closes both handles first: directory access needs a lock slot
+ *          (`_FS_LOCK` = 2) and open files cannot be deleted. Deletes at
+ *          most SD_LOGGER_RETENTION_MAX_DELETE files per call, oldest day
+ *          first, and never files of the newest measurement day.
+ */
+static void sd_retention_check(void) {
+  char name[SD_LOGGER_PATH_MAX];
+  char path[SD_LOGGER_PATH_MAX + 4U];
+  FATFS *fs = NULL;
+  DWORD free_clusters = 0U;
+  FRESULT fr;
+
+  for (uint8_t i = 0U; i < (uint8_t)SD_SLOT_COUNT; i++) {
+    if (sd_close_slot(&sd_files[i]) != 0U) {
+      return;
+    }
+  }
+
+  for (uint8_t deleted = 0U; deleted < SD_LOGGER_RETENTION_MAX_DELETE; deleted++) {
+    uint32_t key;
+
+    WWDG_TryRefresh();
+    fr = f_getfree(USERPath, &free_clusters, &fs);
+    if (fr != FR_OK) {
+      sd_logger_mark_unavailable("SD:GETFREE_FAIL fr=", (int32_t)fr);
+      return;
+    }
+    if (((free_clusters * fs->csize) / 2U) >= SD_LOGGER_MIN_FREE_KB) {
+      return;
+    }
+
+    key = sd_find_oldest(sd_today_key, name, sizeof(name));
+    if (key == 0U) {
+      Debug_LogValueAt(DEBUG_LVL_WARN, "SD:LOW_SPACE_KB=", (int32_t)((free_clusters * fs->csize) / 2U));
+      return;
+    }
+    (void)snprintf(path, sizeof(path), "%s%s", USERPath, name);
+    fr = f_unlink(path);
+    if (fr != FR_OK) {
+      sd_logger_mark_unavailable("SD:UNLINK_FAIL fr=", (int32_t)fr);
+      return;
+    }
+    Debug_LogValueAt(DEBUG_LVL_INFO, "SD:RETENTION_DEL_DAY=", (int32_t)key);
+  }
+}
+
+/**
+ * @brief Put a binary file's handle into fast-seek mode.
+ * @details Builds the cluster link map, so later seeks and cluster changes
+ *          inside the allocated size are resolved from RAM instead of the FAT.
+ *          A file with more fragments than the table holds stays in normal
+ *          mode. The fragment count is logged when the preallocation was
+ *          not contiguous.
+ */
+static void sd_bin_fast_seek(SD_OpenFile_t *slot) {
+  FRESULT fr;
+
+  sd_bin_clmt[0] = SD_LOGGER_CLMT_ITEMS;
+  slot->file.cltbl = sd_bin_clmt;
+  fr = f_lseek(&slot->file, CREATE_LINKMAP);
+  if (fr != FR_OK) {
+    slot->file.cltbl = NULL;
+    Debug_LogValueAt(DEBUG_LVL_WARN, "SD:BIN_CLMT fr=", (int32_t)fr);
+    return;
+  }
+  if (sd_bin_clmt[0] > 4U) {
+    Debug_LogValueAt(DEBUG_LVL_DEBUG, "SD:BIN_FRAGMENTS=", (int32_t)((sd_bin_clmt[0] - 2U) / 2U));
+  }
+}
+
+/**
+ * @brief Count the sealed records after the synced record count.
+ * @details Stops at the first record whose sequence, station or CRC does not
+ *          match: unsynced tail, torn write, or stale data in preallocation.
+ *          Recovered records also fill their hour's index slot if missing.
+ * @param max_records Records that fit in the file's size.
+ * @retval 0 Done (the count is synced with the next f_sync).
+ * @retval 1 I/O failure (volume marked unavailable).
+ */
+static uint8_t sd_bin_recover(SD_OpenFile_t *slot, uint32_t max_records) {
+  uint8_t record[WS_LOGFMT_BIN_RECORD_SIZE];
+  uint32_t recovered = 0U;
+  uint8_t hour;
+  UINT done = 0U;
+  FRESULT fr = f_lseek(&slot->file, WS_LOGFMT_BIN_HEADER_SIZE + (slot->bin_count * WS_LOGFMT_BIN_RECORD_SIZE));
+
+  while ((fr == FR_OK) && (slot->bin_count < max_records)) {
+    fr = f_read(&slot->file, record, sizeof(record), &done);
+    if ((fr != FR_OK) || (done != sizeof(record)) ||
+        !WS_LogFmt_BinVerify(record, (uint16_t)slot->bin_count, slot->bin_station, slot->bin_day_epoch)) {
+      break;
+    }
+    hour = (uint8_t)((((uint32_t)record[0] | ((uint32_t)record[1] << 8) | ((uint32_t)record[2] << 16) |
+                       ((uint32_t)record[3] << 24)) % WS_LOGFMT_DAY_S) / 3600UL);
+    if ((slot->bin_hours & (1UL << hour)) == 0U) {
+      uint8_t slot_bytes[2] = {(uint8_t)slot->bin_count, (uint8_t)(slot->bin_count >> 8)};
+      if (sd_bin_patch_header(slot, WS_LOGFMT_BIN_INDEX_OFFSET(hour), slot_bytes, sizeof(slot_bytes)) != 0U) {
+        return 1U;
       }
-      return 0U;
+      slot->bin_hours |= (1UL << hour);
     }
-    if (fr_close != FR_OK) {
-      sd_logger_mark_unavailable("SD:CLOSE_FAIL fr=", (int32_t)fr_close);
-      return 0U;
+    slot->bin_count++;
+    recovered++;
+  }
+  if (fr != FR_OK) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:RECOVER_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  if (recovered != 0U) {
+    Debug_LogValueAt(DEBUG_LVL_WARN, "SD:BIN_RECOVERED=", (int32_t)recovered);
+    slot->dirty_tick = HAL_GetTick();
+    slot->dirty_bytes = 1U;
+  }
+  return 0U;
+}
+
+/**
+ * @brief Check or create the header of a freshly opened binary day file.
+ * @details A new file gets its header and is grown to
+ *          SD_LOGGER_BIN_PREALLOC_RECORDS in one seek. An existing file
+ *          resumes after the record count stored in its header, extended
+ *          by the records after it that still verify (written after the
+ *          last sync). Also loads which time index slots are filled.
+ * @retval 0 Ready for records.
+ * @retval 1 Foreign/corrupt header or I/O failure (record skipped).
+ */
+static uint8_t sd_bin_prepare(SD_OpenFile_t *slot, uint8_t station_idx, uint32_t epoch) {
+  uint8_t header[WS_LOGFMT_BIN_HEADER_SIZE];
+  DWORD size = f_size(&slot->file);
+  FRESULT fr;
+  UINT done = 0U;
+
+  slot->bin_hours = 0U;
+  slot->bin_count = 0U;
+  if (size < WS_LOGFMT_BIN_HEADER_SIZE) {
+    WS_LogFmt_BinHeader(station_idx, epoch - (epoch % WS_LOGFMT_DAY_S), header);
+    fr = f_lseek(&slot->file, 0U);
+    if (fr == FR_OK) {
+      fr = f_write(&slot->file, header, WS_LOGFMT_BIN_HEADER_SIZE, &done);
+    }
+    /* FatFs R0.11 has no f_expand: seeking past the end in write mode
+     * allocates the chain, from consecutive free clusters where possible.
+     * A full volume stops short without an error. */
+    if ((fr == FR_OK) && (done == WS_LOGFMT_BIN_HEADER_SIZE)) {
+      WWDG_TryRefresh();
+      fr = f_lseek(&slot->file, WS_LOGFMT_BIN_HEADER_SIZE +
+                                    (SD_LOGGER_BIN_PREALLOC_RECORDS * WS_LOGFMT_BIN_RECORD_SIZE));
+      WWDG_TryRefresh();
+    }
+  } else {
+    fr = f_lseek(&slot->file, 0U);
+    if (fr == FR_OK) {
+      fr = f_read(&slot->file, header, WS_LOGFMT_BIN_HEADER_SIZE, &done);
+    }
+  }
+  if ((fr != FR_OK) || (done != WS_LOGFMT_BIN_HEADER_SIZE)) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:BIN_HDR_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  if (!WS_LogFmt_BinCheckHeader(header, &slot->bin_station, &slot->bin_day_epoch)) {
+    /* Keep the file for inspection; stop logging to it until it is renamed. */
+    Debug_LogAt(DEBUG_LVL_WARN, "SD:BIN_HDR_BAD");
+    return 1U;
+  }
+  for (uint8_t h = 0U; h < WS_LOGFMT_BIN_INDEX_SLOTS; h++) {
+    if (WS_LogFmt_BinIndexGet(header, h) != WS_LOGFMT_BIN_INDEX_NONE) {
+      slot->bin_hours |= (1UL << h);
     }
   }
 
+  slot->bin_count = WS_LogFmt_BinCount(header);
+  size = f_size(&slot->file);
+  if (slot->bin_count > ((size - WS_LOGFMT_BIN_HEADER_SIZE) / WS_LOGFMT_BIN_RECORD_SIZE)) {
+    slot->bin_count = (size - WS_LOGFMT_BIN_HEADER_SIZE) / WS_LOGFMT_BIN_RECORD_SIZE;
+  }
+  slot->bin_count_saved = slot->bin_count;
+
+  sd_bin_fast_seek(slot);
+  if (sd_bin_recover(slot, (size - WS_LOGFMT_BIN_HEADER_SIZE) / WS_LOGFMT_BIN_RECORD_SIZE) != 0U) {
+    return 1U;
+  }
+  fr = f_lseek(&slot->file, WS_LOGFMT_BIN_HEADER_SIZE + (slot->bin_count * WS_LOGFMT_BIN_RECORD_SIZE));
+  if (fr != FR_OK) {
+    (void)f_close(&slot->file);
+    sd_logger_mark_unavailable("SD:SEEK_FAIL fr=", (int32_t)fr);
+    return 1U;
+  }
+  slot->bin_ready = 1U;
   return 0U;
 }
 
-uint8_t SD_Logger_AppendStatus(const char *line, uint16_t len) {
-  char path[20];
+/**
+ * @brief Append one binary record to its station's day file.
+ * @details The first record of each hour also fills that hour's slot in
+ *          the header index (one 2-byte write into the header sector).
+ * @retval 0 Success, skipped, or I/O failure (volume marked unavailable).
+ */
+static uint8_t sd_append_record(uint8_t station_idx, uint8_t *record) {
+  SD_OpenFile_t *slot = &sd_files[SD_SLOT_MEASUREMENT];
+  char path[SD_LOGGER_PATH_MAX];
+  WS_LogTime_t day;
+  uint32_t epoch = (uint32_t)record[0] | ((uint32_t)record[1] << 8) |
+                   ((uint32_t)record[2] << 16) | ((uint32_t)record[3] << 24);
+  uint8_t hour = (uint8_t)((epoch % WS_LOGFMT_DAY_S) / 3600UL);
 
-  if ((sd_ready == 0U) || (sd_io_busy != 0U) || (line == NULL) || (len == 0U)) {
+  if (sd_io_busy != 0U) {
     return 0U;
   }
+  sd_io_busy = 1U;
 
-  (void)snprintf(path, sizeof(path), "%sstatus_log", USERPath);
-  return sd_append_bytes(path, line, (UINT)len);
+  WS_LogFmt_EpochToTime(epoch, &day);
+  (void)snprintf(path, sizeof(path), "%sS%u_%02u%02u%02u.wsb", USERPath, (unsigned int)station_idx,
+                 (unsigned int)day.year, (unsigned int)day.month, (unsigned int)day.date);
+
+  if ((sd_open_slot(slot, path) != 0U) ||
+      ((slot->bin_ready == 0U) && (sd_bin_prepare(slot, station_idx, epoch) != 0U))) {
+    sd_io_busy = 0U;
+    return 0U;
+  }
+
+  if ((slot->bin_hours & (1UL << hour)) == 0U) {
+    uint8_t slot_bytes[2] = {(uint8_t)slot->bin_count, (uint8_t)(slot->bin_count >> 8)};
+    if (sd_bin_patch_header(slot, WS_LOGFMT_BIN_INDEX_OFFSET(hour), slot_bytes, sizeof(slot_bytes)) != 0U) {
+      sd_io_busy = 0U;
+      return 0U;
+    }
+    slot->bin_hours |= (1UL << hour);
+  }
+
+  /* Fast-seek mode cannot grow a file: past the preallocation, go back to
+   * following the FAT (the current cluster is still valid). */
+  if ((slot->file.cltbl != NULL) &&
+      ((f_tell(&slot->file) + WS_LOGFMT_BIN_RECORD_SIZE) > f_size(&slot->file))) {
+    slot->file.cltbl = NULL;
+  }
+  WS_LogFmt_BinSeal(record, (uint16_t)slot->bin_count, slot->bin_day_epoch);
+  slot->bin_count++;
+  (void)sd_write_slot(slot, record, WS_LOGFMT_BIN_RECORD_SIZE);
+  sd_io_busy = 0U;
+  return 0U;
 }
 
 /**
@@ -273,90 +974,522 @@ static uint8_t sd_ensure_ready(void) {
   }
 
   (void)f_mount(NULL, USERPath, 0);
-  return (sd_try_mount() == 0U) ? 1U : 0U;
+  if (sd_try_mount() != 0U) {
+    return 0U;
+  }
+  sd_stats.remounts++;
+  return 1U;
 }
 
-uint8_t SD_Logger_AppendMeasurement(uint8_t station_idx,
-                                    const WS_Readings_t *readings,
-                                    const DS3231_DateTime *rtc_now) {
-  char path[20];
-  char status[40];
-  char value_text[16];
-  int len = 0;
-  uint8_t year = 0U;
-  uint8_t month = 0U;
-  uint8_t date = 0U;
-  uint8_t hours = 0U;
-  uint8_t minutes = 0U;
-  uint8_t seconds = 0U;
-
-  if (readings == NULL) {
-    return 1U;
+/**
+ * @brief Copy `len` bytes into the ring at `pos`, wrapping at the end.
+ */
+static void sd_queue_put(uint16_t pos, const void *data, uint16_t len) {
+  uint16_t first = (uint16_t)(SD_LOGGER_QUEUE_SIZE - pos);
+
+  if (first > len) {
+    first = len;
   }
+  memcpy(&sd_queue[pos], data, first);
+  memcpy(&sd_queue[0], (const uint8_t *)data + first, (size_t)(len - first));
+}
+
+/**
+ * @brief Copy `len` bytes out of the ring from `pos`, wrapping at the end.
+ */
+static void sd_queue_get(uint16_t pos, void *data, uint16_t len) {
+  uint16_t first = (uint16_t)(SD_LOGGER_QUEUE_SIZE - pos);
 
-  if (sd_ensure_ready() == 0U) {
+  if (first > len) {
+    first = len;
+  }
+  memcpy(data, &sd_queue[pos], first);
+  memcpy((uint8_t *)data + first, &sd_queue[0], (size_t)(len - first));
+}
+
+/**
+ * @brief Day key (YYYYMMDD) of a timestamp, 0 when the date is unknown.
+ */
+static uint32_t sd_day_key(uint8_t year, uint8_t month, uint8_t date) {
+  if ((month == 0U) || (date == 0U)) {
     return 0U;
   }
+  return 20000000UL + ((uint32_t)year * 10000UL) + ((uint32_t)month * 100UL) + date;
+}
 
-  if (rtc_now != NULL) {
-    year = rtc_now->year;
-    month = rtc_now->month;
-    date = rtc_now->date;
-    hours = rtc_now->hours;
-    minutes = rtc_now->minutes;
-    seconds = rtc_now->seconds;
-  }
-
-  sd_format_status(status, sizeof(status), readings->sensor_status);
-
-  len = snprintf(sd_line, sizeof(sd_line),
-                 "{\"station_id\":\"S%u\",\"timestamp\":\"20%02u-%02u-%02uT%02u:%02u:%02u\",\"status\":\"%s\"",
-                 (unsigned int)station_idx,
-                 (unsigned int)year,
-                 (unsigned int)month,
-                 (unsigned int)date,
-                 (unsigned int)hours,
-                 (unsigned int)minutes,
-                 (unsigned int)seconds,
-                 status);
-  if ((len <= 0) || ((size_t)len >= sizeof(sd_line))) {
-    return 1U;
+/**
+ * @brief Queue one preformatted record for the write-behind drain.
+ * @param target SD_QUEUE_TARGET_STATUS, or station index (with
+ *               SD_QUEUE_TARGET_BINARY for `.wsb` records).
+ * @param t      Measurement time, selects the day file (NULL for status).
+ * @retval 1 Queued.
+ * @retval 0 Ring full or lent to the benchmark; record dropped and counted.
+ */
+static uint8_t sd_queue_push(uint8_t target, const WS_LogTime_t *t, const char *data, uint16_t len) {
+  uint8_t hdr[SD_QUEUE_HDR_SIZE];
+
+  if ((sd_bench_active != 0U) ||
+      ((uint32_t)sd_queue_used + SD_QUEUE_HDR_SIZE + len > SD_LOGGER_QUEUE_SIZE)) {
+    sd_queue_dropped++;
+    return 0U;
   }
 
-  for (uint8_t i = 0U; i < (uint8_t)SD_FIELD_COUNT; i++) {
-    float value = 0.0f;
-    int part;
+  hdr[0] = target;
+  hdr[1] = (uint8_t)(len & 0xFFU);
+  hdr[2] = (uint8_t)(len >> 8);
+  hdr[3] = (t != NULL) ? t->year : 0U;
+  hdr[4] = (t != NULL) ? t->month : 0U;
+  hdr[5] = (t != NULL) ? t->date : 0U;
+  sd_queue_put(sd_queue_head, hdr, SD_QUEUE_HDR_SIZE);
+  sd_queue_put((uint16_t)((sd_queue_head + SD_QUEUE_HDR_SIZE) & SD_QUEUE_MASK), data, len);
+  sd_queue_head = (uint16_t)((sd_queue_head + SD_QUEUE_HDR_SIZE + len) & SD_QUEUE_MASK);
+  sd_queue_used = (uint16_t)(sd_queue_used + SD_QUEUE_HDR_SIZE + len);
+  return 1U;
+}
 
-    if (WS_Reading_Get(readings, SD_FIELD_CHANNELS[i], &value)) {
-      if (SD_FIELD_CHANNELS[i] == (uint8_t)WS_CH_TSL2561_LUX) {
-        sd_format_fixed(value_text, sizeof(value_text), value, 0U);
-      } else if ((SD_FIELD_CHANNELS[i] == (uint8_t)WS_CH_BMP280_PRESS) ||
-                 (SD_FIELD_CHANNELS[i] == (uint8_t)WS_CH_BME280_PRESS)) {
-        sd_format_fixed(value_text, sizeof(value_text), value, 2U);
-      } else {
-        sd_format_fixed(value_text, sizeof(value_text), value, 1U);
-      }
-      part = snprintf(sd_line + len, sizeof(sd_line) - (size_t)len, ",\"%s\":%s",
-                      SD_FIELD_NAMES[i], value_text);
+/**
+ * @brief Write one record, already copied to `sd_line`, to its file.
+ */
+static void sd_queue_write(const uint8_t *hdr, uint16_t len) {
+  if ((hdr[0] != SD_QUEUE_TARGET_STATUS) && ((hdr[0] & SD_QUEUE_TARGET_BINARY) != 0U)) {
+    (void)sd_append_record((uint8_t)(hdr[0] & ~SD_QUEUE_TARGET_BINARY), (uint8_t *)sd_line);
+  } else if ((sd_io_busy == 0U) && (len != 0U)) {
+    sd_io_busy = 1U;
+    if (hdr[0] == SD_QUEUE_TARGET_STATUS) {
+      sd_append_status(sd_line, (UINT)len);
     } else {
-      part = snprintf(sd_line + len, sizeof(sd_line) - (size_t)len, ",\"%s\":null",
-                      SD_FIELD_NAMES[i]);
+      sd_append_json(hdr[0], sd_day_key(hdr[3], hdr[4], hdr[5]), sd_line, (UINT)len);
+    }
+    sd_io_busy = 0U;
+  }
+}
+
+/**
+ * @brief Write the later queued records of the file just written.
+ * @details Measurement files share one handle, so stations interleaved in
+ *          the queue would otherwise close and reopen it for every record.
+ *          Matching records keep their order and are marked
+ *          SD_QUEUE_TARGET_DONE in place; the drain skips them later. Only
+ *          records queued before the call are visited; lines logged by a
+ *          failing write queue behind them. Stops once `budget` bytes are
+ *          written, so the batch stays inside the caller's drain limit.
+ * @retval Bytes written.
+ */
+static uint16_t sd_queue_write_batch(const uint8_t *first, uint16_t budget) {
+  uint16_t pos = sd_queue_tail;
+  uint16_t left = sd_queue_used;
+  uint16_t written = 0U;
+
+  while ((left != 0U) && (written < budget) && (sd_ready != 0U)) {
+    uint8_t hdr[SD_QUEUE_HDR_SIZE];
+    uint16_t len;
+
+    sd_queue_get(pos, hdr, SD_QUEUE_HDR_SIZE);
+    len = (uint16_t)(hdr[1] | ((uint16_t)hdr[2] << 8));
+    if ((hdr[0] == first[0]) && (memcmp(&hdr[3], &first[3], 3U) == 0)) {
+      sd_queue_get((uint16_t)((pos + SD_QUEUE_HDR_SIZE) & SD_QUEUE_MASK), sd_line, len);
+      sd_queue[pos] = SD_QUEUE_TARGET_DONE;
+      sd_queue_write(hdr, len);
+      written = (uint16_t)(written + len);
+    }
+    pos = (uint16_t)((pos + SD_QUEUE_HDR_SIZE + len) & SD_QUEUE_MASK);
+    left = (uint16_t)(left - SD_QUEUE_HDR_SIZE - len);
+  }
+  return written;
+}
+
+/**
+ * @brief Write the oldest queued record to its file, then the queued
+ *        records of the same measurement file (sd_queue_write_batch()).
+ * @details The record is copied to `sd_line` and removed before the write,
+ *          so lines logged during the write (I/O errors) queue behind it.
+ *          `sd_line` is free here: formatting and draining both run in the
+ *          main loop and never interleave.
+ * @param budget Bytes the caller may still write; the batch stops there,
+ *               the first record is always written whole.
+ * @retval Bytes written, or the header size for a record written by an
+ *         earlier batch (0 when the queue is empty).
+ */
+static uint16_t sd_queue_drain_one(uint16_t budget) {
+  uint8_t hdr[SD_QUEUE_HDR_SIZE];
+  uint16_t len;
+
+  if (sd_queue_used == 0U) {
+    return 0U;
+  }
+
+  sd_queue_get(sd_queue_tail, hdr, SD_QUEUE_HDR_SIZE);
+  len = (uint16_t)(hdr[1] | ((uint16_t)hdr[2] << 8));
+  if (hdr[0] != SD_QUEUE_TARGET_DONE) {
+    sd_queue_get((uint16_t)((sd_queue_tail + SD_QUEUE_HDR_SIZE) & SD_QUEUE_MASK), sd_line, len);
+  }
+  sd_queue_tail = (uint16_t)((sd_queue_tail + SD_QUEUE_HDR_SIZE + len) & SD_QUEUE_MASK);
+  sd_queue_used = (uint16_t)(sd_queue_used - SD_QUEUE_HDR_SIZE - len);
+
+  if (hdr[0] == SD_QUEUE_TARGET_DONE) {
+    return SD_QUEUE_HDR_SIZE;
+  }
+  sd_queue_write(hdr, len);
+  if ((hdr[0] != SD_QUEUE_TARGET_STATUS) && (len < budget)) {
+    len = (uint16_t)(len + sd_queue_write_batch(hdr, (uint16_t)(budget - len)));
+  }
+  return len;
+}
+
+/**
+ * @brief Report records lost to a full queue once the queue has room again.
+ */
+static void sd_queue_report_drops(void) {
+  if (sd_queue_dropped != sd_queue_dropped_reported) {
+    sd_queue_dropped_reported = sd_queue_dropped;
+    Debug_LogValueAt(DEBUG_LVL_WARN, "SD:QUEUE_DROPPED=", (int32_t)sd_queue_dropped);
+  }
+}
+
+void SD_Logger_Flush(void) {
+  if ((sd_ready == 0U) || (sd_io_busy != 0U)) {
+    return;
+  }
+
+  /* Bounded: lines logged while draining are at most a few per I/O error. */
+  while ((sd_ready != 0U) && (sd_queue_drain_one(SD_LOGGER_QUEUE_SIZE) != 0U)) {
+  }
+  sd_queue_report_drops();
+
+  sd_io_busy = 1U;
+  for (uint8_t i = 0U; i < (uint8_t)SD_SLOT_COUNT; i++) {
+    if (sd_sync_slot(&sd_files[i]) != 0U) {
+      break;
+    }
+  }
+  sd_io_busy = 0U;
+}
+
+void SD_Logger_Task(void) {
+  uint32_t now;
+  uint32_t drained = 0U;
+
+  if (sd_io_busy != 0U) {
+    return;
+  }
+
+  if ((sd_queue_used != 0U) && (sd_ensure_ready() != 0U)) {
+    while ((drained < SD_LOGGER_DRAIN_BYTES) && (sd_ready != 0U)) {
+      uint16_t n = sd_queue_drain_one((uint16_t)(SD_LOGGER_DRAIN_BYTES - drained));
+      if (n == 0U) {
+        break;
+      }
+      drained += n;
+    }
+    if (sd_queue_used == 0U) {
+      sd_queue_report_drops();
+    }
+  }
+
+  if (sd_ready == 0U) {
+    return;
+  }
+
+  now = HAL_GetTick();
+  sd_io_busy = 1U;
+  if ((sd_queue_used == 0U) &&
+      ((sd_retention_due != 0U) || ((now - sd_retention_tick) >= SD_LOGGER_RETENTION_PERIOD_MS))) {
+    sd_retention_due = 0U;
+    sd_retention_tick = now;
+    sd_retention_check();
+  }
+  for (uint8_t i = 0U; (i < (uint8_t)SD_SLOT_COUNT) && (sd_ready != 0U); i++) {
+    SD_OpenFile_t *slot = &sd_files[i];
+    if ((slot->dirty_bytes != 0U) && ((now - slot->dirty_tick) >= SD_LOGGER_SYNC_PERIOD_MS)) {
+      if (sd_sync_slot(slot) != 0U) {
+        break;
+      }
     }
+  }
+  sd_io_busy = 0U;
+}
+
+uint8_t SD_Logger_AppendStatus(const char *line, uint16_t len) {
+  if ((sd_ready == 0U) || (line == NULL) || (len == 0U)) {
+    return 0U;
+  }
+
+  (void)sd_queue_push(SD_QUEUE_TARGET_STATUS, NULL, line, len);
+  return 0U;
+}
+
+uint8_t SD_Logger_AppendMeasurement(uint8_t station_idx,
+                                    const WS_Readings_t *readings,
+                                    const DS3231_DateTime *rtc_now) {
+  WS_LogTime_t t = {0U, 0U, 0U, 0U, 0U, 0U};
+
+  if ((readings == NULL) || (station_idx >= WS_NODE_MASK_BITS)) {
+    return 1U;
+  }
 
-    if ((part <= 0) || (((size_t)len + (size_t)part) >= sizeof(sd_line))) {
+  if (rtc_now != NULL) {
+    t.year = rtc_now->year;
+    t.month = rtc_now->month;
+    t.date = rtc_now->date;
+    t.hours = rtc_now->hours;
+    t.minutes = rtc_now->minutes;
+    t.seconds = rtc_now->seconds;
+  }
+  if (sd_day_key(t.year, t.month, t.date) > sd_today_key) {
+    sd_today_key = sd_day_key(t.year, t.month, t.date);
+  }
+
+#if SD_LOGGER_JSON
+  {
+    uint16_t len = 0U;
+    if (!WS_LogFmt_Json(station_idx, &t, readings, sd_line, sizeof(sd_line), &len)) {
       return 1U;
     }
-    len += part;
+    (void)sd_queue_push(station_idx, &t, sd_line, len);
   }
+#endif
 
+#if SD_LOGGER_BINARY
   {
-    int part = snprintf(sd_line + len, sizeof(sd_line) - (size_t)len, "}\n");
-    if ((part <= 0) || (((size_t)len + (size_t)part) >= sizeof(sd_line))) {
+    uint8_t record[WS_LOGFMT_BIN_RECORD_SIZE];
+    if (!WS_LogFmt_BinEncode(WS_LogFmt_TimeToEpoch(&t), station_idx, readings, record)) {
       return 1U;
     }
-    len += part;
+    (void)sd_queue_push((uint8_t)(SD_QUEUE_TARGET_BINARY | station_idx), &t, (const char *)record,
+                        WS_LOGFMT_BIN_RECORD_SIZE);
+  }
+#endif
+
+  return 0U;
+}
+
+uint8_t SD_Logger_ReadLog(uint8_t station_idx, uint32_t day_key, uint8_t part, uint32_t *offset,
+                          uint8_t max_lines, SD_Logger_LineFn_t fn) {
+  FIL *file = &sd_files[SD_SLOT_MEASUREMENT].file;
+  char path[SD_LOGGER_PATH_MAX];
+  uint8_t result = SD_LOGGER_READ_OK;
+  FRESULT fr;
+
+  if ((offset == NULL) || (fn == NULL) || (part >= SD_LOGGER_MAX_PARTS)) {
+    return SD_LOGGER_READ_NOFILE;
+  }
+  /* Queued lines of the file are written first so the export sees them. */
+  SD_Logger_Flush();
+  if ((sd_ready == 0U) || (sd_io_busy != 0U) || (sd_bench_active != 0U)) {
+    return SD_LOGGER_READ_BUSY;
   }
 
-  (void)snprintf(path, sizeof(path), "%slog_S%u.json", USERPath, (unsigned int)station_idx);
-  return sd_append_bytes(path, sd_line, (UINT)len);
+  /* _FS_LOCK allows two open files: borrow the measurement handle. */
+  sd_io_busy = 1U;
+  if (sd_close_slot(&sd_files[SD_SLOT_MEASUREMENT]) != 0U) {
+    sd_io_busy = 0U;
+    return SD_LOGGER_READ_BUSY;
+  }
+  sd_json_path(path, sizeof(path), station_idx, day_key, part);
+  WWDG_TryRefresh();
+  fr = f_open(file, path, FA_READ);
+  if ((fr == FR_NO_FILE) || (fr == FR_NO_PATH)) {
+    sd_io_busy = 0U;
+    return SD_LOGGER_READ_NOFILE;
+  }
+
+  while ((fr == FR_OK) && (max_lines > 0U)) {
+    UINT got = 0U;
+    const char *eol;
+    uint16_t len;
+
+    fr = f_lseek(file, *offset);
+    if (fr == FR_OK) {
+      /* The newline is replaced by the NUL, so a full-buffer line fits. */
+      fr = f_read(file, sd_line, (UINT)sizeof(sd_line), &got);
+    }
+    WWDG_TryRefresh();
+    if (fr != FR_OK) {
+      break;
+    }
+    /* A missing newline is the end, or a torn tail not yet repaired, unless
+     * the window is full: then the line is longer than the buffer. */
+    eol = (const char *)memchr(sd_line, '\n', got);
+    if (eol == NULL) {
+      result = (got == (UINT)sizeof(sd_line)) ? SD_LOGGER_READ_LONG : SD_LOGGER_READ_EOF;
+      break;
+    }
+    len = (uint16_t)(eol - sd_line);
+    *offset += (uint32_t)len + 1U;
+    if ((len > 0U) && (sd_line[len - 1U] == '\r')) {
+      len--;
+    }
+    sd_line[len] = '\0';
+    fn(sd_line, len);
+    max_lines--;
+  }
+
+  if (fr == FR_OK) {
+    fr = f_close(file);
+  } else {
+    (void)f_close(file);
+  }
+  sd_io_busy = 0U;
+  if (fr != FR_OK) {
+    sd_logger_mark_unavailable("SD:EXPORT_FAIL fr=", (int32_t)fr);
+    return SD_LOGGER_READ_BUSY;
+  }
+  return result;
+}
+
+const SD_Logger_Stats_t *SD_Logger_GetStats(void) {
+  sd_stats.queue_dropped = sd_queue_dropped;
+  return &sd_stats;
+}
+
+/**
+ * @brief Log a wait_ready() histogram, one line per non-empty bucket.
+ */
+static void sd_log_wait_hist(const uint32_t *hist) {
+  for (uint8_t i = 0U; i < USER_SPI_WAIT_BUCKETS; i++) {
+    if (hist[i] != 0U) {
+      Debug_LogValue(sd_wait_labels[i], (int32_t)hist[i]);
+    }
+  }
+}
+
+void SD_Logger_ReportStats(void) {
+  const USER_SPI_Stats *drv = USER_SPI_get_stats();
+  const SD_Logger_Stats_t *stats = SD_Logger_GetStats();
+
+  Debug_LogValue("SD:READY=", (int32_t)sd_ready);
+  Debug_LogValue("SD:BYTES_WR=", (int32_t)stats->bytes_written);
+  Debug_LogValue("SD:WRITES=", (int32_t)stats->writes);
+  Debug_LogValue("SD:WR_AVG_US=",
+                 (stats->writes != 0U) ? (int32_t)(stats->write_us_total / stats->writes) : 0);
+  Debug_LogValue("SD:WR_MAX_US=", (int32_t)stats->write_us_max);
+  Debug_LogValue("SD:SYNCS=", (int32_t)stats->syncs);
+  Debug_LogValue("SD:SYNC_MAX_US=", (int32_t)stats->sync_us_max);
+  Debug_LogValue("SD:REMOUNTS=", (int32_t)stats->remounts);
+  Debug_LogValue("SD:DROPPED=", (int32_t)stats->queue_dropped);
+  Debug_LogValue("SD:SECT_RD=", (int32_t)drv->sectors_read);
+  Debug_LogValue("SD:SECT_WR=", (int32_t)drv->sectors_written);
+  Debug_LogValue("SD:DRV_ERRORS=", (int32_t)drv->errors);
+  Debug_LogValue("SD:CRC_ERRORS=", (int32_t)drv->crc_errors);
+  Debug_LogValue("SD:CLK_FALLBACKS=", (int32_t)drv->clock_fallbacks);
+  Debug_LogValue("SD:SPI_KHZ=", (int32_t)(USER_SPI_get_clock_hz() / 1000U));
+  Debug_LogValue("SD:WAIT_MAX_US=", (int32_t)drv->wait_max_us);
+  sd_log_wait_hist(drv->wait_hist);
+}
+
+/**
+ * @brief Time one pass over the benchmark file in `chunk`-byte f_read or
+ *        f_write calls (512 → CMD17/CMD24 per sector, larger → CMD18/CMD25).
+ * @param out_ms Receives the milliseconds taken (at least 1).
+ */
+static FRESULT sd_bench_pass(FIL *file, uint8_t write, UINT chunk, uint32_t *out_ms) {
+  uint32_t start;
+  UINT done = 0U;
+  FRESULT fr = f_lseek(file, 0U);
+
+  start = HAL_GetTick();
+  for (DWORD pos = 0U; (fr == FR_OK) && (pos < SD_LOGGER_BENCH_BYTES); pos += chunk) {
+    if (write != 0U) {
+      fr = f_write(file, sd_queue, chunk, &done);
+    } else {
+      fr = f_read(file, sd_queue, chunk, &done);
+    }
+    if ((fr == FR_OK) && (done != chunk)) {
+      fr = FR_DENIED;
+    }
+    WWDG_TryRefresh();
+  }
+  if ((fr == FR_OK) && (write != 0U)) {
+    fr = f_sync(file);
+  }
+  *out_ms = HAL_GetTick() - start;
+  if (*out_ms == 0U) {
+    *out_ms = 1U;
+  }
+  return fr;
+}
+
+void SD_Logger_Benchmark(void) {
+  static const char *const labels[4] = {"SD:BENCH_WR1_KBS=", "SD:BENCH_WRN_KBS=", "SD:BENCH_RD1_KBS=",
+                                        "SD:BENCH_RDN_KBS="};
+  SD_OpenFile_t *slot = &sd_files[SD_SLOT_MEASUREMENT];
+  char path[SD_LOGGER_PATH_MAX];
+  USER_SPI_Stats before;
+  uint32_t pass_ms[4] = {0U, 0U, 0U, 0U};
+  uint32_t mount_ms;
+  uint32_t start;
+  FRESULT fr;
+
+  SD_Logger_Flush();
+  if ((sd_ready == 0U) || (sd_io_busy != 0U) || (sd_queue_used != 0U)) {
+    Debug_Log("SD:BENCH_SKIP");
+    return;
+  }
+
+  sd_io_busy = 1U;
+  for (uint8_t i = 0U; i < (uint8_t)SD_SLOT_COUNT; i++) {
+    if (sd_close_slot(&sd_files[i]) != 0U) {
+      sd_io_busy = 0U;
+      return;
+    }
+  }
+  sd_bench_active = 1U;
+
+  /* Card initialization plus FAT mount, as after a card swap. The diskio
+   * layer still marks the drive initialized, so f_mount() alone would skip
+   * disk_initialize(): run the card init explicitly inside the timed span. */
+  (void)f_mount(NULL, USERPath, 0);
+  start = HAL_GetTick();
+  WWDG_TryRefresh();
+  if ((USER_SPI_initialize(USER_SPI_PDRV) & STA_NOINIT) != 0U) {
+    fr = FR_NOT_READY;
+  } else {
+    WWDG_TryRefresh();
+    fr = f_mount(&USERFatFS, USERPath, 1);
+  }
+  WWDG_TryRefresh();
+  mount_ms = HAL_GetTick() - start;
+
+  before = *USER_SPI_get_stats();
+  (void)snprintf(path, sizeof(path), "%sbench.tmp", USERPath);
+  if (fr == FR_OK) {
+    fr = f_open(&slot->file, path, FA_CREATE_ALWAYS | FA_READ | FA_WRITE);
+  }
+  if (fr == FR_OK) {
+    /* Allocate first so the write passes do not include FAT updates. */
+    fr = f_lseek(&slot->file, SD_LOGGER_BENCH_BYTES);
+    if (fr == FR_OK) {
+      fr = f_sync(&slot->file);
+    }
+    (void)memset(sd_queue, 0x5A, sizeof(sd_queue));
+    for (uint8_t i = 0U; (fr == FR_OK) && (i < 4U); i++) {
+      fr = sd_bench_pass(&slot->file, (uint8_t)(i < 2U),
+                         ((i & 1U) != 0U) ? (UINT)SD_LOGGER_QUEUE_SIZE : 512U, &pass_ms[i]);
+    }
+    (void)f_close(&slot->file);
+    (void)f_unlink(path);
+  }
+
+  sd_queue_head = 0U;
+  sd_queue_tail = 0U;
+  sd_bench_active = 0U;
+  sd_io_busy = 0U;
+  if (fr != FR_OK) {
+    sd_logger_mark_unavailable("SD:BENCH_FAIL fr=", (int32_t)fr);
+    return;
+  }
+
+  Debug_LogValue("SD:BENCH_MOUNT_MS=", (int32_t)mount_ms);
+  for (uint8_t i = 0U; i < 4U; i++) {
+    Debug_LogValue(labels[i], (int32_t)(((SD_LOGGER_BENCH_BYTES / 1024UL) * 1000UL) / pass_ms[i]));
+  }
+  {
+    const USER_SPI_Stats *after = USER_SPI_get_stats();
+    uint32_t hist[USER_SPI_WAIT_BUCKETS];
+
+    for (uint8_t i = 0U; i < USER_SPI_WAIT_BUCKETS; i++) {
+      hist[i] = after->wait_hist[i] - before.wait_hist[i];
+    }
+    sd_log_wait_hist(hist);
+  }
 }
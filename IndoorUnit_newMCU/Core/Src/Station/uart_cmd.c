@@ -1,57 +1,202 @@
 /**
  * @file uart_cmd.c
- * @brief Line-based UART commands: CMD:MEASURE, CMD:MEASURE:N, CMD:PING
+ * @brief Line-based UART commands: CMD:MEASURE, CMD:MEASURE:N, CMD:PING,
+ *        CMD:PROF, CMD:PROF:RESET, CMD:SD, CMD:SD:BENCH, CMD:LOG,
+ *        CMD:LOG:<MOD>=<0-4>, CMD:CFG:*, CMD:STATS, CMD:EXPORT
  *
- * Fully interrupt-driven: bytes are received via USART1 RX interrupt and a
- * completed line is parsed and executed directly in the ISR. Queuing a
- * measurement only sets the measurement_pending flag consumed by the radio
- * state machine (WS_ProcessEventHandler), so no UART polling is needed.
+ * USART1 RX runs as circular DMA into uart_cmd_rx_dma. The DMA half/full
+ * and IDLE-line events (HAL_UARTEx_RxEventCallback) split the new bytes into
+ * lines and push completed ones to a small line queue, posting
+ * WS_EVT_UART_LINE; there is no per-byte interrupt. The main loop then calls
+ * UartCmd_Process(), which parses each line, replies through the shared TX
+ * ring (uart_tx) and runs the command (SD report, profile dump, ...) right
+ * after its ACK. A line that arrives while the queue is full is dropped.
+ * CMD:SD:BENCH blocks the loop for seconds and answers ERR:BUSY while the
+ * radio link is active.
+ *
+ * CMD:LOG replies ACK:LOG= followed by one level digit per module in
+ * Debug_Module_t order (SYS, RADIO, SD, UI, RTC, PWR). CMD:LOG:<MOD>=<n>
+ * sets one module (or ALL) to 0=off, 1=error, 2=warn, 3=info, 4=debug and
+ * takes effect with the next log call.
+ *
+ * Settings (RAM only; a reset restores weather_station_config.h), each
+ * answered with the value in effect, ACK:<NAME>=<value>:
+ *   CMD:CFG:INTERVAL[=<n>]           minutes between scheduled cycles, a
+ *                                    divisor of 60
+ *   CMD:CFG:NODES[=<hex mask>]       nodes polled by scheduled cycles
+ *   CMD:CFG:RADIO[=<ch>,<pa>,<rate>] channel 0-125, PA 0-3 (-18/-12/-6/0 dBm),
+ *                                    rate 0=250k, 1=1M, 2=2M; ERR:BUSY while
+ *                                    the link is active
+ *
+ * Multi-line replies are ACK:<NAME>, then RSP:<data> lines, then
+ * END:<NAME>=<summary> (or ERR:<reason> after the ACK):
+ *   CMD:STATS  RSP:N<i>=polls,replies,timeouts,miss_streak,success_q8,backoff
+ *              per node, END:STATS=<nodes>
+ *   CMD:EXPORT:<station>:<YYYYMMDD>[:<part>:<offset>]
+ *              up to UART_CMD_EXPORT_LINES JSON log lines as RSP:<line>, then
+ *              END:EXPORT=<lines>,<part>,<offset>[,EOF]; pass part and offset
+ *              back for the next page. EOF marks the end of the last part
+ *              (resume there for lines appended later). ERR:NOFILE when the
+ *              file does not exist, ERR:SD on a card error, ERR:LINE on a
+ *              line longer than the SD line buffer.
+ * Those replies wait for room in the TX ring instead of being dropped.
  */
 
 #include "uart_cmd.h"
 
+#include "debug_log.h"
+#include "sd_logger.h"
+#include "uart_tx.h"
+#include "ws_event.h"
+#include "ws_profile.h"
+#include "wwdg.h"
+
+#include <stdio.h>
 #include <string.h>
 
-#define UART_CMD_LINE_MAX  40U
-#define UART_CMD_REPLY_MAX 32U
+#define UART_CMD_LINE_MAX    64U
+#define UART_CMD_REPLY_MAX   32U
+/* Longest RSP: line built here (not exported log lines). */
+#define UART_CMD_RSP_MAX     48U
+/* Log lines per CMD:EXPORT page (~5 KB, under half a second at 115200). */
+#define UART_CMD_EXPORT_LINES 16U
+/* Circular DMA buffer; the half and full events drain it, so a burst
+ * without an IDLE gap still has half the buffer of slack. */
+#define UART_CMD_RX_DMA_SIZE 64U
+/* Completed lines waiting for the main loop (power of two). */
+#define UART_CMD_QUEUE_DEPTH 4U
+
+#if ((UART_CMD_QUEUE_DEPTH & (UART_CMD_QUEUE_DEPTH - 1U)) != 0U)
+#error "UART_CMD_QUEUE_DEPTH must be a power of two"
+#endif
 
 static UART_HandleTypeDef *uart_cmd_huart;
 static WS_Manager_t *uart_cmd_ws;
+static WS_RuntimeConfig_t *uart_cmd_cfg;
+static uint8_t uart_cmd_export_sent;
+
+/* CMD:CFG:RADIO codes, index = code sent on the wire. */
+static const uint8_t uart_cmd_pa_levels[] = {(uint8_t)NRF24_PA_MIN, (uint8_t)NRF24_PA_LOW,
+                                             (uint8_t)NRF24_PA_HIGH, (uint8_t)NRF24_PA_MAX};
+static const uint8_t uart_cmd_data_rates[] = {(uint8_t)NRF24_DR_250KBPS, (uint8_t)NRF24_DR_1MBPS,
+                                              (uint8_t)NRF24_DR_2MBPS};
+
+/* ISR side: DMA buffer, read position and the line being assembled. */
+static uint8_t uart_cmd_rx_dma[UART_CMD_RX_DMA_SIZE];
+static uint16_t uart_cmd_rx_pos;
 static char uart_cmd_line[UART_CMD_LINE_MAX];
 static uint8_t uart_cmd_line_len;
-static uint8_t uart_cmd_rx_byte;
+static uint8_t uart_cmd_line_overflow;
 
-/* Pending reply written in ISR, sent from main loop by UartCmd_FlushReply(). */
-static volatile char    uart_cmd_pending_reply[UART_CMD_REPLY_MAX];
-static volatile uint8_t uart_cmd_reply_pending;
+/* Line queue: head advanced by the ISR, tail by UartCmd_Process(). */
+static char uart_cmd_queue[UART_CMD_QUEUE_DEPTH][UART_CMD_LINE_MAX];
+static volatile uint8_t uart_cmd_queue_head;
+static volatile uint8_t uart_cmd_queue_tail;
+static volatile uint32_t uart_cmd_lines_dropped;
+static uint32_t uart_cmd_lines_dropped_reported;
 
-/* Called from ISR: store response in buffer, do NOT call HAL_UART_Transmit. */
+/* Main loop only: send one reply line through the TX ring. */
 static void uart_cmd_reply(const char *msg) {
-  if (msg == NULL) {
+  char reply[UART_CMD_REPLY_MAX];
+  uint8_t i = 0U;
+
+  if ((msg == NULL) || (uart_cmd_huart == NULL)) {
     return;
   }
-  uint8_t i = 0U;
   while ((msg[i] != '\0') && (msg[i] != '\r') && (msg[i] != '\n') &&
-         (i < (UART_CMD_REPLY_MAX - 3U))) {
-    uart_cmd_pending_reply[i] = msg[i];
+         (i < (UART_CMD_REPLY_MAX - 2U))) {
+    reply[i] = msg[i];
     i++;
   }
-  uart_cmd_pending_reply[i++] = '\r';
-  uart_cmd_pending_reply[i++] = '\n';
-  uart_cmd_pending_reply[i] = '\0';
-  uart_cmd_reply_pending = 1U;
+  reply[i++] = '\r';
+  reply[i++] = '\n';
+  (void)UartTx_Write(uart_cmd_huart, reply, i);
+}
+
+/* Main loop only: send prefix, text and CRLF as one piece, waiting up to
+ * UART_TX_FLUSH_TIMEOUT_MS for ring space so a long reply is not dropped. */
+static void uart_cmd_send(const char *prefix, const char *text, uint16_t len) {
+  uint16_t prefix_len = (uint16_t)strlen(prefix);
+  uint16_t need = (uint16_t)(prefix_len + len + 2U);
+  uint32_t start = HAL_GetTick();
+  uint32_t primask;
+
+  if (uart_cmd_huart == NULL) {
+    return;
+  }
+  while ((UartTx_GetFree() < need) && ((HAL_GetTick() - start) < UART_TX_FLUSH_TIMEOUT_MS)) {
+    WWDG_TryRefresh();
+  }
+
+  /* Masked so no interrupt-context log line lands inside the reply. */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (UartTx_GetFree() >= need) {
+    (void)UartTx_Write(uart_cmd_huart, prefix, prefix_len);
+    if (len > 0U) {
+      (void)UartTx_Write(uart_cmd_huart, text, len);
+    }
+    (void)UartTx_Write(uart_cmd_huart, "\r\n", 2U);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Parse an unsigned number in @p base (10 or 16, optional 0x).
+ * @return Pointer to the first character after the digits, or NULL when
+ *         there are no digits or the value exceeds @p max.
+ */
+static const char *uart_cmd_parse_uint(const char *p, uint8_t base, uint32_t max, uint32_t *value) {
+  const char *start;
+  uint32_t v = 0U;
+
+  if ((base == 16U) && (p[0] == '0') && ((p[1] == 'x') || (p[1] == 'X'))) {
+    p += 2;
+  }
+  start = p;
+  for (;;) {
+    uint32_t digit;
+
+    if ((*p >= '0') && (*p <= '9')) {
+      digit = (uint32_t)(*p - '0');
+    } else if ((base == 16U) && (*p >= 'a') && (*p <= 'f')) {
+      digit = (uint32_t)(*p - 'a') + 10U;
+    } else if ((base == 16U) && (*p >= 'A') && (*p <= 'F')) {
+      digit = (uint32_t)(*p - 'A') + 10U;
+    } else {
+      break;
+    }
+    if (v > ((max - digit) / base)) {
+      return NULL;
+    }
+    v = (v * base) + digit;
+    p++;
+  }
+  if (p == start) {
+    return NULL;
+  }
+  *value = v;
+  return p;
+}
+
+/* Radio link idle: no cycle running or queued, no node waiting. */
+static uint8_t uart_cmd_radio_idle(const WS_Manager_t *ws) {
+  return (uint8_t)((ws != NULL) && (ws->comm_watchdog_tripped == 0U) &&
+                   ((ws->app_state == WS_APP_IDLE) || (ws->app_state == WS_APP_DATA_READY)) &&
+                   (ws->parallel_cycle == 0U));
 }
 
 static void uart_cmd_reset_line(void) {
   uart_cmd_line_len = 0U;
-  uart_cmd_line[0] = '\0';
+  uart_cmd_line_overflow = 0U;
 }
 
 /**
  * @brief Queue a measurement for the active node, a given node, or all nodes.
  * @param target Node index, UART_CMD_TARGET_ACTIVE, or UART_CMD_TARGET_ALL
  *
- * Safe to call from ISR context: only sets pending flags / cycle_pending.
+ * Only sets pending flags / cycle_pending; the radio state machine runs the
+ * measurement on its next pass.
  */
 static void uart_cmd_request_measure(uint8_t target) {
   WS_Manager_t *ws = uart_cmd_ws;
@@ -61,9 +206,7 @@ static void uart_cmd_request_measure(uint8_t target) {
     return;
   }
 
-  if ((ws->comm_watchdog_tripped != 0U) ||
-      ((ws->app_state != WS_APP_IDLE) && (ws->app_state != WS_APP_DATA_READY)) ||
-      (ws->parallel_cycle != 0U)) {
+  if (uart_cmd_radio_idle(ws) == 0U) {
     uart_cmd_reply("ERR:BUSY");
     return;
   }
@@ -97,34 +240,328 @@ static void uart_cmd_request_measure(uint8_t target) {
   uart_cmd_reply("ACK:MEASURE:QUEUED");
 }
 
-static void uart_cmd_handle_line(const char *line) {
-  if (strcmp(line, "CMD:PING") == 0) {
-    uart_cmd_reply("ACK:PING");
+/**
+ * @brief Handle CMD:LOG and CMD:LOG:<MOD>=<level>.
+ * @param arg Text after "CMD:LOG" (empty or ":<MOD>=<level>")
+ */
+static void uart_cmd_log(const char *arg) {
+  char reply[UART_CMD_REPLY_MAX];
+  uint8_t len;
+  uint8_t module;
+  uint8_t level;
+  const char *eq;
+  size_t name_len;
+
+  if (*arg == '\0') {
+    (void)memcpy(reply, "ACK:LOG=", 8U);
+    len = 8U;
+    for (module = 0U; module < (uint8_t)DEBUG_MOD_COUNT; module++) {
+      reply[len++] = (char)('0' + Debug_GetLevel(module));
+    }
+    reply[len] = '\0';
+    uart_cmd_reply(reply);
     return;
   }
 
-  if (strcmp(line, "CMD:MEASURE") == 0) {
-    uart_cmd_request_measure(UART_CMD_TARGET_ALL);
+  eq = (*arg == ':') ? strchr(arg, '=') : NULL;
+  if ((eq == NULL) || (eq[1] < '0') || (eq[1] > ('0' + (char)DEBUG_LVL_DEBUG)) || (eq[2] != '\0')) {
+    uart_cmd_reply("ERR:UNKNOWN");
     return;
   }
+  arg++;
+  name_len = (size_t)(eq - arg);
+  level = (uint8_t)(eq[1] - '0');
 
-  if (strncmp(line, "CMD:MEASURE:", 12) == 0) {
-    const char *p = line + 12;
-    unsigned int node = 0U;
+  if ((name_len == 3U) && (strncmp(arg, "ALL", 3U) == 0)) {
+    for (module = 0U; module < (uint8_t)DEBUG_MOD_COUNT; module++) {
+      (void)Debug_SetLevel(module, level);
+    }
+  } else {
+    for (module = 0U; module < (uint8_t)DEBUG_MOD_COUNT; module++) {
+      const char *name = Debug_ModuleName(module);
+      if ((name != NULL) && (strlen(name) == name_len) && (strncmp(arg, name, name_len) == 0)) {
+        break;
+      }
+    }
+    if (Debug_SetLevel(module, level) != 0U) {
+      uart_cmd_reply("ERR:UNKNOWN");
+      return;
+    }
+  }
+
+  /* Only a known name (at most 5 chars) gets here, so the reply fits. */
+  (void)memcpy(reply, "ACK:LOG:", 8U);
+  (void)memcpy(&reply[8], arg, name_len);
+  len = (uint8_t)(8U + name_len);
+  reply[len++] = '=';
+  reply[len++] = (char)('0' + level);
+  reply[len] = '\0';
+  uart_cmd_reply(reply);
+}
+
+/**
+ * @brief Handle CMD:CFG:INTERVAL, CMD:CFG:NODES and CMD:CFG:RADIO.
+ * @param arg Text after "CMD:CFG:"
+ */
+static void uart_cmd_cfg_cmd(const char *arg) {
+  WS_Manager_t *ws = uart_cmd_ws;
+  WS_RuntimeConfig_t *cfg = uart_cmd_cfg;
+  char reply[UART_CMD_REPLY_MAX];
+  const char *p;
+  uint32_t value;
+
+  if ((ws == NULL) || (cfg == NULL)) {
+    uart_cmd_reply("ERR:BUSY");
+    return;
+  }
 
-    if (*p == '\0') {
+  if (strncmp(arg, "INTERVAL", 8) == 0) {
+    p = arg + 8;
+    if (*p == '=') {
+      p = uart_cmd_parse_uint(p + 1, 10U, WS_MEASURE_INTERVAL_MAX_MIN, &value);
+      if ((p == NULL) || (*p != '\0') || (WS_SetMeasureInterval(ws, (uint8_t)value) != 0U)) {
+        uart_cmd_reply("ERR:UNKNOWN");
+        return;
+      }
+    } else if (*p != '\0') {
       uart_cmd_reply("ERR:UNKNOWN");
       return;
     }
-    while (*p != '\0') {
-      if ((*p < '0') || (*p > '9') || (node > WS_MAX_NODES)) {
+    (void)snprintf(reply, sizeof(reply), "ACK:INTERVAL=%u", (unsigned int)ws->measure_interval_min);
+    uart_cmd_reply(reply);
+    return;
+  }
+
+  if (strncmp(arg, "NODES", 5) == 0) {
+    p = arg + 5;
+    if (*p == '=') {
+      p = uart_cmd_parse_uint(p + 1, 16U, 0xFFFFFFFFUL, &value);
+      if ((p == NULL) || (*p != '\0') || (WS_SetEnabledNodes(ws, (WS_NodeMask_t)value) != 0U)) {
         uart_cmd_reply("ERR:UNKNOWN");
         return;
       }
-      node = (node * 10U) + (unsigned int)(*p - '0');
-      p++;
+    } else if (*p != '\0') {
+      uart_cmd_reply("ERR:UNKNOWN");
+      return;
+    }
+    (void)snprintf(reply, sizeof(reply), "ACK:NODES=0x%lX", (unsigned long)ws->enabled_mask);
+    uart_cmd_reply(reply);
+    return;
+  }
+
+  if (strncmp(arg, "RADIO", 5) == 0) {
+    uint8_t pa_code = 0U;
+    uint8_t rate_code = 0U;
+
+    p = arg + 5;
+    if (*p == '=') {
+      uint32_t channel;
+      uint32_t pa;
+      uint32_t rate;
+      HAL_StatusTypeDef status;
+
+      p = uart_cmd_parse_uint(p + 1, 10U, NRF24_MAX_CHANNEL, &channel);
+      p = ((p != NULL) && (*p == ',')) ? uart_cmd_parse_uint(p + 1, 10U, 3U, &pa) : NULL;
+      p = ((p != NULL) && (*p == ',')) ? uart_cmd_parse_uint(p + 1, 10U, 2U, &rate) : NULL;
+      if ((p == NULL) || (*p != '\0')) {
+        uart_cmd_reply("ERR:UNKNOWN");
+        return;
+      }
+      status = WS_SetRadioConfig(ws, cfg, (uint8_t)channel, uart_cmd_data_rates[rate], uart_cmd_pa_levels[pa]);
+      if (status != HAL_OK) {
+        uart_cmd_reply((status == HAL_BUSY) ? "ERR:BUSY" : "ERR:RADIO");
+        return;
+      }
+    } else if (*p != '\0') {
+      uart_cmd_reply("ERR:UNKNOWN");
+      return;
+    }
+    for (uint8_t i = 0U; i < (uint8_t)sizeof(uart_cmd_pa_levels); i++) {
+      if (uart_cmd_pa_levels[i] == cfg->pa_level) {
+        pa_code = i;
+      }
+    }
+    for (uint8_t i = 0U; i < (uint8_t)sizeof(uart_cmd_data_rates); i++) {
+      if (uart_cmd_data_rates[i] == cfg->data_rate) {
+        rate_code = i;
+      }
+    }
+    (void)snprintf(reply, sizeof(reply), "ACK:RADIO=%u,%u,%u", (unsigned int)cfg->channel,
+                   (unsigned int)pa_code, (unsigned int)rate_code);
+    uart_cmd_reply(reply);
+    return;
+  }
+
+  uart_cmd_reply("ERR:UNKNOWN");
+}
+
+/* CMD:STATS: one RSP line of link counters per node. */
+static void uart_cmd_stats(void) {
+  const WS_Manager_t *ws = uart_cmd_ws;
+  char line[UART_CMD_RSP_MAX];
+  int len;
+
+  if (ws == NULL) {
+    uart_cmd_reply("ERR:BUSY");
+    return;
+  }
+
+  uart_cmd_reply("ACK:STATS");
+  for (uint8_t i = 0U; i < ws->node_count; i++) {
+    const WS_LinkStats_t *link = &ws->nodes[i].link;
+
+    len = snprintf(line, sizeof(line), "N%u=%u,%u,%u,%u,%u,%u", (unsigned int)i, (unsigned int)link->polls,
+                   (unsigned int)link->replies, (unsigned int)link->rx_timeouts,
+                   (unsigned int)link->miss_streak, (unsigned int)link->success_q8,
+                   (unsigned int)link->backoff_shift);
+    if ((len > 0) && ((size_t)len < sizeof(line))) {
+      uart_cmd_send("RSP:", line, (uint16_t)len);
+    }
+  }
+  len = snprintf(line, sizeof(line), "STATS=%u", (unsigned int)ws->node_count);
+  uart_cmd_send("END:", line, (uint16_t)len);
+}
+
+/* SD_Logger_ReadLog() callback of CMD:EXPORT. */
+static void uart_cmd_export_line(const char *line, uint16_t len) {
+  uart_cmd_send("RSP:", line, len);
+  uart_cmd_export_sent++;
+}
+
+/**
+ * @brief Handle CMD:EXPORT:<station>:<YYYYMMDD>[:<part>:<offset>].
+ * @param arg Text after "CMD:EXPORT:"
+ *
+ * Runs to completion in the main loop, moving on to the next file part when
+ * one ends, until UART_CMD_EXPORT_LINES lines are sent or the log ends.
+ */
+static void uart_cmd_export(const char *arg) {
+  char line[UART_CMD_RSP_MAX];
+  uint32_t station;
+  uint32_t day_key;
+  uint32_t part = 0U;
+  uint32_t offset = 0U;
+  uint8_t at_eof = 0U;
+  const char *p;
+  int len;
+
+  p = uart_cmd_parse_uint(arg, 10U, WS_MAX_NODES - 1U, &station);
+  p = ((p != NULL) && (*p == ':')) ? uart_cmd_parse_uint(p + 1, 10U, 99991231UL, &day_key) : NULL;
+  if ((p != NULL) && (*p == ':')) {
+    p = uart_cmd_parse_uint(p + 1, 10U, 255U, &part);
+    p = ((p != NULL) && (*p == ':')) ? uart_cmd_parse_uint(p + 1, 10U, 0xFFFFFFFFUL, &offset) : NULL;
+  }
+  if ((p == NULL) || (*p != '\0')) {
+    uart_cmd_reply("ERR:UNKNOWN");
+    return;
+  }
+  if ((uart_cmd_radio_idle(uart_cmd_ws) == 0U) || (SD_Logger_IsReady() == 0U)) {
+    uart_cmd_reply("ERR:BUSY");
+    return;
+  }
+
+  uart_cmd_reply("ACK:EXPORT");
+  uart_cmd_export_sent = 0U;
+  while (uart_cmd_export_sent < UART_CMD_EXPORT_LINES) {
+    uint32_t read_part = (at_eof != 0U) ? (part + 1U) : part;
+    uint32_t read_offset = (at_eof != 0U) ? 0U : offset;
+    uint8_t result;
+
+    result = SD_Logger_ReadLog((uint8_t)station, day_key, (uint8_t)read_part, &read_offset,
+                               (uint8_t)(UART_CMD_EXPORT_LINES - uart_cmd_export_sent), uart_cmd_export_line);
+    if (result == SD_LOGGER_READ_BUSY) {
+      uart_cmd_reply("ERR:SD");
+      return;
+    }
+    if (result == SD_LOGGER_READ_LONG) {
+      uart_cmd_reply("ERR:LINE");
+      return;
+    }
+    if (result == SD_LOGGER_READ_NOFILE) {
+      if (at_eof == 0U) {
+        uart_cmd_reply("ERR:NOFILE");
+        return;
+      }
+      break;
+    }
+    part = read_part;
+    offset = read_offset;
+    at_eof = (uint8_t)(result == SD_LOGGER_READ_EOF);
+  }
+
+  len = snprintf(line, sizeof(line), "EXPORT=%u,%lu,%lu%s", (unsigned int)uart_cmd_export_sent,
+                 (unsigned long)part, (unsigned long)offset,
+                 ((at_eof != 0U) && (uart_cmd_export_sent < UART_CMD_EXPORT_LINES)) ? ",EOF" : "");
+  uart_cmd_send("END:", line, (uint16_t)len);
+}
+
+static void uart_cmd_handle_line(const char *line) {
+  if (strcmp(line, "CMD:PING") == 0) {
+    uart_cmd_reply("ACK:PING");
+    return;
+  }
+
+#if WS_PROFILE_ENABLE
+  if (strcmp(line, "CMD:PROF") == 0) {
+    uart_cmd_reply("ACK:PROF");
+    WS_Profile_Dump(uart_cmd_huart);
+    return;
+  }
+
+  if (strcmp(line, "CMD:PROF:RESET") == 0) {
+    uart_cmd_reply("ACK:PROF:RESET");
+    WS_Profile_Reset();
+    return;
+  }
+#endif
+
+  if (strcmp(line, "CMD:SD") == 0) {
+    uart_cmd_reply("ACK:SD");
+    SD_Logger_ReportStats();
+    return;
+  }
+
+  if (strcmp(line, "CMD:SD:BENCH") == 0) {
+    /* Blocks the loop for seconds: a running cycle would miss its replies. */
+    if (uart_cmd_radio_idle(uart_cmd_ws) == 0U) {
+      uart_cmd_reply("ERR:BUSY");
+      return;
     }
-    if (node >= WS_MAX_NODES) {
+    uart_cmd_reply("ACK:SD:BENCH");
+    SD_Logger_Benchmark();
+    return;
+  }
+
+  if (strncmp(line, "CMD:LOG", 7) == 0) {
+    uart_cmd_log(line + 7);
+    return;
+  }
+
+  if (strncmp(line, "CMD:CFG:", 8) == 0) {
+    uart_cmd_cfg_cmd(line + 8);
+    return;
+  }
+
+  if (strcmp(line, "CMD:STATS") == 0) {
+    uart_cmd_stats();
+    return;
+  }
+
+  if (strncmp(line, "CMD:EXPORT:", 11) == 0) {
+    uart_cmd_export(line + 11);
+    return;
+  }
+
+  if (strcmp(line, "CMD:MEASURE") == 0) {
+    uart_cmd_request_measure(UART_CMD_TARGET_ALL);
+    return;
+  }
+
+  if (strncmp(line, "CMD:MEASURE:", 12) == 0) {
+    uint32_t node;
+    const char *p = uart_cmd_parse_uint(line + 12, 10U, WS_MAX_NODES - 1U, &node);
+
+    if ((p == NULL) || (*p != '\0')) {
       uart_cmd_reply("ERR:UNKNOWN");
       return;
     }
@@ -135,72 +572,117 @@ static void uart_cmd_handle_line(const char *line) {
   uart_cmd_reply("ERR:UNKNOWN");
 }
 
+/* ISR: push the assembled line, or count it if the main loop is behind. */
+static void uart_cmd_push_line(void) {
+  uint8_t head = uart_cmd_queue_head;
+  uint8_t next = (uint8_t)((head + 1U) & (UART_CMD_QUEUE_DEPTH - 1U));
+
+  if (next == uart_cmd_queue_tail) {
+    uart_cmd_lines_dropped++;
+    return;
+  }
+  (void)memcpy(uart_cmd_queue[head], uart_cmd_line, uart_cmd_line_len);
+  uart_cmd_queue[head][uart_cmd_line_len] = '\0';
+  uart_cmd_queue_head = next;
+  (void)WS_Event_Post(WS_EVT_UART_LINE);
+}
+
+/* ISR: a line longer than UART_CMD_LINE_MAX - 1 is discarded whole. */
 static void uart_cmd_on_byte(uint8_t byte) {
   if ((byte == '\r') || (byte == '\n')) {
-    if (uart_cmd_line_len > 0U) {
-      uart_cmd_line[uart_cmd_line_len] = '\0';
-      uart_cmd_handle_line(uart_cmd_line);
+    if ((uart_cmd_line_len > 0U) && (uart_cmd_line_overflow == 0U)) {
+      uart_cmd_push_line();
     }
     uart_cmd_reset_line();
     return;
   }
 
   if (uart_cmd_line_len >= (UART_CMD_LINE_MAX - 1U)) {
-    uart_cmd_reset_line();
+    uart_cmd_line_overflow = 1U;
     return;
   }
 
   uart_cmd_line[uart_cmd_line_len++] = (char)byte;
 }
 
-void UartCmd_Init(UART_HandleTypeDef *huart, WS_Manager_t *ws) {
+/* (Re)start circular reception from the top of the DMA buffer. */
+static void uart_cmd_start_rx(UART_HandleTypeDef *huart) {
+  uart_cmd_rx_pos = 0U;
+  uart_cmd_reset_line();
+  (void)HAL_UARTEx_ReceiveToIdle_DMA(huart, uart_cmd_rx_dma, UART_CMD_RX_DMA_SIZE);
+}
+
+void UartCmd_Init(UART_HandleTypeDef *huart, WS_Manager_t *ws, WS_RuntimeConfig_t *cfg) {
   uart_cmd_huart = huart;
   uart_cmd_ws = ws;
-  uart_cmd_reset_line();
+  uart_cmd_cfg = cfg;
+  uart_cmd_queue_head = 0U;
+  uart_cmd_queue_tail = 0U;
+  uart_cmd_lines_dropped = 0U;
+  uart_cmd_lines_dropped_reported = 0U;
 
   if (huart != NULL) {
-    (void)HAL_UART_Receive_IT(huart, &uart_cmd_rx_byte, 1U);
+    uart_cmd_start_rx(huart);
   }
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-  if ((huart == NULL) || (huart != uart_cmd_huart)) {
+/**
+ * @brief DMA half/full or IDLE-line event: consume bytes up to @p pos.
+ *
+ * @p pos is the DMA write position (1..UART_CMD_RX_DMA_SIZE); the buffer
+ * has wrapped when it is below the last read position.
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t pos) {
+  if ((huart == NULL) || (huart != uart_cmd_huart) || (pos > UART_CMD_RX_DMA_SIZE)) {
     return;
   }
 
-  uart_cmd_on_byte(uart_cmd_rx_byte);
-  (void)HAL_UART_Receive_IT(huart, &uart_cmd_rx_byte, 1U);
+  while (uart_cmd_rx_pos != pos) {
+    uart_cmd_on_byte(uart_cmd_rx_dma[uart_cmd_rx_pos]);
+    uart_cmd_rx_pos++;
+    if ((uart_cmd_rx_pos == UART_CMD_RX_DMA_SIZE) && (pos != UART_CMD_RX_DMA_SIZE)) {
+      uart_cmd_rx_pos = 0U;
+    }
+  }
+  if (uart_cmd_rx_pos == UART_CMD_RX_DMA_SIZE) {
+    uart_cmd_rx_pos = 0U;
+  }
 }
 
 /**
- * @brief Send pending UART reply from main-loop context.
+ * @brief Parse and execute the queued command lines from main-loop context.
  *
- * Call once per main-loop iteration. Transmits the ACK/ERR response that was
- * buffered inside the RX ISR, avoiding a blocking HAL_UART_Transmit call from
- * interrupt context on the shared huart1 line.
+ * Call on WS_EVT_UART_LINE. Each line gets its ACK/ERR reply through the
+ * shared huart1 TX ring (uart_tx), after any log lines already queued; a
+ * profile dump, SD report, SD benchmark or RSP/END block follows its ACK line. Lines
+ * dropped on a full queue since the last call are logged as UART:RX_DROPPED=.
  */
-void UartCmd_FlushReply(void) {
-  if (uart_cmd_reply_pending == 0U) {
-    return;
+void UartCmd_Process(void) {
+  uint32_t dropped = uart_cmd_lines_dropped;
+
+  if (dropped != uart_cmd_lines_dropped_reported) {
+    uart_cmd_lines_dropped_reported = dropped;
+    Debug_LogValueAt(DEBUG_LVL_WARN, "UART:RX_DROPPED=", (int32_t)dropped);
   }
-  uart_cmd_reply_pending = 0U;
-  if (uart_cmd_huart != NULL) {
-    (void)HAL_UART_Transmit(uart_cmd_huart,
-                            (uint8_t *)uart_cmd_pending_reply,
-                            (uint16_t)strlen((const char *)uart_cmd_pending_reply),
-                            100U);
+
+  while (uart_cmd_queue_tail != uart_cmd_queue_head) {
+    uint8_t tail = uart_cmd_queue_tail;
+
+    uart_cmd_handle_line(uart_cmd_queue[tail]);
+    uart_cmd_queue_tail = (uint8_t)((tail + 1U) & (UART_CMD_QUEUE_DEPTH - 1U));
   }
 }
 
-/* On any RX error (overrun/framing/noise) the HAL aborts interrupt reception
- * and does not re-arm it, which permanently stops receiving commands from the
- * Pico W. Clear the error flags, drop the partial line and re-arm RX. */
+/* On any RX error (overrun/framing/noise) the HAL aborts the DMA reception
+ * and does not restart it, which permanently stops receiving commands from
+ * the Pico W. Clear the error flags, drop the partial line and restart. */
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
   if ((huart == NULL) || (huart != uart_cmd_huart)) {
     return;
   }
 
   __HAL_UART_CLEAR_OREFLAG(huart);
-  uart_cmd_reset_line();
-  (void)HAL_UART_Receive_IT(huart, &uart_cmd_rx_byte, 1U);
+  if (huart->RxState == HAL_UART_STATE_READY) {
+    uart_cmd_start_rx(huart);
+  }
 }
@@ -0,0 +1,173 @@
+/**
+ * @file    uart_tx.c
+ * @brief   Ring-buffered USART1 transmit drained by DMA or the TXE interrupt
+ * @details `head`, `used` and the start of a transfer change with interrupts
+ *          masked; `tail` and `used` shrink in HAL_UART_TxCpltCallback(). All
+ *          IRQs share NVIC priority 0 and never nest, so the callback needs
+ *          no masking of its own. The transfer in flight reads straight from
+ *          the ring, so each chunk stops at the wrap point.
+ */
+
+#include "uart_tx.h"
+
+#include "wwdg.h"
+
+#include <string.h>
+
+/** @brief Index mask for the power-of-two ring */
+#define UART_TX_BUFFER_MASK (UART_TX_BUFFER_SIZE - 1U)
+
+#if ((UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) != 0U)
+#error "UART_TX_BUFFER_SIZE must be a power of two"
+#endif
+
+static UART_HandleTypeDef *uart_tx_huart;
+static uint8_t uart_tx_ring[UART_TX_BUFFER_SIZE];
+static volatile uint16_t uart_tx_head;     /**< Next byte to write */
+static volatile uint16_t uart_tx_tail;     /**< First byte not yet sent */
+static volatile uint16_t uart_tx_used;     /**< Bytes queued, including the transfer in flight */
+static volatile uint16_t uart_tx_active;   /**< Length of the transfer in flight (0 = idle) */
+static volatile uint32_t uart_tx_dropped;  /**< Messages rejected by a full ring */
+
+/**
+ * @brief Releases the bytes of the finished transfer
+ */
+static void uart_tx_release(void) {
+  uart_tx_tail = (uint16_t)((uart_tx_tail + uart_tx_active) & UART_TX_BUFFER_MASK);
+  uart_tx_used = (uint16_t)(uart_tx_used - uart_tx_active);
+  uart_tx_active = 0U;
+}
+
+/**
+ * @brief Starts the next chunk if the UART is idle (interrupts masked or in the callback)
+ */
+static void uart_tx_kick(void) {
+  uint16_t chunk;
+  HAL_StatusTypeDef status;
+
+  if (uart_tx_active != 0U) {
+    if (uart_tx_huart->gState != HAL_UART_STATE_READY) {
+      return;
+    }
+    /* A transfer error ended the transfer without TxCplt: count it as sent. */
+    uart_tx_release();
+  }
+  if (uart_tx_used == 0U) {
+    return;
+  }
+
+  chunk = (uint16_t)(UART_TX_BUFFER_SIZE - uart_tx_tail);
+  if (chunk > uart_tx_used) {
+    chunk = uart_tx_used;
+  }
+#if UART_TX_USE_DMA
+  status = HAL_UART_Transmit_DMA(uart_tx_huart, &uart_tx_ring[uart_tx_tail], chunk);
+#else
+  status = HAL_UART_Transmit_IT(uart_tx_huart, &uart_tx_ring[uart_tx_tail], chunk);
+#endif
+  if (status == HAL_OK) {
+    uart_tx_active = chunk;
+  }
+}
+
+/**
+ * @brief Runs the handlers that advance a transfer while interrupts are masked
+ */
+static void uart_tx_poll(void) {
+#if UART_TX_USE_DMA
+  if (uart_tx_huart->hdmatx != NULL) {
+    HAL_DMA_IRQHandler(uart_tx_huart->hdmatx);
+  }
+#endif
+  HAL_UART_IRQHandler(uart_tx_huart);
+}
+
+void UartTx_Init(UART_HandleTypeDef *huart) {
+  uart_tx_huart = huart;
+  uart_tx_head = 0U;
+  uart_tx_tail = 0U;
+  uart_tx_used = 0U;
+  uart_tx_active = 0U;
+  uart_tx_dropped = 0U;
+}
+
+uint8_t UartTx_Write(UART_HandleTypeDef *huart, const void *data, uint16_t len) {
+  const uint8_t *src = (const uint8_t *)data;
+  uint16_t first;
+  uint32_t primask;
+
+  if ((huart == NULL) || (data == NULL) || (len == 0U)) {
+    return 1U;
+  }
+  if (huart != uart_tx_huart) {
+    return (HAL_UART_Transmit(huart, (uint8_t *)src, len, UART_TX_BLOCKING_TIMEOUT_MS) == HAL_OK) ? 0U : 1U;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (len > (uint16_t)(UART_TX_BUFFER_SIZE - uart_tx_used)) {
+    uart_tx_dropped++;
+    __set_PRIMASK(primask);
+    return 1U;
+  }
+
+  first = (uint16_t)(UART_TX_BUFFER_SIZE - uart_tx_head);
+  if (first > len) {
+    first = len;
+  }
+  (void)memcpy(&uart_tx_ring[uart_tx_head], src, first);
+  (void)memcpy(uart_tx_ring, &src[first], (size_t)len - first);
+  uart_tx_head = (uint16_t)((uart_tx_head + len) & UART_TX_BUFFER_MASK);
+  uart_tx_used = (uint16_t)(uart_tx_used + len);
+  uart_tx_kick();
+  __set_PRIMASK(primask);
+  return 0U;
+}
+
+void UartTx_Flush(uint32_t timeout_ms) {
+  uint32_t start = HAL_GetTick();
+  /* One pass takes well over 10 cycles; only used while SysTick cannot run. */
+  uint32_t spins = timeout_ms * (SystemCoreClock / 10000U);
+  uint32_t primask = __get_PRIMASK();
+
+  if (uart_tx_huart == NULL) {
+    return;
+  }
+
+  while (uart_tx_used != 0U) {
+    __disable_irq();
+    uart_tx_kick();
+    if (primask != 0U) {
+      uart_tx_poll();
+    }
+    __set_PRIMASK(primask);
+    /* A full ring takes longer than the ~58 ms WWDG timeout. */
+    WWDG_TryRefresh();
+
+    if (primask != 0U) {
+      if (spins == 0U) {
+        return;
+      }
+      spins--;
+    } else if ((HAL_GetTick() - start) >= timeout_ms) {
+      return;
+    }
+  }
+}
+
+uint16_t UartTx_GetFree(void) {
+  return (uint16_t)(UART_TX_BUFFER_SIZE - uart_tx_used);
+}
+
+uint32_t UartTx_GetDropped(void) {
+  return uart_tx_dropped;
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+  if ((huart == NULL) || (huart != uart_tx_huart)) {
+    return;
+  }
+
+  uart_tx_release();
+  uart_tx_kick();
+}
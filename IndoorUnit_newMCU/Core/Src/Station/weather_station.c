@@ -7,12 +7,16 @@
  * @date 2026
  */
 
+#define DEBUG_LOG_MODULE DEBUG_MOD_RADIO
+
 #include "weather_station.h"
 #include "weather_station_ui.h"
 #include "debug_log.h"
 #include "ws_protocol.h"
 #include "power_mgr.h"
 #include "sd_logger.h"
+#include "uart_tx.h"
+#include "ws_profile.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -37,12 +41,30 @@
 /** @brief Status register pipe mask */
 #define WS_STATUS_PIPE_MASK 0x07U
 
-/** @brief Maximum retries before forcing full radio recovery */
+/** @brief Poll attempts per measurement for a reliable node (and before radio recovery) */
 #define WS_MAX_RETRIES 3U
 
+/** @brief Poll attempts per measurement for a node below WS_LINK_GOOD_Q8 */
+#define WS_WEAK_NODE_RETRIES 1U
+
+/** @brief Reply ratio (success_q8) from which a node counts as reliable */
+#define WS_LINK_GOOD_Q8 192U
+
+/** @brief Consecutive misses after which each further miss raises the poll backoff */
+#define WS_LINK_BACKOFF_MISSES 3U
+
+/** @brief Highest poll backoff level; a node sits out at most 2^level - 1 cycles */
+#define WS_LINK_BACKOFF_MAX_SHIFT 3U
+
 /** @brief Delay used between nRF24 power-down and power-up during recovery */
 #define WS_NRF_POWER_CYCLE_DELAY_MS 5U
 
+/** @brief Seconds per day for RTC clock arithmetic */
+#define WS_SECONDS_PER_DAY 86400UL
+
+/** @brief Days before the first of each month in a non-leap year */
+static const uint16_t WS_DAYS_BEFORE_MONTH[12] = {0U, 31U, 59U, 90U, 120U, 151U, 181U, 212U, 243U, 273U, 304U, 334U};
+
 /* ============================================================================
  * PRIVATE HELPER FUNCTIONS - LED Control
  * ========================================================================== */
@@ -69,9 +91,9 @@ static void ws_set_led(const WS_RuntimeConfig_t *cfg, GPIO_PinState state) {
  * @param[in,out] ctx Weather station manager context
  * @param[in] cfg Runtime configuration containing nRF24 handle
  * @details TX_ADDR and RX_ADDR_P0 must match when this radio operates as PTX
- *          with auto-ACK. Outdoor replies use separate static RX pipes 1-4
- *          and their `rx_addr`; assigning one of those addresses to Pipe 0
- *          would duplicate a reply pipe and make pipe-to-node mapping ambiguous.
+ *          with auto-ACK. Outdoor replies use separate static RX pipes 1-5
+ *          and `pipe_rx_addr`; assigning one of those addresses to Pipe 0
+ *          would duplicate a reply pipe.
  */
 static void ws_apply_active_node_address(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
   const WS_NodeState_t *node = WS_GetActiveNodeConst(ctx);
@@ -79,8 +101,8 @@ static void ws_apply_active_node_address(WS_Manager_t *ctx, const WS_RuntimeConf
     return;
   }
 
-  NRF24_SetTXAddress(cfg->nrf, node->tx_addr, 5U);
-  NRF24_SetRXAddress(cfg->nrf, 0U, node->tx_addr, 5U);
+  NRF24_SetTXAddress(cfg->nrf, ctx->pipe_tx_addr[node->rx_pipe - 1U], 5U);
+  NRF24_SetRXAddress(cfg->nrf, 0U, ctx->pipe_tx_addr[node->rx_pipe - 1U], 5U);
 }
 
 /**
@@ -117,6 +139,65 @@ static void ws_capture_last_successful_time(WS_Manager_t *ctx, const WS_RuntimeC
   ctx->last_successful_rx_time_valid = 1U;
 }
 
+/**
+ * @brief Converts an RTC date/time to seconds since 2000-01-01 00:00:00
+ * @param[in] t RTC date/time (24h format, year 00-99 = 2000-2099)
+ * @return Seconds since 2000; 0 for an invalid month
+ */
+static uint32_t ws_rtc_to_seconds(const DS3231_DateTime *t) {
+  if ((t == NULL) || (t->month < 1U) || (t->month > 12U) || (t->date < 1U)) {
+    return 0U;
+  }
+
+  /* Every 4th year from 2000 is leap within 2000-2099. */
+  uint32_t days = ((uint32_t)t->year * 365UL) + (((uint32_t)t->year + 3UL) / 4UL);
+  days += WS_DAYS_BEFORE_MONTH[t->month - 1U] + (uint32_t)(t->date - 1U);
+  if ((t->month > 2U) && ((t->year % 4U) == 0U)) {
+    days++;
+  }
+  return (days * WS_SECONDS_PER_DAY) + ((uint32_t)t->hours * 3600UL) +
+         ((uint32_t)t->minutes * 60UL) + t->seconds;
+}
+
+/**
+ * @brief Computes the RTC date/time @p age_s seconds before @p now
+ * @param[in] now Current RTC date/time
+ * @param[in] age_s Seconds to go back (clamped to 2000-01-01)
+ * @param[out] out Receives the earlier date/time; other fields copied from @p now
+ */
+static void ws_rtc_rewind(const DS3231_DateTime *now, uint32_t age_s, DS3231_DateTime *out) {
+  uint32_t now_s = ws_rtc_to_seconds(now);
+  if (age_s > now_s) {
+    age_s = now_s;
+  }
+  uint32_t then_s = now_s - age_s;
+  uint32_t days = then_s / WS_SECONDS_PER_DAY;
+  uint32_t rem = then_s % WS_SECONDS_PER_DAY;
+  uint32_t back_days = (now_s / WS_SECONDS_PER_DAY) - days;
+
+  *out = *now;
+  out->hours = (uint8_t)(rem / 3600UL);
+  out->minutes = (uint8_t)((rem / 60UL) % 60UL);
+  out->seconds = (uint8_t)(rem % 60UL);
+
+  uint8_t year = 0U;
+  while (days >= (((year % 4U) == 0U) ? 366UL : 365UL)) {
+    days -= ((year % 4U) == 0U) ? 366UL : 365UL;
+    year++;
+  }
+  uint8_t leap = ((year % 4U) == 0U) ? 1U : 0U;
+  uint8_t month = 12U;
+  while ((month > 1U) && (days < (WS_DAYS_BEFORE_MONTH[month - 1U] + ((month > 2U) ? leap : 0U)))) {
+    month--;
+  }
+  out->year = year;
+  out->month = month;
+  out->date = (uint8_t)(days - (WS_DAYS_BEFORE_MONTH[month - 1U] + ((month > 2U) ? leap : 0U)) + 1U);
+  if ((now->day >= 1U) && (now->day <= 7U)) {
+    out->day = (uint8_t)((((uint32_t)now->day - 1U + 7U - (back_days % 7U)) % 7U) + 1U);
+  }
+}
+
 /**
  * @brief Formats a floating-point value as a fixed-point string
  * @param[out] dst Destination buffer for formatted string
@@ -203,17 +284,19 @@ static void ws_format_sensor_status(char *dst, size_t dst_size, uint8_t sensor_s
 /**
  * @brief Sends one measurement record to Pico W over UART as CSV line
  * @param[in] ctx Weather station manager context
- * @param[in] cfg Runtime configuration containing UART handle and RTC
+ * @param[in] cfg Runtime configuration containing UART handle
  * @param[in] node_idx Node index mapped to station id S0..S3
+ * @param[in] data Readings to send
+ * @param[in] when Measurement time (NULL = all-zero timestamp)
  */
-static void ws_send_measurement_uart(const WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint8_t node_idx) {
-  if ((ctx == NULL) || (cfg == NULL) || (cfg->huart_pico == NULL) || (node_idx >= ctx->node_count)) {
+static void ws_send_measurement_uart(const WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint8_t node_idx,
+                                     const WS_NodeReadings_t *data, const DS3231_DateTime *when) {
+  if ((ctx == NULL) || (cfg == NULL) || (cfg->huart_pico == NULL) || (node_idx >= ctx->node_count) ||
+      (data == NULL)) {
     return;
   }
-
-  const WS_NodeState_t *node = &ctx->nodes[node_idx];
   char status_text[40];
-  char line[160];
+  char line[192];
   char channel_part[24];
   uint8_t year = 0U;
   uint8_t month = 0U;
@@ -223,15 +306,15 @@ static void ws_send_measurement_uart(const WS_Manager_t *ctx, const WS_RuntimeCo
   uint8_t seconds = 0U;
   int line_len = 0;
 
-  ws_format_sensor_status(status_text, sizeof(status_text), node->data.sensor_status);
+  ws_format_sensor_status(status_text, sizeof(status_text), data->sensor_status);
 
-  if (cfg->rtc_now != NULL) {
-    year = cfg->rtc_now->year;
-    month = cfg->rtc_now->month;
-    date = cfg->rtc_now->date;
-    hours = cfg->rtc_now->hours;
-    minutes = cfg->rtc_now->minutes;
-    seconds = cfg->rtc_now->seconds;
+  if (when != NULL) {
+    year = when->year;
+    month = when->month;
+    date = when->date;
+    hours = when->hours;
+    minutes = when->minutes;
+    seconds = when->seconds;
   }
 
   line_len = snprintf(
@@ -246,11 +329,11 @@ static void ws_send_measurement_uart(const WS_Manager_t *ctx, const WS_RuntimeCo
       (unsigned int)seconds,
       (unsigned int)node_idx);
 
-  for (uint8_t i = 0U; (i < node->data.count) && (line_len > 0); i++) {
+  for (uint8_t i = 0U; (i < data->count) && (line_len > 0); i++) {
     char value_text[16];
-    ws_format_fixed(value_text, sizeof(value_text), node->data.readings[i].value, 2U);
+    ws_format_fixed(value_text, sizeof(value_text), data->readings[i].value, 2U);
     snprintf(channel_part, sizeof(channel_part), ",%02X:%s",
-             (unsigned int)node->data.readings[i].channel_id, value_text);
+             (unsigned int)data->readings[i].channel_id, value_text);
     if (((size_t)line_len + strlen(channel_part) + strlen(status_text) + 2U) >= sizeof(line)) {
       break;
     }
@@ -265,7 +348,7 @@ static void ws_send_measurement_uart(const WS_Manager_t *ctx, const WS_RuntimeCo
     return;
   }
 
-  (void)HAL_UART_Transmit(cfg->huart_pico, (uint8_t *)line, (uint16_t)line_len, 100U);
+  (void)UartTx_Write(cfg->huart_pico, line, (uint16_t)line_len);
 }
 
 /**
@@ -286,17 +369,170 @@ static void ws_start_receive(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
   NRF24_SetMode(cfg->nrf, NRF24_MODE_RX);
 }
 
+/* ============================================================================
+ * PRIVATE HELPER FUNCTIONS - Link Quality
+ * ========================================================================== */
+
+/**
+ * @brief Records the outcome of one poll in the node's link statistics
+ * @param[in,out] node Polled node
+ * @param[in] replied 1 when a measurement arrived, 0 when the reply window closed
+ * @details success_q8 is a 1/8 exponential moving average. Misses beyond
+ *          WS_LINK_BACKOFF_MISSES raise the backoff level; any reply clears it.
+ */
+static void ws_link_record(WS_NodeState_t *node, uint8_t replied) {
+  WS_LinkStats_t *link = &node->link;
+  uint16_t ratio = (uint16_t)(link->success_q8 - (link->success_q8 >> 3));
+
+  if (replied != 0U) {
+    ratio += 32U;
+    link->replies++;
+    link->miss_streak = 0U;
+    link->backoff_shift = 0U;
+    link->skip_cycles = 0U;
+  } else {
+    link->rx_timeouts++;
+    if (link->miss_streak < UINT8_MAX) {
+      link->miss_streak++;
+    }
+    if ((link->miss_streak >= WS_LINK_BACKOFF_MISSES) && (link->backoff_shift < WS_LINK_BACKOFF_MAX_SHIFT)) {
+      link->backoff_shift++;
+    }
+  }
+  link->success_q8 = (ratio > 0xFFU) ? 0xFFU : (uint8_t)ratio;
+}
+
+/**
+ * @brief Returns how many polls a measurement from this node may take
+ */
+static uint8_t ws_link_retry_limit(const WS_NodeState_t *node) {
+  return (node->link.success_q8 >= WS_LINK_GOOD_Q8) ? WS_MAX_RETRIES : WS_WEAK_NODE_RETRIES;
+}
+
+/**
+ * @brief Ends the retries of a node for this measurement and arms its poll backoff
+ */
+static void ws_link_give_up(WS_NodeState_t *node, uint8_t node_idx) {
+  node->retry_count = 0U;
+  node->link.skip_cycles = (uint8_t)((1U << node->link.backoff_shift) - 1U);
+  if (node->link.skip_cycles != 0U) {
+    Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:LINK_BACKOFF node=", (int32_t)node_idx);
+  }
+}
+
+/**
+ * @brief Builds the target mask of a fresh parallel cycle
+ * @details Only enabled nodes are polled. Nodes in backoff sit the cycle out so
+ *          they cannot stretch the reply window; when every enabled node is in
+ *          backoff all of them are polled.
+ */
+static WS_NodeMask_t ws_link_poll_mask(WS_Manager_t *ctx) {
+  WS_NodeMask_t all = WS_Cycle_ExpectedMask(ctx->node_count) & ctx->enabled_mask;
+  WS_NodeMask_t mask = all;
+
+  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+    if ((all & WS_NODE_BIT(i)) == 0U) {
+      continue;
+    }
+    if (ctx->nodes[i].link.skip_cycles != 0U) {
+      ctx->nodes[i].link.skip_cycles--;
+      mask &= ~WS_NODE_BIT(i);
+    }
+  }
+  return (mask != 0U) ? mask : all;
+}
+
+/**
+ * @brief Selects the targeted nodes whose reply slots go after the reliable ones
+ */
+static WS_NodeMask_t ws_link_late_mask(const WS_Manager_t *ctx, WS_NodeMask_t target_mask) {
+  WS_NodeMask_t late = 0U;
+
+  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+    WS_NodeMask_t bit = WS_NODE_BIT(i);
+    if (((target_mask & bit) != 0U) && (ctx->nodes[i].link.success_q8 < WS_LINK_GOOD_Q8)) {
+      late |= bit;
+    }
+  }
+  return late;
+}
+
+/**
+ * @brief Returns true when no enabled node answered its most recent poll
+ * @details Only then is the local radio suspect; one weak node must not
+ *          trigger a power cycle that also interrupts the healthy ones.
+ */
+static bool ws_link_all_silent(const WS_Manager_t *ctx) {
+  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+    if (((ctx->enabled_mask & WS_NODE_BIT(i)) != 0U) && (ctx->nodes[i].link.replies != 0U) &&
+        (ctx->nodes[i].link.miss_streak == 0U)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Communication watchdog timeout for the current measurement interval
+ * @details At least two scheduled cycles must go unanswered before it trips.
+ */
+static uint32_t ws_comm_watchdog_ms(const WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
+  uint32_t min_ms = (uint32_t)ctx->measure_interval_min * 2U * 60000U;
+
+  return (cfg->comm_watchdog_timeout_ms > min_ms) ? cfg->comm_watchdog_timeout_ms : min_ms;
+}
+
 /* ============================================================================
  * PRIVATE HELPER FUNCTIONS - Measurement Control
  * ========================================================================== */
 
+/**
+ * @brief Writes the reply slot schedule into a command and sets the cycle reply window
+ * @details One slot per bit of @p target_mask, weak links last; the window ends with the last slot
+ *          plus slot_guard_ms, capped at rx_timeout_ms. Without slots the nodes
+ *          use their own NODE_ID stagger and the full rx_timeout_ms applies.
+ */
+static bool ws_schedule_slots(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint8_t *cmd, WS_NodeMask_t target_mask) {
+  uint32_t window_ms;
+
+  ctx->cycle_window_ms = cfg->rx_timeout_ms;
+  if (cfg->slot_len_ms == 0U) {
+    return true;
+  }
+  if (!WS_Cmd_SetSlots(cmd, cfg->cmd_size, cfg->slot_lead_ms, cfg->slot_len_ms) ||
+      !WS_Cmd_SetLateMask(cmd, cfg->cmd_size, ws_link_late_mask(ctx, target_mask))) {
+    return false;
+  }
+
+  window_ms = WS_Cycle_WindowMs(target_mask, cfg->slot_lead_ms, cfg->slot_len_ms) + cfg->slot_guard_ms;
+  if (window_ms < ctx->cycle_window_ms) {
+    ctx->cycle_window_ms = window_ms;
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the id of the next command
+ * @param[in] partial 1 for a retry or single-node poll, 0 for a full cycle
+ * @details Partial polls count apart from full cycles, so the nodes they skip
+ *          see consecutive ids and keep sending deltas.
+ */
+static uint8_t ws_next_cycle_id(WS_Manager_t *ctx, uint8_t partial) {
+  if (partial != 0U) {
+    ctx->poll_id = (uint8_t)(WS_CMD_CYCLE_PARTIAL | ((ctx->poll_id + 1U) & WS_CMD_CYCLE_SEQ_MASK));
+    return ctx->poll_id;
+  }
+  ctx->cycle_id = (uint8_t)((ctx->cycle_id + 1U) & WS_CMD_CYCLE_SEQ_MASK);
+  return ctx->cycle_id;
+}
+
 /**
  * @brief Sends a measurement command (broadcast NoAck, optionally single-node masked)
  */
 static void ws_send_measure_command(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint32_t now_tick) {
   WS_NodeState_t *node = WS_GetActiveNode(ctx);
   uint8_t cmd[WS_CMD_SIZE] = {0};
-  uint8_t target_mask;
+  WS_NodeMask_t target_mask;
 
   if ((node == NULL) || (cfg == NULL) || (cfg->nrf == NULL) || (cfg->broadcast_addr == NULL)) {
     return;
@@ -306,15 +542,15 @@ static void ws_send_measure_command(WS_Manager_t *ctx, const WS_RuntimeConfig_t
     return;
   }
 
-  /* Increment cycle ID, wrapping at 1440 (24 hours) */
-  if(ctx->cycle_id == 1440? ctx->cycle_id = 0 : ctx->cycle_id++);
-
-  target_mask = (uint8_t)(1U << ctx->active_node);
-  if (!WS_Cmd_EncodeMeasureTo(ctx->cycle_id, target_mask, cmd, cfg->cmd_size)) {
+  target_mask = WS_NODE_BIT(ctx->active_node);
+  if (!WS_Cmd_EncodeMeasureEx(ws_next_cycle_id(ctx, 1U), target_mask, ctx->keyframe_mask, cmd, cfg->cmd_size) ||
+      !WS_Cmd_SetClock(cmd, cfg->cmd_size, ws_rtc_to_seconds(cfg->rtc_now)) ||
+      !ws_schedule_slots(ctx, cfg, cmd, target_mask)) {
     return;
   }
 
   /* Single-node requests still use the shared command address (NoAck). */
+  node->link.polls++;
   ctx->expected_mask = target_mask;
   ctx->received_mask = 0U;
   ctx->parallel_cycle = 0U;
@@ -340,16 +576,17 @@ static void ws_send_measure_command(WS_Manager_t *ctx, const WS_RuntimeConfig_t
  */
 static void ws_start_parallel_cycle(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint32_t now_tick) {
   uint8_t cmd[WS_CMD_SIZE] = {0};
+  WS_NodeMask_t retry_mask;
+  uint8_t cycle_id;
 
   if ((ctx == NULL) || (cfg == NULL) || (cfg->nrf == NULL) || (cfg->broadcast_addr == NULL)) {
     return;
   }
 
   ctx->cycle_pending = 0U;
-  /* Increment cycle ID, wrapping at 1440 (24 hours) */
-  if(ctx->cycle_id == 1440? ctx->cycle_id = 0 : ctx->cycle_id++);
-
-  ctx->expected_mask = WS_Cycle_ExpectedMask(ctx->node_count);
+  retry_mask = ctx->cycle_retry_mask;
+  ctx->cycle_retry_mask = 0U;
+  ctx->expected_mask = (retry_mask != 0U) ? retry_mask : ws_link_poll_mask(ctx);
   ctx->received_mask = 0U;
   ctx->parallel_cycle = 1U;
   ctx->cycle_tx_done = 0U;
@@ -357,17 +594,26 @@ static void ws_start_parallel_cycle(WS_Manager_t *ctx, const WS_RuntimeConfig_t
   ctx->cycle_rx_start_tick = 0U;
   ctx->cycle_nodes_remaining = 0U;
 
-  if (!WS_Cmd_EncodeMeasureTo(ctx->cycle_id, ctx->expected_mask, cmd, cfg->cmd_size)) {
+  cycle_id = ws_next_cycle_id(ctx, (retry_mask != 0U) ? 1U : 0U);
+  if (!WS_Cmd_EncodeMeasureEx(cycle_id, ctx->expected_mask, ctx->keyframe_mask, cmd, cfg->cmd_size) ||
+      !WS_Cmd_SetClock(cmd, cfg->cmd_size, ws_rtc_to_seconds(cfg->rtc_now)) ||
+      !ws_schedule_slots(ctx, cfg, cmd, ctx->expected_mask)) {
     ctx->parallel_cycle = 0U;
     return;
   }
 
   for (uint8_t i = 0U; i < ctx->node_count; i++) {
+    if (retry_mask == 0U) {
+      ctx->nodes[i].retry_count = 0U;
+    }
+    if ((ctx->expected_mask & WS_NODE_BIT(i)) == 0U) {
+      continue;
+    }
     ctx->nodes[i].measurement_pending = 0U;
-    ctx->nodes[i].retry_count = 0U;
     ctx->nodes[i].tx_start_tick = now_tick;
     ctx->nodes[i].response_start_tick = 0U;
     ctx->nodes[i].state = WS_NODE_TX_IN_PROGRESS;
+    ctx->nodes[i].link.polls++;
   }
 
   ws_set_led(cfg, GPIO_PIN_SET);
@@ -382,20 +628,23 @@ static void ws_start_parallel_cycle(WS_Manager_t *ctx, const WS_RuntimeConfig_t
   NRF24_SetMode(cfg->nrf, NRF24_MODE_TX);
 
   ctx->app_state = WS_APP_WAIT_TX_IRQ;
-  Debug_LogValue("NRF:CYCLE_START id=", ctx->cycle_id);
-  Debug_LogHex("NRF:CYCLE_EXPECT=", ctx->expected_mask);
+  Debug_LogValueAt(DEBUG_LVL_DEBUG, "NRF:CYCLE_START id=", cycle_id);
+  Debug_LogHexAt(DEBUG_LVL_DEBUG, "NRF:CYCLE_EXPECT=", ctx->expected_mask);
+  Debug_LogValueAt(DEBUG_LVL_DEBUG, "NRF:CYCLE_WINDOW_MS=", (int32_t)ctx->cycle_window_ms);
 }
 
 /**
  * @brief Finalize a parallel cycle: mark missing nodes as ERROR and go DATA_READY
  */
 static void ws_finalize_parallel_cycle(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, uint8_t timed_out) {
+  WS_NodeMask_t retry_mask = 0U;
+
   if ((ctx == NULL) || (ctx->parallel_cycle == 0U)) {
     return;
   }
 
   for (uint8_t i = 0U; i < ctx->node_count; i++) {
-    uint8_t bit = (uint8_t)(1U << i);
+    WS_NodeMask_t bit = WS_NODE_BIT(i);
     if ((ctx->expected_mask & bit) == 0U) {
       continue;
     }
@@ -403,14 +652,31 @@ static void ws_finalize_parallel_cycle(WS_Manager_t *ctx, const WS_RuntimeConfig
       continue;
     }
     ctx->nodes[i].state = WS_NODE_ERROR;
-    Debug_LogValue("NRF:CYCLE_MISS node=", i);
+    /* The node may have moved its key without us seeing it; resync next cycle. */
+    ctx->keyframe_mask |= bit;
+    ws_link_record(&ctx->nodes[i], 0U);
+    Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:CYCLE_MISS node=", i);
+
+    ctx->nodes[i].retry_count++;
+    if (ctx->nodes[i].retry_count < ws_link_retry_limit(&ctx->nodes[i])) {
+      retry_mask |= bit;
+    } else {
+      ws_link_give_up(&ctx->nodes[i], i);
+    }
+  }
+
+  if (retry_mask != 0U) {
+    /* Reliable nodes that missed get a short cycle of their own right away. */
+    ctx->cycle_retry_mask = retry_mask;
+    ctx->cycle_pending = 1U;
+    Debug_LogHexAt(DEBUG_LVL_INFO, "NRF:CYCLE_RETRY=", retry_mask);
   }
 
   if (timed_out != 0U) {
-    Debug_Log("NRF:CYCLE_TIMEOUT");
-    Debug_LogHex("NRF:CYCLE_RECV=", ctx->received_mask);
+    Debug_LogAt(DEBUG_LVL_WARN, "NRF:CYCLE_TIMEOUT");
+    Debug_LogHexAt(DEBUG_LVL_WARN, "NRF:CYCLE_RECV=", ctx->received_mask);
   } else {
-    Debug_Log("NRF:CYCLE_COMPLETE");
+    Debug_LogAt(DEBUG_LVL_DEBUG, "NRF:CYCLE_COMPLETE");
   }
 
   ws_set_led(cfg, GPIO_PIN_RESET);
@@ -435,8 +701,10 @@ static void ws_process_ready_nodes(WS_Manager_t *ctx, const WS_RuntimeConfig_t *
       continue;
     }
 
-    ws_send_measurement_uart(ctx, cfg, i);
+    ws_send_measurement_uart(ctx, cfg, i, &node->data, cfg->rtc_now);
+    WS_PROFILE_BEGIN(WS_PROF_SD_APPEND);
     (void)SD_Logger_AppendMeasurement(i, &node->data, cfg->rtc_now);
+    WS_PROFILE_END(WS_PROF_SD_APPEND);
     if (WS_UI.rtc_now != NULL) {
       WS_UI_AddMeasurementToCharts(&node->data, WS_UI.rtc_now->hours, WS_UI.rtc_now->minutes);
     }
@@ -457,6 +725,38 @@ static void ws_process_ready_nodes(WS_Manager_t *ctx, const WS_RuntimeConfig_t *
   }
 }
 
+/**
+ * @brief Outputs one queued backlog measurement (UART + SD) at its original time
+ * @details Charts are skipped: they only show live samples in time order.
+ */
+static void ws_process_backlog(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
+  if ((ctx == NULL) || (cfg == NULL) || (ctx->backlog_count == 0U)) {
+    return;
+  }
+
+  const WS_BacklogRx_t *entry = &ctx->backlog[ctx->backlog_head];
+  WS_NodeReadings_t readings;
+  uint16_t age_s = 0U;
+  if (WS_Protocol_DecodeBacklog(entry->frame, entry->len, &age_s, &readings)) {
+    DS3231_DateTime when;
+    const DS3231_DateTime *stamp = NULL;
+    if (entry->rx_time_valid != 0U) {
+      ws_rtc_rewind(&entry->rx_time, age_s, &when);
+      stamp = &when;
+    }
+    ws_send_measurement_uart(ctx, cfg, entry->node_idx, &readings, stamp);
+    WS_PROFILE_BEGIN(WS_PROF_SD_APPEND);
+    (void)SD_Logger_AppendMeasurement(entry->node_idx, &readings, stamp);
+    WS_PROFILE_END(WS_PROF_SD_APPEND);
+    Debug_LogValueAt(DEBUG_LVL_INFO, "NRF:BACKLOG_AGE_S=", (int32_t)age_s);
+  } else {
+    Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_DECODE node=", (int32_t)entry->node_idx);
+  }
+
+  ctx->backlog_head = (uint8_t)((ctx->backlog_head + 1U) % WS_BACKLOG_RX_DEPTH);
+  ctx->backlog_count--;
+}
+
 /* ============================================================================
  * PRIVATE HELPER FUNCTIONS - Interrupt Handling
  * ========================================================================== */
@@ -466,7 +766,9 @@ static void ws_process_ready_nodes(WS_Manager_t *ctx, const WS_RuntimeConfig_t *
  * @param[in,out] ctx Weather station manager context
  * @param[in] cfg Runtime configuration
  * @details Processes three interrupt sources:
- *          - RX_DR: Data received (reads all pending payloads from pipes)
+ *          - RX_DR: Data received (reads all pending payloads, demultiplexes
+ *            them by the node id envelope byte, reassembles fragmented replies
+ *            and expands delta replies per node)
  *          - TX_DS: Transmission successful (or NoAck packet left the air)
  *          - MAX_RT: Maximum retransmissions reached (TX failed)
  */
@@ -475,6 +777,7 @@ static void ws_handle_irq(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
     return;
   }
 
+  WS_PROFILE_BEGIN(WS_PROF_NRF_IRQ);
   uint8_t status = NRF24_GetStatus(cfg->nrf);
   WS_NodeState_t *active = WS_GetActiveNode(ctx);
 
@@ -484,31 +787,81 @@ static void ws_handle_irq(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
     uint8_t pipe = (status >> WS_STATUS_PIPE_SHIFT) & WS_STATUS_PIPE_MASK;
     uint8_t rx_data[NRF24_MAX_PAYLOAD_SIZE] = {0};
     uint8_t payload_len = (pipe == 0U) ? cfg->cmd_size : cfg->payload_size;
-
+    const uint8_t *frame = NULL;
+    uint8_t frame_len = 0U;
+    uint8_t node_idx = 0xFFU;
+
+#if NRF_DYNAMIC_PAYLOAD
+    if (pipe != 0U) {
+      /* 0 = corrupt width; the driver already flushed the RX FIFO. */
+      payload_len = NRF24_ReadDynamicPayloadWidth(cfg->nrf);
+      if (payload_len == 0U) {
+        Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_WIDTH pipe=", (int32_t)pipe);
+        continue;
+      }
+    }
+#endif
     NRF24_ReadPayload(cfg->nrf, rx_data, payload_len);
 
-    /* Map pipe to node index: pipe 1 → node 0, pipe 2 → node 1, etc. */
-    uint8_t node_idx = pipe - 1U;
-    if ((pipe == 0U) || (node_idx >= ctx->node_count) ||
-        (payload_len < WS_PROTOCOL_HEADER_SIZE)) {
-      Debug_LogValue("NRF:RX_DROP_PIPE=", (int32_t)pipe);
+    /* Pipes are shared: the envelope names the node, the pipe must agree with it. */
+    if ((pipe == 0U) || !WS_Reply_Unwrap(rx_data, payload_len, &node_idx, &frame, &frame_len) ||
+        (node_idx >= ctx->node_count) || (ctx->nodes[node_idx].rx_pipe != pipe) ||
+        (frame_len < WS_PROTOCOL_HEADER_SIZE)) {
+      Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_PIPE=", (int32_t)pipe);
       continue;
     }
 
-    WS_NodeReadings_t measurement;
-    if (!WS_Protocol_Decode(rx_data, payload_len, &measurement)) {
-      Debug_LogValue("NRF:RX_DROP_DECODE pipe=", (int32_t)pipe);
+    if (frame[0] == WS_PROTOCOL_VERSION_BACKLOG) {
+      /* Late measurement from an outage: output later, outside the RX drain loop. */
+      if (ctx->backlog_count >= WS_BACKLOG_RX_DEPTH) {
+        Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_BACKLOG node=", (int32_t)node_idx);
+        continue;
+      }
+      WS_BacklogRx_t *entry = &ctx->backlog[(ctx->backlog_head + ctx->backlog_count) % WS_BACKLOG_RX_DEPTH];
+      entry->node_idx = node_idx;
+      entry->len = frame_len;
+      entry->rx_time_valid = (cfg->rtc_now != NULL) ? 1U : 0U;
+      if (cfg->rtc_now != NULL) {
+        entry->rx_time = *cfg->rtc_now;
+      }
+      memcpy(entry->frame, frame, frame_len);
+      ctx->backlog_count++;
       continue;
     }
 
     WS_NodeState_t *rx_node = &ctx->nodes[node_idx];
+    WS_NodeReadings_t measurement;
+    if (frame[0] == WS_PROTOCOL_VERSION_FRAG) {
+      /* Multi-frame reply: deliver only once every fragment of the set arrived. */
+      WS_FragResult_t frag = WS_Frag_Accept(&rx_node->frag, frame, frame_len);
+      if (frag != WS_FRAG_COMPLETE) {
+        if (frag == WS_FRAG_INVALID) {
+          Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_FRAG node=", (int32_t)node_idx);
+        }
+        continue;
+      }
+      memcpy(&measurement, &rx_node->frag.readings, sizeof(measurement));
+    } else if (!WS_Protocol_DecodeKeyed(frame, frame_len, &rx_node->rx_key, &measurement)) {
+      if (frame[0] == WS_PROTOCOL_VERSION_DELTA) {
+        /* Delta against a keyframe we never got: ask for a fresh one. */
+        ctx->keyframe_mask |= WS_NODE_BIT(node_idx);
+        Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_DELTA node=", (int32_t)node_idx);
+      } else {
+        Debug_LogValueAt(DEBUG_LVL_WARN, "NRF:RX_DROP_DECODE node=", (int32_t)node_idx);
+      }
+      continue;
+    } else if (frame[0] == WS_PROTOCOL_VERSION_KEY) {
+      ctx->keyframe_mask &= ~WS_NODE_BIT(node_idx);
+    }
+
     memcpy(&rx_node->data, &measurement, sizeof(measurement));
     rx_node->last_status = status;
     rx_node->state = WS_NODE_DATA_READY;
     rx_node->retry_count = 0U;
+    ws_link_record(rx_node, 1U);
 
     if (ctx->parallel_cycle != 0U) {
-      ctx->received_mask |= (uint8_t)(1U << node_idx);
+      ctx->received_mask |= WS_NODE_BIT(node_idx);
     }
 
     ctx->latest_data_valid = 1U;
@@ -519,7 +872,7 @@ static void ws_handle_irq(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
 
     ws_set_led(cfg, GPIO_PIN_RESET);
     Debug_LogNrfRxData(node_idx);
-    Debug_LogValue("NRF:RX_PIPE=", pipe);
+    Debug_LogValueAt(DEBUG_LVL_DEBUG, "NRF:RX_PIPE=", pipe);
   }
   NRF24_ClearIRQ(cfg->nrf, NRF24_STATUS_RX_DR);
   status = NRF24_GetStatus(cfg->nrf);
@@ -529,7 +882,7 @@ static void ws_handle_irq(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
     if (ctx->parallel_cycle != 0U) {
       ctx->cycle_tx_done = 1U;
       for (uint8_t i = 0U; i < ctx->node_count; i++) {
-        if ((ctx->expected_mask & (uint8_t)(1U << i)) != 0U) {
+        if ((ctx->expected_mask & WS_NODE_BIT(i)) != 0U) {
           ctx->nodes[i].state = WS_NODE_WAIT_RESPONSE;
           ctx->nodes[i].response_start_tick = HAL_GetTick();
         }
@@ -558,6 +911,8 @@ static void ws_handle_irq(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg) {
       Debug_LogNrfTxResult(0U);
     }
   }
+
+  WS_PROFILE_END(WS_PROF_NRF_IRQ);
 }
 
 /* ============================================================================
@@ -583,24 +938,35 @@ static uint8_t ws_clamp_count(uint8_t node_count) {
 /**
  * @brief Handles retry scheduling before entering full radio recovery
  * @param[in,out] ctx Manager context
- * @return true when a retry was scheduled, false when recovery is required
+ * @param[in] radio_fault 1 when the local TX failed, 0 when the node did not reply
+ * @return true when a retry was scheduled, false when the node was given up
+ * @details A missing reply retries up to the node's link-quality budget. Radio
+ *          recovery follows only for local TX faults or when no node answers
+ *          any more; otherwise the weak node alone is given up.
  */
-static bool ws_schedule_retry_or_recover(WS_Manager_t *ctx) {
+static bool ws_schedule_retry_or_recover(WS_Manager_t *ctx, uint8_t radio_fault) {
   WS_NodeState_t *node = WS_GetActiveNode(ctx);
+  uint8_t node_idx;
   if (node == NULL) {
     return false;
   }
 
+  node_idx = ctx->active_node;
   node->retry_count++;
-  if (node->retry_count < WS_MAX_RETRIES) {
+  if (node->retry_count < ((radio_fault != 0U) ? WS_MAX_RETRIES : ws_link_retry_limit(node))) {
     node->measurement_pending = 1U;
     node->state = WS_NODE_IDLE;
     ctx->app_state = WS_APP_IDLE;
     return true;
   }
 
-  node->retry_count = 0U;
+  ws_link_give_up(node, node_idx);
   WS_ScheduleNextNode(ctx);
+  if ((radio_fault == 0U) && !ws_link_all_silent(ctx)) {
+    Debug_LogValueAt(DEBUG_LVL_ERROR, "NRF:NODE_GIVE_UP node=", (int32_t)node_idx);
+    ctx->app_state = WS_APP_IDLE;
+    return false;
+  }
   ctx->app_state = WS_APP_ERROR_RECOVERY;
   return false;
 }
@@ -612,12 +978,13 @@ static bool ws_schedule_retry_or_recover(WS_Manager_t *ctx) {
 /**
  * @brief Initializes the Weather Station Manager
  * @param[out] ctx Manager context to initialize (must not be NULL)
- * @param[in] tx_addrs Array of TX addresses for each node (5 bytes each)
- * @param[in] rx_addrs Array of RX addresses for each node (5 bytes each)
+ * @param[in] tx_addrs PTX/ACK address per reply pipe, WS_REPLY_PIPES rows of 5 bytes
+ * @param[in] rx_addrs RX address per reply pipe, WS_REPLY_PIPES rows of 5 bytes
  * @param[in] node_count Number of outdoor nodes to manage (1-WS_MAX_NODES)
  * @details Zeroes the context, clamps node count to valid range, copies
- *          addresses, and initializes all nodes to IDLE state. Must be called
- *          before any other WS_ functions.
+ *          addresses, assigns node N to reply pipe WS_REPLY_PIPE(N), and
+ *          initializes all nodes to IDLE state. Must be called before any
+ *          other WS_ functions.
  */
 void WS_InitManager(WS_Manager_t *ctx, const uint8_t tx_addrs[][5], const uint8_t rx_addrs[][5], uint8_t node_count) {
   if (ctx == NULL) {
@@ -634,24 +1001,35 @@ void WS_InitManager(WS_Manager_t *ctx, const uint8_t tx_addrs[][5], const uint8_
   ctx->next_measure_earliest_tick = 0U;
   ctx->cycle_nodes_remaining = 0U;
   ctx->cycle_id = 0U;
+  ctx->poll_id = WS_CMD_CYCLE_PARTIAL;
   ctx->expected_mask = 0U;
   ctx->received_mask = 0U;
+  ctx->keyframe_mask = WS_Cycle_ExpectedMask(ctx->node_count);
+  ctx->cycle_retry_mask = 0U;
   ctx->cycle_pending = 0U;
   ctx->parallel_cycle = 0U;
   ctx->cycle_tx_done = 0U;
   ctx->cycle_tx_start_tick = 0U;
   ctx->cycle_rx_start_tick = 0U;
+  ctx->cycle_window_ms = 0U;
   ctx->app_state = WS_APP_IDLE;
+  ctx->measure_interval_min = WS_MEASURE_INTERVAL_DEFAULT_MIN;
+  ctx->enabled_mask = WS_Cycle_ExpectedMask(ctx->node_count);
 
-  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+  for (uint8_t p = 0U; p < WS_REPLY_PIPES; p++) {
     if (tx_addrs != NULL) {
-      memcpy(ctx->nodes[i].tx_addr, tx_addrs[i], 5U);
+      memcpy(ctx->pipe_tx_addr[p], tx_addrs[p], 5U);
     }
     if (rx_addrs != NULL) {
-      memcpy(ctx->nodes[i].rx_addr, rx_addrs[i], 5U);
+      memcpy(ctx->pipe_rx_addr[p], rx_addrs[p], 5U);
     }
-    ctx->nodes[i].rx_pipe = i + 1U;
+  }
+
+  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+    ctx->nodes[i].rx_pipe = WS_REPLY_PIPE(i);
     ctx->nodes[i].state = WS_NODE_IDLE;
+    /* Start trusted: a node earns the weak-link treatment by missing polls. */
+    ctx->nodes[i].link.success_q8 = 0xFFU;
   }
 }
 
@@ -773,12 +1151,60 @@ void WS_RequestMeasurementCycle(WS_Manager_t *ctx) {
   }
 
   ctx->cycle_pending = 1U;
+  /* A full cycle supersedes a pending re-poll of the nodes that missed. */
+  ctx->cycle_retry_mask = 0U;
   ctx->cycle_nodes_remaining = 0U;
   if ((ctx->app_state == WS_APP_IDLE) || (ctx->app_state == WS_APP_DATA_READY)) {
     ctx->app_state = WS_APP_IDLE;
   }
 }
 
+/**
+ * @brief Checks whether the scheduled cycle is due at this RTC minute
+ * @param[in] ctx Manager context
+ * @param[in] now RTC time of the minute alarm
+ */
+bool WS_IsMeasurementDue(const WS_Manager_t *ctx, const DS3231_DateTime *now) {
+  uint16_t minute_of_day;
+
+  if ((ctx == NULL) || (now == NULL) || (ctx->measure_interval_min <= 1U)) {
+    return true;
+  }
+  minute_of_day = (uint16_t)((now->hours * 60U) + now->minutes);
+  return (minute_of_day % ctx->measure_interval_min) == 0U;
+}
+
+/**
+ * @brief Sets the scheduled measurement interval
+ * @param[in,out] ctx Manager context
+ * @param[in] minutes Divisor of WS_MEASURE_INTERVAL_MAX_MIN
+ * @details WS_IsMeasurementDue() counts from midnight; an interval that does
+ *          not divide the day would leave a short last gap before it.
+ */
+uint8_t WS_SetMeasureInterval(WS_Manager_t *ctx, uint8_t minutes) {
+  if ((ctx == NULL) || (minutes == 0U) || (minutes > WS_MEASURE_INTERVAL_MAX_MIN) ||
+      ((WS_MEASURE_INTERVAL_MAX_MIN % minutes) != 0U)) {
+    return 1U;
+  }
+  ctx->measure_interval_min = minutes;
+  return 0U;
+}
+
+/**
+ * @brief Selects the nodes polled by parallel cycles
+ * @param[in,out] ctx Manager context
+ * @param[in] mask Non-empty subset of the managed nodes
+ * @details A pending re-poll keeps only the nodes that stay enabled.
+ */
+uint8_t WS_SetEnabledNodes(WS_Manager_t *ctx, WS_NodeMask_t mask) {
+  if ((ctx == NULL) || (mask == 0U) || ((mask & ~WS_Cycle_ExpectedMask(ctx->node_count)) != 0U)) {
+    return 1U;
+  }
+  ctx->enabled_mask = mask;
+  ctx->cycle_retry_mask &= mask;
+  return 0U;
+}
+
 /**
  * @brief Clears the measurement pending flag for the active node
  * @param[in,out] ctx Manager context
@@ -861,8 +1287,10 @@ WS_TxEvent_t WS_ConsumeTxEvent(WS_Manager_t *ctx, uint32_t now_tick) {
     }
 
     /* Parallel TX failed if all expected nodes were marked ERROR after MAX_RT. */
-    if ((ctx->node_count > 0U) && (ctx->nodes[0].state == WS_NODE_ERROR)) {
-      return WS_TX_EVENT_FAIL;
+    for (uint8_t i = 0U; i < ctx->node_count; i++) {
+      if ((ctx->expected_mask & WS_NODE_BIT(i)) != 0U) {
+        return (ctx->nodes[i].state == WS_NODE_ERROR) ? WS_TX_EVENT_FAIL : WS_TX_EVENT_NONE;
+      }
     }
     return WS_TX_EVENT_NONE;
   }
@@ -1056,7 +1484,7 @@ bool WS_GetLatestMeasurement(const WS_Manager_t *ctx, WS_NodeReadings_t *out_dat
  * @param[in] cfg Runtime configuration containing nRF24 parameters
  * @return HAL_OK on success, HAL_ERROR on failure
  * @details Configures:
- *          - RF channel, data rate (1Mbps), power (max)
+ *          - RF channel, data rate and PA level from `cfg`
  *          - CRC (2-byte), address width (5 bytes)
  *          - Auto-retransmit (10 retries, 1500us delay)
  *          - Pipe 0 for auto-ACK (dynamic, follows TX_ADDR)
@@ -1069,8 +1497,8 @@ HAL_StatusTypeDef WS_InitRadioAndStart(WS_Manager_t *ctx, const WS_RuntimeConfig
   }
 
   NRF24_SetChannel(cfg->nrf, cfg->channel);
-  NRF24_SetDataRate(cfg->nrf, NRF24_DR_1MBPS);
-  NRF24_SetPALevel(cfg->nrf, NRF24_PA_MAX);
+  NRF24_SetDataRate(cfg->nrf, (NRF24_DataRate_t)cfg->data_rate);
+  NRF24_SetPALevel(cfg->nrf, (NRF24_PALevel_t)cfg->pa_level);
   NRF24_SetCRC(cfg->nrf, NRF24_CRC_2B);
   NRF24_SetAddressWidth(cfg->nrf, NRF24_AW_5);
   NRF24_SetAutoRetr(cfg->nrf, 1U, 10U);
@@ -1079,7 +1507,7 @@ HAL_StatusTypeDef WS_InitRadioAndStart(WS_Manager_t *ctx, const WS_RuntimeConfig
     uint8_t feature = 0U;
     if ((NRF24_ReadReg(cfg->nrf, NRF24_REG_FEATURE, &feature) == HAL_OK) &&
         ((feature & NRF24_FEATURE_EN_DYN_ACK) == 0U)) {
-      Debug_Log("NRF:FEATURE_NO_DYN_ACK");
+      Debug_LogAt(DEBUG_LVL_WARN, "NRF:FEATURE_NO_DYN_ACK");
     }
   }
 
@@ -1089,17 +1517,20 @@ HAL_StatusTypeDef WS_InitRadioAndStart(WS_Manager_t *ctx, const WS_RuntimeConfig
   NRF24_SetAutoAck(cfg->nrf, 0U, 1U);
   NRF24_SetPayloadSize(cfg->nrf, 0U, cfg->payload_size);
 
-  /* Pipes 1-N: static RX addresses for each outdoor node (multiceiver) */
-  for (uint8_t i = 0U; i < ctx->node_count; i++) {
+  /* Pipes 1-5: static reply addresses (multiceiver), each shared by nodes WS_REPLY_PIPES apart */
+  for (uint8_t i = 0U; (i < ctx->node_count) && (i < WS_REPLY_PIPES); i++) {
     uint8_t pipe = ctx->nodes[i].rx_pipe;
-    NRF24_SetRXAddress(cfg->nrf, pipe, ctx->nodes[i].rx_addr, 5U);
+    NRF24_SetRXAddress(cfg->nrf, pipe, ctx->pipe_rx_addr[pipe - 1U], 5U);
     NRF24_EnablePipe(cfg->nrf, pipe, 1U);
     NRF24_SetAutoAck(cfg->nrf, pipe, 1U);
     NRF24_SetPayloadSize(cfg->nrf, pipe, cfg->payload_size);
+#if NRF_DYNAMIC_PAYLOAD
+    NRF24_EnableDynamicPayload(cfg->nrf, pipe, 1U);
+#endif
   }
 
   /* Disable unused pipes */
-  for (uint8_t p = ctx->node_count + 1U; p <= 5U; p++) {
+  for (uint8_t p = ctx->node_count + 1U; p <= WS_REPLY_PIPES; p++) {
     NRF24_EnablePipe(cfg->nrf, p, 0U);
   }
 
@@ -1112,6 +1543,39 @@ HAL_StatusTypeDef WS_InitRadioAndStart(WS_Manager_t *ctx, const WS_RuntimeConfig
   return HAL_OK;
 }
 
+/**
+ * @brief Changes RF channel, data rate and PA level of the running radio
+ * @param[in] ctx Manager context
+ * @param[in,out] cfg Runtime configuration
+ * @param[in] channel RF channel (0-125)
+ * @param[in] data_rate NRF24_DataRate_t
+ * @param[in] pa_level NRF24_PALevel_t
+ * @details Only while the link is idle, so no command or reply is in the air.
+ *          `cfg` keeps the values for WS_InitRadioAndStart() after a recovery.
+ */
+HAL_StatusTypeDef WS_SetRadioConfig(const WS_Manager_t *ctx, WS_RuntimeConfig_t *cfg,
+                                    uint8_t channel, uint8_t data_rate, uint8_t pa_level) {
+  if ((ctx == NULL) || (cfg == NULL) || (cfg->nrf == NULL) || (channel > NRF24_MAX_CHANNEL) ||
+      ((data_rate != (uint8_t)NRF24_DR_250KBPS) && (data_rate != (uint8_t)NRF24_DR_1MBPS) &&
+       (data_rate != (uint8_t)NRF24_DR_2MBPS)) ||
+      ((pa_level & ~(uint8_t)NRF24_PA_MAX) != 0U)) {
+    return HAL_ERROR;
+  }
+  if ((ctx->app_state != WS_APP_IDLE) || (ctx->parallel_cycle != 0U) || (ctx->cycle_pending != 0U)) {
+    return HAL_BUSY;
+  }
+
+  if ((NRF24_SetChannel(cfg->nrf, channel) != HAL_OK) ||
+      (NRF24_SetDataRate(cfg->nrf, (NRF24_DataRate_t)data_rate) != HAL_OK) ||
+      (NRF24_SetPALevel(cfg->nrf, (NRF24_PALevel_t)pa_level) != HAL_OK)) {
+    return HAL_ERROR;
+  }
+  cfg->channel = channel;
+  cfg->data_rate = data_rate;
+  cfg->pa_level = pa_level;
+  return HAL_OK;
+}
+
 /* ============================================================================
  * PUBLIC API - Main Event Loop
  * ========================================================================== */
@@ -1144,9 +1608,9 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
   }
 
   if ((cfg->comm_watchdog_timeout_ms != 0U) &&
-      ((now_tick - ctx->last_successful_rx_tick) > cfg->comm_watchdog_timeout_ms)) {
+      ((now_tick - ctx->last_successful_rx_tick) > ws_comm_watchdog_ms(ctx, cfg))) {
     ctx->comm_watchdog_tripped = 1U;
-    Debug_Log("NRF:COMM_WATCHDOG_TRIPPED");
+    Debug_LogAt(DEBUG_LVL_ERROR, "NRF:COMM_WATCHDOG_TRIPPED");
     return;
   }
 
@@ -1169,6 +1633,8 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
     }
 
     if (need_radio == 0U) {
+      /* Backlog frames are already in RAM: no need to wake the radio for them. */
+      ws_process_backlog(ctx, cfg);
       return;
     }
 
@@ -1180,9 +1646,9 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
     ctx->parallel_cycle = 0U;
     ctx->cycle_tx_done = 0U;
     if (WS_InitRadioAndStart(ctx, cfg) == HAL_OK) {
-      Debug_Log("NRF:RECOVERY_OK");
+      Debug_LogAt(DEBUG_LVL_INFO, "NRF:RECOVERY_OK");
     } else {
-      Debug_Log("NRF:RECOVERY_FAIL");
+      Debug_LogAt(DEBUG_LVL_ERROR, "NRF:RECOVERY_FAIL");
     }
     if (ctx->cycle_pending != 0U) {
       ctx->app_state = WS_APP_IDLE;
@@ -1212,7 +1678,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
       }
       if ((ctx->app_state == WS_APP_WAIT_RX_DATA) &&
           (ctx->cycle_rx_start_tick != 0U) &&
-          ((now_tick - ctx->cycle_rx_start_tick) > ((cfg->rx_timeout_ms * 3U) / 4U))) {
+          ((now_tick - ctx->cycle_rx_start_tick) > ((ctx->cycle_window_ms * 3U) / 4U))) {
         should_poll = 1U;
       }
     } else {
@@ -1221,7 +1687,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
         should_poll = 1U;
       }
       if ((node->state == WS_NODE_WAIT_RESPONSE) &&
-          ((now_tick - node->response_start_tick) > ((cfg->rx_timeout_ms * 3U) / 4U))) {
+          ((now_tick - node->response_start_tick) > ((ctx->cycle_window_ms * 3U) / 4U))) {
         should_poll = 1U;
       }
     }
@@ -1242,6 +1708,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
   /* Deliver payloads, then leave DATA_READY. Staying there forever blocks
    * WS_CanSleep (IDLE only) and skips cycle_pending until the next request. */
   ws_process_ready_nodes(ctx, cfg);
+  ws_process_backlog(ctx, cfg);
   if (ctx->app_state == WS_APP_DATA_READY) {
     ctx->app_state = WS_APP_IDLE;
     return;
@@ -1267,7 +1734,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
       ctx->app_state = WS_APP_ERROR_RECOVERY;
       ctx->cycle_pending = 1U;
     } else {
-      (void)ws_schedule_retry_or_recover(ctx);
+      (void)ws_schedule_retry_or_recover(ctx, 1U);
     }
     return;
   }
@@ -1299,7 +1766,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
 
     if ((ctx->app_state == WS_APP_WAIT_RX_DATA) &&
         (ctx->cycle_rx_start_tick != 0U) &&
-        ((now_tick - ctx->cycle_rx_start_tick) > cfg->rx_timeout_ms)) {
+        ((now_tick - ctx->cycle_rx_start_tick) > ctx->cycle_window_ms)) {
       Debug_LogNrfTimeout(0U);
       ws_finalize_parallel_cycle(ctx, cfg, 1U);
       return;
@@ -1328,7 +1795,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
       }
       if (tx_event == WS_TX_EVENT_FAIL) {
         ws_start_receive(ctx, cfg);
-        (void)ws_schedule_retry_or_recover(ctx);
+        (void)ws_schedule_retry_or_recover(ctx, 1U);
         return;
       }
     }
@@ -1338,7 +1805,7 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
     WS_HandleActiveTxTimeout(ctx, node->last_status);
     ws_start_receive(ctx, cfg);
     Debug_LogNrfTimeout(1U);
-    (void)ws_schedule_retry_or_recover(ctx);
+    (void)ws_schedule_retry_or_recover(ctx, 1U);
     return;
   }
 
@@ -1356,11 +1823,12 @@ void WS_ProcessEventHandler(WS_Manager_t *ctx, const WS_RuntimeConfig_t *cfg, ui
     ctx->app_state = WS_APP_WAIT_TX_IRQ;
   }
 
-  if (WS_IsActiveRxTimedOut(ctx, now_tick, cfg->rx_timeout_ms)) {
+  if (WS_IsActiveRxTimedOut(ctx, now_tick, ctx->cycle_window_ms)) {
     WS_HandleActiveRxTimeout(ctx, node->last_status);
+    ws_link_record(node, 0U);
     Debug_LogNrfTimeout(0U);
     ws_start_receive(ctx, cfg);
-    (void)ws_schedule_retry_or_recover(ctx);
+    (void)ws_schedule_retry_or_recover(ctx, 0U);
     return;
   }
 }
@@ -1392,6 +1860,12 @@ uint8_t WS_CanSleep(const WS_Manager_t *ctx)
     return 0U;
   }
 
+  /* Backlog frames are output one per pass; keep passing until all are out. */
+  if (ctx->backlog_count != 0U)
+  {
+    return 0U;
+  }
+
   if (ctx->nrf_irq_flag != 0U)
   {
     return 0U;
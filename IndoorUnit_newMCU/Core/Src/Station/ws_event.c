@@ -0,0 +1,106 @@
+/**
+ * @file    ws_event.c
+ * @brief   Single-producer / single-consumer pending flags (ISR -> main loop)
+ * @details Each event type owns one byte flag. The producer only sets a flag
+ *          (after storing its tick), the consumer only clears it (after
+ *          reading the tick), so neither side needs a critical section and no
+ *          post can be lost: a post that finds its flag set is already
+ *          covered by the dispatch that will follow.
+ */
+
+#include "ws_event.h"
+
+#include "main.h"
+
+static volatile uint8_t ws_event_pending[WS_EVT_COUNT]; /**< 1 = type waiting for dispatch */
+static volatile uint32_t ws_event_tick[WS_EVT_COUNT];   /**< Tick of the first pending post */
+static volatile uint32_t ws_event_coalesced;            /**< Posts merged into a pending flag */
+static WS_EventStats_t ws_event_stats[WS_EVT_COUNT];
+
+/**
+ * @brief   Posts an event (producer side: interrupt context only)
+ * @param   type  Event source
+ * @retval  true  Event marked pending
+ * @retval  false Invalid type, or already pending and merged into that dispatch
+ */
+bool WS_Event_Post(WS_EventType_t type) {
+  if ((uint8_t)type >= (uint8_t)WS_EVT_COUNT) {
+    return false;
+  }
+
+  if (ws_event_pending[type] != 0U) {
+    ws_event_coalesced++;
+    return false;
+  }
+
+  ws_event_tick[type] = HAL_GetTick();
+  __DMB();
+  ws_event_pending[type] = 1U;
+  return true;
+}
+
+/**
+ * @brief   Takes the highest-priority pending event (consumer side: main loop only)
+ * @param   out  Receives the event
+ * @retval  true  Event returned and its latency recorded
+ * @retval  false Nothing pending
+ */
+bool WS_Event_Get(WS_Event_t *out) {
+  if (out == NULL) {
+    return false;
+  }
+
+  for (uint8_t type = 0U; type < (uint8_t)WS_EVT_COUNT; type++) {
+    if (ws_event_pending[type] == 0U) {
+      continue;
+    }
+
+    __DMB();
+    out->type = type;
+    out->tick = ws_event_tick[type];
+    __DMB();
+    ws_event_pending[type] = 0U;
+
+    WS_EventStats_t *stats = &ws_event_stats[type];
+    uint32_t latency_ms = HAL_GetTick() - out->tick;
+    stats->count++;
+    stats->total_latency_ms += latency_ms;
+    if (latency_ms > stats->max_latency_ms) {
+      stats->max_latency_ms = latency_ms;
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief   Checks whether any event is pending
+ * @retval  true  Nothing pending
+ */
+bool WS_Event_IsEmpty(void) {
+  for (uint8_t type = 0U; type < (uint8_t)WS_EVT_COUNT; type++) {
+    if (ws_event_pending[type] != 0U) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief   Returns the number of posts merged into an already pending event
+ */
+uint32_t WS_Event_Coalesced(void) {
+  return ws_event_coalesced;
+}
+
+/**
+ * @brief   Returns dispatch statistics of one event type
+ * @param   type  Event source
+ * @retval  Pointer to the statistics, or NULL for an invalid type
+ */
+const WS_EventStats_t *WS_Event_GetStats(WS_EventType_t type) {
+  if ((uint8_t)type >= (uint8_t)WS_EVT_COUNT) {
+    return NULL;
+  }
+  return &ws_event_stats[type];
+}
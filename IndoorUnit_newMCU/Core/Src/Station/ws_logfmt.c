@@ -0,0 +1,400 @@
+/**
+ * @file ws_logfmt.c
+ * @brief JSON Lines formatting and binary day file records for the SD logger
+ * @details Shared verbatim with the host converter; no HAL or FatFs calls.
+ */
+
+#include "ws_logfmt.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Days from 1970-01-01 to 2000-01-01 */
+#define WS_LOGFMT_DAYS_TO_2000 10957UL
+/** @brief Offset of the v2 frame inside a binary record */
+#define WS_LOGFMT_BIN_FRAME_OFFSET 6U
+
+static const uint8_t WS_LOGFMT_FIELD_CHANNELS[] = {
+    (uint8_t)WS_CH_SI7021_TEMP,
+    (uint8_t)WS_CH_SI7021_HUM,
+    (uint8_t)WS_CH_BMP280_TEMP,
+    (uint8_t)WS_CH_BMP280_PRESS,
+    (uint8_t)WS_CH_TSL2561_LUX,
+    (uint8_t)WS_CH_BME280_TEMP,
+    (uint8_t)WS_CH_BME280_PRESS,
+    (uint8_t)WS_CH_BME280_HUM,
+};
+
+static const char *const WS_LOGFMT_FIELD_NAMES[] = {
+    "si7021_temp",
+    "si7021_hum",
+    "bmp280_temp",
+    "bmp280_press",
+    "tsl2561_lux",
+    "bme280_temp",
+    "bme280_press",
+    "bme280_hum",
+};
+
+#define WS_LOGFMT_FIELD_COUNT (sizeof(WS_LOGFMT_FIELD_CHANNELS) / sizeof(WS_LOGFMT_FIELD_CHANNELS[0]))
+
+static const uint16_t WS_LOGFMT_DAYS_BEFORE_MONTH[12] = {0U, 31U, 59U, 90U, 120U, 151U,
+                                                         181U, 212U, 243U, 273U, 304U, 334U};
+
+/**
+ * @brief Format a float as a fixed-point decimal string without libc `%f`.
+ * @param dst      Destination buffer.
+ * @param dst_size Capacity in bytes.
+ * @param value    Value to print.
+ * @param decimals Digits after the decimal point (0 = integer).
+ */
+static void ws_logfmt_fixed(char *dst, size_t dst_size, float value, uint8_t decimals) {
+  int32_t scale = 1;
+  float scaled_f;
+  int32_t scaled;
+  int32_t abs_scaled;
+  int32_t int_part;
+  int32_t frac_part;
+
+  for (uint8_t i = 0U; i < decimals; i++) {
+    scale *= 10;
+  }
+
+  scaled_f = value * (float)scale;
+  if (scaled_f >= 0.0f) {
+    scaled_f += 0.5f;
+  } else {
+    scaled_f -= 0.5f;
+  }
+
+  scaled = (int32_t)scaled_f;
+  abs_scaled = (scaled < 0) ? -scaled : scaled;
+  int_part = abs_scaled / scale;
+  frac_part = abs_scaled % scale;
+
+  if (decimals == 0U) {
+    (void)snprintf(dst, dst_size, "%s%ld", (scaled < 0) ? "-" : "", (long)int_part);
+  } else {
+    (void)snprintf(dst, dst_size, "%s%ld.%0*ld", (scaled < 0) ? "-" : "", (long)int_part,
+                   (int)decimals, (long)frac_part);
+  }
+}
+
+/**
+ * @brief Format sensor_status as picoserver `OK` / `ERR:SI7021_BMP280`.
+ * @param dst           Destination buffer.
+ * @param dst_size      Capacity in bytes.
+ * @param sensor_status Bitmask of WS_SENSOR_ERR_*.
+ */
+static void ws_logfmt_status(char *dst, size_t dst_size, uint8_t sensor_status) {
+  uint8_t known = sensor_status &
+      ((uint8_t)WS_SENSOR_ERR_SI7021 | (uint8_t)WS_SENSOR_ERR_BMP280 |
+       (uint8_t)WS_SENSOR_ERR_TSL2561 | (uint8_t)WS_SENSOR_ERR_BME280);
+  size_t used;
+
+  if ((dst == NULL) || (dst_size == 0U)) {
+    return;
+  }
+
+  if (known == (uint8_t)WS_SENSOR_OK) {
+    (void)snprintf(dst, dst_size, "OK");
+    return;
+  }
+
+  /* Match picoserver _normalize_status: ERR:SI7021_BMP280 (underscores). */
+  (void)snprintf(dst, dst_size, "ERR:");
+  used = strlen(dst);
+
+  if ((known & (uint8_t)WS_SENSOR_ERR_SI7021) != 0U) {
+    (void)snprintf(dst + used, dst_size - used, "%sSI7021", (used == 4U) ? "" : "_");
+    used = strlen(dst);
+  }
+  if ((known & (uint8_t)WS_SENSOR_ERR_BMP280) != 0U) {
+    (void)snprintf(dst + used, dst_size - used, "%sBMP280", (used == 4U) ? "" : "_");
+    used = strlen(dst);
+  }
+  if ((known & (uint8_t)WS_SENSOR_ERR_TSL2561) != 0U) {
+    (void)snprintf(dst + used, dst_size - used, "%sTSL2561", (used == 4U) ? "" : "_");
+    used = strlen(dst);
+  }
+  if ((known & (uint8_t)WS_SENSOR_ERR_BME280) != 0U) {
+    (void)snprintf(dst + used, dst_size - used, "%sBME280", (used == 4U) ? "" : "_");
+  }
+
+  if (strlen(dst) <= 4U) {
+    (void)snprintf(dst, dst_size, "ERR:UNKNOWN");
+  }
+}
+
+static void ws_logfmt_put_le32(uint8_t *dst, uint32_t value) {
+  dst[0] = (uint8_t)value;
+  dst[1] = (uint8_t)(value >> 8);
+  dst[2] = (uint8_t)(value >> 16);
+  dst[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t ws_logfmt_get_le32(const uint8_t *src) {
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+/** @brief CRC-16/CCITT-FALSE (poly 0x1021), continuing from @p crc */
+static uint16_t ws_logfmt_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+  while (len-- > 0U) {
+    crc ^= (uint16_t)((uint16_t)*data++ << 8);
+    for (uint8_t bit = 0U; bit < 8U; bit++) {
+      crc = ((crc & 0x8000U) != 0U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/** @brief CRC of a record, tied to its file by the day epoch */
+static uint16_t ws_logfmt_record_crc(const uint8_t *buf, uint32_t day_epoch) {
+  uint8_t seed[4];
+
+  ws_logfmt_put_le32(seed, day_epoch);
+  return ws_logfmt_crc16(ws_logfmt_crc16(0xFFFFU, seed, sizeof(seed)), buf, WS_LOGFMT_BIN_RECORD_SIZE - 2U);
+}
+
+static bool ws_logfmt_is_leap(uint16_t year) {
+  return ((year % 4U) == 0U) && (((year % 100U) != 0U) || ((year % 400U) == 0U));
+}
+
+bool WS_LogFmt_Json(uint8_t station_idx, const WS_LogTime_t *t, const WS_Readings_t *readings,
+                    char *buf, size_t buf_size, uint16_t *out_len) {
+  static const WS_LogTime_t zero_time = {0U, 0U, 0U, 0U, 0U, 0U};
+  char status[40];
+  char value_text[16];
+  int len;
+  int part;
+
+  if ((readings == NULL) || (buf == NULL) || (out_len == NULL)) {
+    return false;
+  }
+  if (t == NULL) {
+    t = &zero_time;
+  }
+
+  ws_logfmt_status(status, sizeof(status), readings->sensor_status);
+
+  len = snprintf(buf, buf_size,
+                 "{\"station_id\":\"S%u\",\"timestamp\":\"20%02u-%02u-%02uT%02u:%02u:%02u\",\"status\":\"%s\"",
+                 (unsigned int)station_idx,
+                 (unsigned int)t->year,
+                 (unsigned int)t->month,
+                 (unsigned int)t->date,
+                 (unsigned int)t->hours,
+                 (unsigned int)t->minutes,
+                 (unsigned int)t->seconds,
+                 status);
+  if ((len <= 0) || ((size_t)len >= buf_size)) {
+    return false;
+  }
+
+  for (uint8_t i = 0U; i < (uint8_t)WS_LOGFMT_FIELD_COUNT; i++) {
+    float value = 0.0f;
+
+    if (WS_Reading_Get(readings, WS_LOGFMT_FIELD_CHANNELS[i], &value)) {
+      if (WS_LOGFMT_FIELD_CHANNELS[i] == (uint8_t)WS_CH_TSL2561_LUX) {
+        ws_logfmt_fixed(value_text, sizeof(value_text), value, 0U);
+      } else if ((WS_LOGFMT_FIELD_CHANNELS[i] == (uint8_t)WS_CH_BMP280_PRESS) ||
+                 (WS_LOGFMT_FIELD_CHANNELS[i] == (uint8_t)WS_CH_BME280_PRESS)) {
+        ws_logfmt_fixed(value_text, sizeof(value_text), value, 2U);
+      } else {
+        ws_logfmt_fixed(value_text, sizeof(value_text), value, 1U);
+      }
+      part = snprintf(buf + len, buf_size - (size_t)len, ",\"%s\":%s",
+                      WS_LOGFMT_FIELD_NAMES[i], value_text);
+    } else {
+      part = snprintf(buf + len, buf_size - (size_t)len, ",\"%s\":null",
+                      WS_LOGFMT_FIELD_NAMES[i]);
+    }
+
+    if ((part <= 0) || (((size_t)len + (size_t)part) >= buf_size)) {
+      return false;
+    }
+    len += part;
+  }
+
+  part = snprintf(buf + len, buf_size - (size_t)len, "}\n");
+  if ((part <= 0) || (((size_t)len + (size_t)part) >= buf_size)) {
+    return false;
+  }
+  len += part;
+
+  *out_len = (uint16_t)len;
+  return true;
+}
+
+uint32_t WS_LogFmt_TimeToEpoch(const WS_LogTime_t *t) {
+  uint16_t year;
+  uint32_t days;
+
+  if ((t == NULL) || (t->month < 1U) || (t->month > 12U) || (t->date < 1U) || (t->date > 31U) ||
+      (t->year > 99U) || (t->hours > 23U) || (t->minutes > 59U) || (t->seconds > 59U)) {
+    return 0U;
+  }
+
+  year = (uint16_t)(2000U + t->year);
+  /* Leap days of 2000..year-1: 2000 is a leap year and 2100 is out of range. */
+  days = WS_LOGFMT_DAYS_TO_2000 + (365UL * t->year) + (((uint32_t)t->year + 3U) / 4U);
+  days += WS_LOGFMT_DAYS_BEFORE_MONTH[t->month - 1U];
+  if ((t->month > 2U) && ws_logfmt_is_leap(year)) {
+    days++;
+  }
+  days += (uint32_t)t->date - 1U;
+
+  return (days * WS_LOGFMT_DAY_S) + ((uint32_t)t->hours * 3600UL) +
+         ((uint32_t)t->minutes * 60UL) + (uint32_t)t->seconds;
+}
+
+void WS_LogFmt_EpochToTime(uint32_t epoch, WS_LogTime_t *t) {
+  uint32_t days;
+  uint32_t secs;
+  uint8_t year = 0U;
+  uint8_t month = 0U;
+
+  if (t == NULL) {
+    return;
+  }
+  memset(t, 0, sizeof(*t));
+
+  days = epoch / WS_LOGFMT_DAY_S;
+  if ((epoch == 0U) || (days < WS_LOGFMT_DAYS_TO_2000)) {
+    return;
+  }
+  secs = epoch % WS_LOGFMT_DAY_S;
+  days -= WS_LOGFMT_DAYS_TO_2000;
+
+  for (;;) {
+    uint32_t year_days = ws_logfmt_is_leap((uint16_t)(2000U + year)) ? 366U : 365U;
+    if ((days < year_days) || (year >= 99U)) {
+      break;
+    }
+    days -= year_days;
+    year++;
+  }
+  for (month = 12U; month > 1U; month--) {
+    uint32_t first = WS_LOGFMT_DAYS_BEFORE_MONTH[month - 1U];
+    if ((month > 2U) && ws_logfmt_is_leap((uint16_t)(2000U + year))) {
+      first++;
+    }
+    if (days >= first) {
+      days -= first;
+      break;
+    }
+  }
+
+  t->year = year;
+  t->month = month;
+  t->date = (uint8_t)(days + 1U);
+  t->hours = (uint8_t)(secs / 3600UL);
+  t->minutes = (uint8_t)((secs / 60UL) % 60UL);
+  t->seconds = (uint8_t)(secs % 60UL);
+}
+
+void WS_LogFmt_BinHeader(uint8_t station_idx, uint32_t day_epoch, uint8_t *buf) {
+  if (buf == NULL) {
+    return;
+  }
+  memset(buf, 0, WS_LOGFMT_BIN_HEADER_SIZE);
+  memcpy(buf, WS_LOGFMT_BIN_MAGIC, 4U);
+  buf[4] = (uint8_t)WS_LOGFMT_BIN_VERSION;
+  buf[5] = (uint8_t)WS_LOGFMT_BIN_RECORD_SIZE;
+  buf[6] = (uint8_t)WS_LOGFMT_BIN_HEADER_SIZE;
+  buf[7] = station_idx;
+  ws_logfmt_put_le32(&buf[8], day_epoch);
+  for (uint8_t h = 0U; h < WS_LOGFMT_BIN_INDEX_SLOTS; h++) {
+    buf[WS_LOGFMT_BIN_INDEX_OFFSET(h)] = 0xFFU;
+    buf[WS_LOGFMT_BIN_INDEX_OFFSET(h) + 1U] = 0xFFU;
+  }
+}
+
+bool WS_LogFmt_BinCheckHeader(const uint8_t *buf, uint8_t *out_station_idx, uint32_t *out_day_epoch) {
+  if ((buf == NULL) || (memcmp(buf, WS_LOGFMT_BIN_MAGIC, 4U) != 0) ||
+      (buf[4] != (uint8_t)WS_LOGFMT_BIN_VERSION) ||
+      (buf[5] != (uint8_t)WS_LOGFMT_BIN_RECORD_SIZE) ||
+      (buf[6] != (uint8_t)WS_LOGFMT_BIN_HEADER_SIZE)) {
+    return false;
+  }
+  if (out_station_idx != NULL) {
+    *out_station_idx = buf[7];
+  }
+  if (out_day_epoch != NULL) {
+    *out_day_epoch = ws_logfmt_get_le32(&buf[8]);
+  }
+  return true;
+}
+
+uint16_t WS_LogFmt_BinIndexGet(const uint8_t *header, uint8_t hour) {
+  if ((header == NULL) || (hour >= WS_LOGFMT_BIN_INDEX_SLOTS)) {
+    return WS_LOGFMT_BIN_INDEX_NONE;
+  }
+  return (uint16_t)(header[WS_LOGFMT_BIN_INDEX_OFFSET(hour)] |
+                    ((uint16_t)header[WS_LOGFMT_BIN_INDEX_OFFSET(hour) + 1U] << 8));
+}
+
+uint32_t WS_LogFmt_BinCount(const uint8_t *header) {
+  if (header == NULL) {
+    return 0U;
+  }
+  return ws_logfmt_get_le32(&header[WS_LOGFMT_BIN_COUNT_OFFSET]);
+}
+
+void WS_LogFmt_BinSetCount(uint8_t *header, uint32_t count) {
+  if (header != NULL) {
+    ws_logfmt_put_le32(&header[WS_LOGFMT_BIN_COUNT_OFFSET], count);
+  }
+}
+
+bool WS_LogFmt_BinEncode(uint32_t epoch, uint8_t station_idx, const WS_Readings_t *readings, uint8_t *buf) {
+  uint8_t frame_len = 0U;
+
+  if ((readings == NULL) || (buf == NULL)) {
+    return false;
+  }
+  memset(buf, 0, WS_LOGFMT_BIN_RECORD_SIZE);
+  if (!WS_Protocol_EncodeV2(readings, &buf[WS_LOGFMT_BIN_FRAME_OFFSET], WS_PROTOCOL_V2_MAX_SIZE, &frame_len)) {
+    return false;
+  }
+  ws_logfmt_put_le32(buf, epoch);
+  buf[4] = station_idx;
+  buf[5] = frame_len;
+  return true;
+}
+
+void WS_LogFmt_BinSeal(uint8_t *buf, uint16_t seq, uint32_t day_epoch) {
+  uint16_t crc;
+
+  if (buf == NULL) {
+    return;
+  }
+  buf[28] = (uint8_t)seq;
+  buf[29] = (uint8_t)(seq >> 8);
+  crc = ws_logfmt_record_crc(buf, day_epoch);
+  buf[30] = (uint8_t)crc;
+  buf[31] = (uint8_t)(crc >> 8);
+}
+
+bool WS_LogFmt_BinVerify(const uint8_t *buf, uint16_t seq, uint8_t station_idx, uint32_t day_epoch) {
+  if ((buf == NULL) || (buf[4] != station_idx) ||
+      ((uint16_t)(buf[28] | ((uint16_t)buf[29] << 8)) != seq)) {
+    return false;
+  }
+  return (uint16_t)(buf[30] | ((uint16_t)buf[31] << 8)) == ws_logfmt_record_crc(buf, day_epoch);
+}
+
+bool WS_LogFmt_BinDecode(const uint8_t *buf, uint32_t *out_epoch, uint8_t *out_station_idx,
+                         WS_Readings_t *out) {
+  if ((buf == NULL) || (out_epoch == NULL) || (out_station_idx == NULL) || (out == NULL) ||
+      (buf[5] > WS_PROTOCOL_V2_MAX_SIZE) ||
+      (buf[WS_LOGFMT_BIN_FRAME_OFFSET] != WS_PROTOCOL_VERSION_V2)) {
+    return false;
+  }
+  if (!WS_Protocol_Decode(&buf[WS_LOGFMT_BIN_FRAME_OFFSET], buf[5], out)) {
+    return false;
+  }
+  *out_epoch = ws_logfmt_get_le32(buf);
+  *out_station_idx = buf[4];
+  return true;
+}
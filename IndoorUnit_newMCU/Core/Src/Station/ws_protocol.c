@@ -1,36 +1,279 @@
 /**
  * @file ws_protocol.c
  * @brief Encode/decode implementation for Weather Station measurement payloads
- * @details Binary frame layout: [version][sensor_status][count][channel+float]×count
+ * @details Binary frame layouts:
+ *          v1: [0x01][sensor_status][count][channel+float]×count
+ *          v2: [0x02][sensor_status][channel_bitmap][int16/int24 value]×popcount
+ *          fragment: [0x03][sensor_status][seq][index<<4|total][count][channel+float]×count
+ *          keyframe: [0x04][sensor_status][key_seq][channel_bitmap][v2 values]
+ *          delta:    [0x05][sensor_status][key_seq][channel_bitmap][int8]×popcount
+ *          backlog:  [0x06][sensor_status][age_s LE16][channel_bitmap][v2 values]
+ *          every reply goes on air behind a [node_id] envelope byte.
  */
 
 #include "ws_protocol.h"
 
+#include <math.h>
 #include <string.h>
 
+/* ============================================================================
+ * Protocol v2 channel table
+ * ============================================================================ */
+
+/**
+ * @brief Fixed-point encoding of one v2 channel
+ */
+typedef struct {
+  uint8_t width;  /**< Wire width in bytes: 2 = int16, 3 = int24 */
+  float scale;    /**< Raw counts per channel unit */
+} ws_v2_channel_t;
+
+/** @brief v2 encoding per channel, indexed by channel_id - 1 */
+static const ws_v2_channel_t WS_V2_CHANNELS[WS_CH_MAX] = {
+    {2U, 100.0f},  /* WS_CH_SI7021_TEMP  0.01 °C  */
+    {2U, 10.0f},   /* WS_CH_SI7021_HUM   0.1 %RH  */
+    {2U, 100.0f},  /* WS_CH_BMP280_TEMP  0.01 °C  */
+    {3U, 100.0f},  /* WS_CH_BMP280_PRESS 0.01 hPa */
+    {3U, 1.0f},    /* WS_CH_TSL2561_LUX  1 lux    */
+    {2U, 100.0f},  /* WS_CH_BME280_TEMP  0.01 °C  */
+    {3U, 100.0f},  /* WS_CH_BME280_PRESS 0.01 hPa */
+    {2U, 10.0f},   /* WS_CH_BME280_HUM   0.1 %RH  */
+};
+
 /**
- * @brief   Calculates encoded frame size for a given reading count
- * @param   count  Number of readings (clamped to WS_MAX_READINGS)
+ * @brief   Largest raw count representable at a channel's wire width
+ * @param   ch  Channel encoding
+ * @retval  int32_t  INT16_MAX or 2^23 - 1; the minimum is -max - 1
+ */
+static int32_t ws_v2_max_raw(const ws_v2_channel_t *ch) {
+  return (ch->width == 2U) ? 32767 : 8388607;
+}
+
+/**
+ * @brief   Converts a value to v2 raw counts, saturating at the wire width
+ * @param   value  Channel value in channel units (must be finite)
+ * @param   ch     Channel encoding
+ * @retval  int32_t  Rounded raw counts
+ */
+static int32_t ws_v2_quantize(float value, const ws_v2_channel_t *ch) {
+  const int32_t max_raw = ws_v2_max_raw(ch);
+  const int32_t min_raw = -max_raw - 1;
+  float scaled = value * ch->scale;
+
+  if (scaled >= (float)max_raw) {
+    return max_raw;
+  }
+  if (scaled <= (float)min_raw) {
+    return min_raw;
+  }
+  /* Round half away from zero; the fraction is exact, unlike scaled + 0.5f. */
+  int32_t raw = (int32_t)scaled;
+  float frac = scaled - (float)raw;
+  if (frac >= 0.5f) {
+    raw++;
+  } else if (frac <= -0.5f) {
+    raw--;
+  }
+  return raw;
+}
+
+/**
+ * @brief   Reads a little-endian two's complement value of @p width bytes
+ * @param   src    Source bytes
+ * @param   width  2 or 3
+ * @retval  int32_t  Sign-extended raw counts
+ */
+static int32_t ws_v2_read_raw(const uint8_t *src, uint8_t width) {
+  uint32_t raw = 0U;
+  for (uint8_t b = 0U; b < width; b++) {
+    raw |= (uint32_t)src[b] << (8U * b);
+  }
+  uint32_t sign = 1UL << ((8U * width) - 1U);
+  return (int32_t)(raw ^ sign) - (int32_t)sign;
+}
+
+/**
+ * @brief   Decodes the v1 body (records after the 3-byte header)
+ * @param   buf  Source frame starting with the version byte
+ * @param   len  Frame length in bytes
+ * @param   out  Destination readings structure
+ * @retval  true     Frame complete
+ * @retval  false    Record count too large or frame truncated
+ */
+static bool ws_decode_v1(const uint8_t *buf, uint8_t len, WS_Readings_t *out) {
+  uint8_t count = buf[2];
+  if (count > WS_PROTOCOL_V1_MAX_READINGS) {
+    return false;
+  }
+
+  uint8_t needed = WS_Protocol_MaxEncodedSize(count);
+  if (len < needed) {
+    return false;
+  }
+
+  memset(out, 0, sizeof(*out));
+  out->sensor_status = buf[1];
+  out->count = count;
+
+  for (uint8_t i = 0U; i < count; i++) {
+    uint8_t off = (uint8_t)(WS_PROTOCOL_HEADER_SIZE + (i * WS_PROTOCOL_RECORD_SIZE));
+    out->readings[i].channel_id = buf[off];
+    memcpy(&out->readings[i].value, &buf[off + 1U], sizeof(float));
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Quantizes readings to v2 raw counts indexed by channel_id - 1
+ * @param   in    Source readings (any channel order)
+ * @param   mask  Receives the channel bitmap
+ * @param   raw   Receives raw counts for every channel set in @p mask
+ * @retval  true  All readings valid
+ * @retval  false Too many readings, unknown or duplicate channel id, or non-finite value
+ */
+static bool ws_v2_quantize_all(const WS_Readings_t *in, uint8_t *mask, int32_t raw[WS_CH_MAX]) {
+  if (in->count > WS_MAX_READINGS) {
+    return false;
+  }
+
+  *mask = 0U;
+  for (uint8_t i = 0U; i < in->count; i++) {
+    uint8_t channel_id = in->readings[i].channel_id;
+    float value = in->readings[i].value;
+    if ((channel_id == 0U) || (channel_id > WS_CH_MAX) || !isfinite(value)) {
+      return false;
+    }
+    uint8_t bit = (uint8_t)(1U << (channel_id - 1U));
+    if ((*mask & bit) != 0U) {
+      return false;
+    }
+    *mask |= bit;
+    raw[channel_id - 1U] = ws_v2_quantize(value, &WS_V2_CHANNELS[channel_id - 1U]);
+  }
+  return true;
+}
+
+/**
+ * @brief   Writes v2 values for every channel in @p mask, in channel order
+ * @param   mask  Channel bitmap
+ * @param   raw   Raw counts indexed by channel_id - 1
+ * @param   dst   Destination (WS_Protocol_V2EncodedSize(mask) - header bytes)
+ */
+static void ws_v2_write_values(uint8_t mask, const int32_t raw[WS_CH_MAX], uint8_t *dst) {
+  uint8_t off = 0U;
+  for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+    if ((mask & (uint8_t)(1U << idx)) == 0U) {
+      continue;
+    }
+    const ws_v2_channel_t *ch = &WS_V2_CHANNELS[idx];
+    for (uint8_t b = 0U; b < ch->width; b++) {
+      dst[off + b] = (uint8_t)((uint32_t)raw[idx] >> (8U * b));
+    }
+    off = (uint8_t)(off + ch->width);
+  }
+}
+
+/**
+ * @brief   Reads v2 values for every channel in @p mask, in channel order
+ * @param   mask  Channel bitmap
+ * @param   src   Source bytes following the frame header
+ * @param   raw   Receives raw counts indexed by channel_id - 1
+ */
+static void ws_v2_read_values(uint8_t mask, const uint8_t *src, int32_t raw[WS_CH_MAX]) {
+  uint8_t off = 0U;
+  for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+    if ((mask & (uint8_t)(1U << idx)) == 0U) {
+      continue;
+    }
+    raw[idx] = ws_v2_read_raw(&src[off], WS_V2_CHANNELS[idx].width);
+    off = (uint8_t)(off + WS_V2_CHANNELS[idx].width);
+  }
+}
+
+/**
+ * @brief   Converts raw counts back to readings in ascending channel order
+ * @param   sensor_status  Sensor status byte from the frame header
+ * @param   mask           Channel bitmap
+ * @param   raw            Raw counts indexed by channel_id - 1
+ * @param   out            Destination readings structure
+ */
+static void ws_v2_to_readings(uint8_t sensor_status, uint8_t mask, const int32_t raw[WS_CH_MAX],
+                              WS_Readings_t *out) {
+  memset(out, 0, sizeof(*out));
+  out->sensor_status = sensor_status;
+  for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+    if ((mask & (uint8_t)(1U << idx)) == 0U) {
+      continue;
+    }
+    out->readings[out->count].channel_id = (uint8_t)(idx + 1U);
+    out->readings[out->count].value = (float)raw[idx] / WS_V2_CHANNELS[idx].scale;
+    out->count++;
+  }
+}
+
+/**
+ * @brief   Counts channels in a bitmap (or nodes in a WS_NodeMask_t)
+ * @param   mask  Channel bitmap or node mask
+ * @retval  uint8_t  Number of set bits
+ */
+static uint8_t ws_mask_count(uint32_t mask) {
+  uint8_t count = 0U;
+  while (mask != 0U) {
+    mask &= mask - 1U;
+    count++;
+  }
+  return count;
+}
+
+/**
+ * @brief   Decodes the v2 body (fixed-point values selected by the bitmap)
+ * @param   buf  Source frame starting with the version byte
+ * @param   len  Frame length in bytes
+ * @param   out  Destination readings structure
+ * @retval  true     Frame complete
+ * @retval  false    Frame truncated
+ */
+static bool ws_decode_v2(const uint8_t *buf, uint8_t len, WS_Readings_t *out) {
+  uint8_t mask = buf[2];
+  int32_t raw[WS_CH_MAX];
+  if (len < WS_Protocol_V2EncodedSize(mask)) {
+    return false;
+  }
+
+  ws_v2_read_values(mask, &buf[WS_PROTOCOL_V2_HEADER_SIZE], raw);
+  ws_v2_to_readings(buf[1], mask, raw, out);
+  return true;
+}
+
+/* ============================================================================
+ * Measurement payload encode/decode
+ * ============================================================================ */
+
+/**
+ * @brief   Calculates encoded v1 frame size for a given reading count
+ * @param   count  Number of readings (clamped to WS_PROTOCOL_V1_MAX_READINGS)
  * @retval  uint8_t  Required buffer size in bytes
  */
 uint8_t WS_Protocol_MaxEncodedSize(uint8_t count) {
-  if (count > WS_MAX_READINGS) {
-    count = WS_MAX_READINGS;
+  if (count > WS_PROTOCOL_V1_MAX_READINGS) {
+    count = WS_PROTOCOL_V1_MAX_READINGS;
   }
   return (uint8_t)(WS_PROTOCOL_HEADER_SIZE + (count * WS_PROTOCOL_RECORD_SIZE));
 }
 
 /**
- * @brief   Encodes readings into binary wire format
+ * @brief   Encodes readings into binary wire format v1 (float records)
  * @param   in       Source readings structure
  * @param   buf      Destination buffer
  * @param   buf_size Buffer capacity
  * @param   out_len  Receives encoded length on success
  * @retval  true     Encoding successful
- * @retval  false    Invalid parameters or buffer too small
+ * @retval  false    Invalid parameters, more than WS_PROTOCOL_V1_MAX_READINGS
+ *                   readings, or buffer too small
  */
 bool WS_Protocol_Encode(const WS_Readings_t *in, uint8_t *buf, uint8_t buf_size, uint8_t *out_len) {
-  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || (in->count > WS_MAX_READINGS)) {
+  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || (in->count > WS_PROTOCOL_V1_MAX_READINGS)) {
     return false;
   }
 
@@ -54,45 +297,426 @@ bool WS_Protocol_Encode(const WS_Readings_t *in, uint8_t *buf, uint8_t buf_size,
 }
 
 /**
- * @brief   Decodes binary wire format into readings structure
+ * @brief   Calculates encoded v2 frame size for a channel bitmap
+ * @param   channel_mask  Bit N set for channel id N+1
+ * @retval  uint8_t       Required buffer size in bytes
+ */
+uint8_t WS_Protocol_V2EncodedSize(uint8_t channel_mask) {
+  uint8_t size = WS_PROTOCOL_V2_HEADER_SIZE;
+  for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+    if ((channel_mask & (uint8_t)(1U << idx)) != 0U) {
+      size = (uint8_t)(size + WS_V2_CHANNELS[idx].width);
+    }
+  }
+  return size;
+}
+
+/**
+ * @brief   Encodes readings into binary wire format v2 (fixed-point, bitmap)
+ * @param   in       Source readings structure (any channel order)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Encoding successful; values outside a channel's range saturate
+ * @retval  false    Invalid parameters, unknown or duplicate channel id,
+ *                   non-finite value, or buffer too small
+ */
+bool WS_Protocol_EncodeV2(const WS_Readings_t *in, uint8_t *buf, uint8_t buf_size, uint8_t *out_len) {
+  uint8_t mask = 0U;
+  int32_t raw[WS_CH_MAX];
+  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || !ws_v2_quantize_all(in, &mask, raw)) {
+    return false;
+  }
+
+  uint8_t needed = WS_Protocol_V2EncodedSize(mask);
+  if (buf_size < needed) {
+    return false;
+  }
+
+  buf[0] = WS_PROTOCOL_VERSION_V2;
+  buf[1] = in->sensor_status;
+  buf[2] = mask;
+  ws_v2_write_values(mask, raw, &buf[WS_PROTOCOL_V2_HEADER_SIZE]);
+
+  *out_len = needed;
+  return true;
+}
+
+/**
+ * @brief   Decodes a v1 or v2 binary frame into readings structure
  * @param   buf  Source buffer
  * @param   len  Buffer length in bytes
- * @param   out  Destination readings structure
+ * @param   out  Destination readings structure (v2: ascending channel order)
  * @retval  true     Decoding successful
- * @retval  false    Invalid parameters, version mismatch, or truncated frame
+ * @retval  false    Invalid parameters, unknown version, or truncated frame
  */
 bool WS_Protocol_Decode(const uint8_t *buf, uint8_t len, WS_Readings_t *out) {
   if ((buf == NULL) || (out == NULL) || (len < WS_PROTOCOL_HEADER_SIZE)) {
     return false;
   }
 
-  if (buf[0] != WS_PROTOCOL_VERSION) {
+  switch (buf[0]) {
+    case WS_PROTOCOL_VERSION:
+      return ws_decode_v1(buf, len, out);
+    case WS_PROTOCOL_VERSION_V2:
+      return ws_decode_v2(buf, len, out);
+    default:
+      return false;
+  }
+}
+
+/* ============================================================================
+ * Keyframe / delta frames
+ * ============================================================================ */
+
+/**
+ * @brief   Encodes a keyframe (v2 values tagged with a key sequence number)
+ * @param   in       Source readings structure (any channel order)
+ * @param   key_seq  Key sequence number later deltas refer to (e.g. cycle id)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @param   key      Receives the reference state for WS_Protocol_EncodeDelta;
+ *                   adopt it only once the receiver acknowledged the frame
+ * @retval  true     Keyframe encoded
+ * @retval  false    Invalid parameters or readings (see WS_Protocol_EncodeV2)
+ */
+bool WS_Protocol_EncodeKeyframe(const WS_Readings_t *in, uint8_t key_seq, uint8_t *buf,
+                                uint8_t buf_size, uint8_t *out_len, WS_DeltaKey_t *key) {
+  uint8_t mask = 0U;
+  int32_t raw[WS_CH_MAX] = {0};
+  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || (key == NULL) ||
+      !ws_v2_quantize_all(in, &mask, raw)) {
     return false;
   }
 
-  uint8_t count = buf[2];
-  if (count > WS_MAX_READINGS) {
+  uint8_t needed = (uint8_t)(WS_Protocol_V2EncodedSize(mask) + 1U);
+  if (buf_size < needed) {
     return false;
   }
 
-  uint8_t needed = WS_Protocol_MaxEncodedSize(count);
-  if (len < needed) {
+  buf[0] = WS_PROTOCOL_VERSION_KEY;
+  buf[1] = in->sensor_status;
+  buf[2] = key_seq;
+  buf[3] = mask;
+  ws_v2_write_values(mask, raw, &buf[WS_PROTOCOL_KEY_HEADER_SIZE]);
+
+  key->valid = 1U;
+  key->key_seq = key_seq;
+  key->channel_mask = mask;
+  memcpy(key->raw, raw, sizeof(key->raw));
+
+  *out_len = needed;
+  return true;
+}
+
+/**
+ * @brief   Encodes readings as int8 deltas against an acknowledged keyframe
+ * @param   in       Source readings structure (any channel order)
+ * @param   key      Reference state from WS_Protocol_EncodeKeyframe
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Delta frame encoded
+ * @retval  false    No valid key, channel set changed, a delta exceeds int8,
+ *                   or buffer too small — send a keyframe instead
+ */
+bool WS_Protocol_EncodeDelta(const WS_Readings_t *in, const WS_DeltaKey_t *key, uint8_t *buf,
+                             uint8_t buf_size, uint8_t *out_len) {
+  uint8_t mask = 0U;
+  int32_t raw[WS_CH_MAX];
+  if ((in == NULL) || (key == NULL) || (buf == NULL) || (out_len == NULL) || (key->valid == 0U) ||
+      !ws_v2_quantize_all(in, &mask, raw) || (mask != key->channel_mask)) {
     return false;
   }
 
-  memset(out, 0, sizeof(*out));
-  out->sensor_status = buf[1];
-  out->count = count;
+  uint8_t needed = (uint8_t)(WS_PROTOCOL_KEY_HEADER_SIZE + ws_mask_count(mask));
+  if (buf_size < needed) {
+    return false;
+  }
+
+  uint8_t off = WS_PROTOCOL_KEY_HEADER_SIZE;
+  for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+    if ((mask & (uint8_t)(1U << idx)) == 0U) {
+      continue;
+    }
+    int32_t delta = raw[idx] - key->raw[idx];
+    if ((delta < -128) || (delta > 127)) {
+      return false;
+    }
+    buf[off++] = (uint8_t)(int8_t)delta;
+  }
+
+  buf[0] = WS_PROTOCOL_VERSION_DELTA;
+  buf[1] = in->sensor_status;
+  buf[2] = key->key_seq;
+  buf[3] = mask;
+
+  *out_len = needed;
+  return true;
+}
+
+/**
+ * @brief   Decodes any frame type, tracking keyframe state for delta frames
+ * @param   buf  Source buffer
+ * @param   len  Buffer length in bytes
+ * @param   key  Per-sender reference state; updated by keyframes
+ * @param   out  Destination readings structure
+ * @retval  true     Decoding successful
+ * @retval  false    Invalid or truncated frame, or a delta frame whose
+ *                   keyframe is unknown (request a keyframe from the sender)
+ */
+bool WS_Protocol_DecodeKeyed(const uint8_t *buf, uint8_t len, WS_DeltaKey_t *key, WS_Readings_t *out) {
+  if ((buf == NULL) || (key == NULL) || (out == NULL) || (len < WS_PROTOCOL_KEY_HEADER_SIZE)) {
+    return WS_Protocol_Decode(buf, len, out);
+  }
+
+  uint8_t mask = buf[3];
+  int32_t raw[WS_CH_MAX] = {0};
+
+  if (buf[0] == WS_PROTOCOL_VERSION_KEY) {
+    if (len < (uint8_t)(WS_Protocol_V2EncodedSize(mask) + 1U)) {
+      return false;
+    }
+    ws_v2_read_values(mask, &buf[WS_PROTOCOL_KEY_HEADER_SIZE], raw);
+    key->valid = 1U;
+    key->key_seq = buf[2];
+    key->channel_mask = mask;
+    memcpy(key->raw, raw, sizeof(key->raw));
+    ws_v2_to_readings(buf[1], mask, raw, out);
+    return true;
+  }
+
+  if (buf[0] == WS_PROTOCOL_VERSION_DELTA) {
+    if ((key->valid == 0U) || (key->key_seq != buf[2]) || (key->channel_mask != mask) ||
+        (len < (uint8_t)(WS_PROTOCOL_KEY_HEADER_SIZE + ws_mask_count(mask)))) {
+      return false;
+    }
+    uint8_t off = WS_PROTOCOL_KEY_HEADER_SIZE;
+    for (uint8_t idx = 0U; idx < WS_CH_MAX; idx++) {
+      if ((mask & (uint8_t)(1U << idx)) == 0U) {
+        continue;
+      }
+      raw[idx] = key->raw[idx] + (int8_t)buf[off++];
+      /* The encoder saturates, so a result outside the wire width is corrupt. */
+      int32_t max_raw = ws_v2_max_raw(&WS_V2_CHANNELS[idx]);
+      if ((raw[idx] > max_raw) || (raw[idx] < (-max_raw - 1))) {
+        return false;
+      }
+    }
+    ws_v2_to_readings(buf[1], mask, raw, out);
+    return true;
+  }
+
+  return WS_Protocol_Decode(buf, len, out);
+}
+
+/* ============================================================================
+ * Backlog frames
+ * ============================================================================ */
+
+/**
+ * @brief   Encodes a buffered (late) measurement with its age
+ * @param   in       Source readings structure (any channel order)
+ * @param   age_s    Seconds since the measurement was taken (saturate at 0xFFFF)
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Backlog frame encoded
+ * @retval  false    Invalid parameters or readings (see WS_Protocol_EncodeV2)
+ */
+bool WS_Protocol_EncodeBacklog(const WS_Readings_t *in, uint16_t age_s, uint8_t *buf,
+                               uint8_t buf_size, uint8_t *out_len) {
+  uint8_t mask = 0U;
+  int32_t raw[WS_CH_MAX];
+  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || !ws_v2_quantize_all(in, &mask, raw)) {
+    return false;
+  }
+
+  uint8_t needed = (uint8_t)(WS_Protocol_V2EncodedSize(mask) +
+                             (WS_PROTOCOL_BACKLOG_HEADER_SIZE - WS_PROTOCOL_V2_HEADER_SIZE));
+  if (buf_size < needed) {
+    return false;
+  }
+
+  buf[0] = WS_PROTOCOL_VERSION_BACKLOG;
+  buf[1] = in->sensor_status;
+  buf[2] = (uint8_t)(age_s & 0xFFU);
+  buf[3] = (uint8_t)(age_s >> 8);
+  buf[4] = mask;
+  ws_v2_write_values(mask, raw, &buf[WS_PROTOCOL_BACKLOG_HEADER_SIZE]);
+
+  *out_len = needed;
+  return true;
+}
+
+/**
+ * @brief   Decodes a backlog frame
+ * @param   buf    Source buffer
+ * @param   len    Buffer length in bytes
+ * @param   age_s  Receives the measurement age in seconds (may be NULL)
+ * @param   out    Destination readings structure (ascending channel order)
+ * @retval  true   Decoding successful
+ * @retval  false  Invalid parameters, not a backlog frame, or truncated
+ */
+bool WS_Protocol_DecodeBacklog(const uint8_t *buf, uint8_t len, uint16_t *age_s, WS_Readings_t *out) {
+  if ((buf == NULL) || (out == NULL) || (len < WS_PROTOCOL_BACKLOG_HEADER_SIZE) ||
+      (buf[0] != WS_PROTOCOL_VERSION_BACKLOG)) {
+    return false;
+  }
+
+  uint8_t mask = buf[4];
+  int32_t raw[WS_CH_MAX];
+  if (len < (uint8_t)(WS_Protocol_V2EncodedSize(mask) +
+                      (WS_PROTOCOL_BACKLOG_HEADER_SIZE - WS_PROTOCOL_V2_HEADER_SIZE))) {
+    return false;
+  }
+
+  ws_v2_read_values(mask, &buf[WS_PROTOCOL_BACKLOG_HEADER_SIZE], raw);
+  ws_v2_to_readings(buf[1], mask, raw, out);
+  if (age_s != NULL) {
+    *age_s = (uint16_t)(buf[2] | ((uint16_t)buf[3] << 8));
+  }
+  return true;
+}
+
+/* ============================================================================
+ * Fragmented replies
+ * ============================================================================ */
+
+/**
+ * @brief   Number of fragment frames needed for @p count readings
+ * @param   count  Number of readings
+ * @retval  uint8_t  Fragment count (at least 1)
+ */
+uint8_t WS_Protocol_FragmentCount(uint8_t count) {
+  if (count == 0U) {
+    return 1U;
+  }
+  return (uint8_t)((count + WS_PROTOCOL_FRAG_MAX_READINGS - 1U) / WS_PROTOCOL_FRAG_MAX_READINGS);
+}
+
+/**
+ * @brief   Encodes fragment @p index of a multi-frame reply
+ * @param   in       Source readings (all fragments are cut from the same set)
+ * @param   seq      Sequence number shared by all fragments (e.g. cycle id)
+ * @param   index    Fragment index, 0 .. WS_Protocol_FragmentCount(in->count) - 1
+ * @param   buf      Destination buffer
+ * @param   buf_size Buffer capacity
+ * @param   out_len  Receives encoded length on success
+ * @retval  true     Fragment encoded
+ * @retval  false    Invalid parameters, index out of range, or buffer too small
+ */
+bool WS_Protocol_EncodeFragment(const WS_Readings_t *in, uint8_t seq, uint8_t index,
+                                uint8_t *buf, uint8_t buf_size, uint8_t *out_len) {
+  if ((in == NULL) || (buf == NULL) || (out_len == NULL) || (in->count > WS_MAX_READINGS)) {
+    return false;
+  }
+
+  uint8_t total = WS_Protocol_FragmentCount(in->count);
+  if ((index >= total) || (total > WS_PROTOCOL_FRAG_MAX_TOTAL)) {
+    return false;
+  }
+
+  uint8_t first = (uint8_t)(index * WS_PROTOCOL_FRAG_MAX_READINGS);
+  uint8_t count = (uint8_t)(in->count - first);
+  if (count > WS_PROTOCOL_FRAG_MAX_READINGS) {
+    count = WS_PROTOCOL_FRAG_MAX_READINGS;
+  }
+
+  uint8_t needed = (uint8_t)(WS_PROTOCOL_FRAG_HEADER_SIZE + (count * WS_PROTOCOL_RECORD_SIZE));
+  if (buf_size < needed) {
+    return false;
+  }
+
+  buf[0] = WS_PROTOCOL_VERSION_FRAG;
+  buf[1] = in->sensor_status;
+  buf[2] = seq;
+  buf[3] = (uint8_t)((index << 4) | total);
+  buf[4] = count;
 
   for (uint8_t i = 0U; i < count; i++) {
-    uint8_t off = (uint8_t)(WS_PROTOCOL_HEADER_SIZE + (i * WS_PROTOCOL_RECORD_SIZE));
-    out->readings[i].channel_id = buf[off];
-    memcpy(&out->readings[i].value, &buf[off + 1U], sizeof(float));
+    uint8_t off = (uint8_t)(WS_PROTOCOL_FRAG_HEADER_SIZE + (i * WS_PROTOCOL_RECORD_SIZE));
+    buf[off] = in->readings[first + i].channel_id;
+    memcpy(&buf[off + 1U], &in->readings[first + i].value, sizeof(float));
   }
 
+  *out_len = needed;
   return true;
 }
 
+/**
+ * @brief   Clears a reassembly buffer
+ * @param   fa  Reassembly buffer
+ */
+void WS_Frag_Reset(WS_FragAssembly_t *fa) {
+  if (fa != NULL) {
+    memset(fa, 0, sizeof(*fa));
+  }
+}
+
+/**
+ * @brief   Feeds a received fragment frame into a reassembly buffer
+ * @param   fa   Reassembly buffer of the sending node
+ * @param   buf  Received frame (version byte must be WS_PROTOCOL_VERSION_FRAG)
+ * @param   len  Frame length in bytes
+ * @retval  WS_FragResult_t  See enum; a new sequence number discards a partial set
+ */
+WS_FragResult_t WS_Frag_Accept(WS_FragAssembly_t *fa, const uint8_t *buf, uint8_t len) {
+  if ((fa == NULL) || (buf == NULL) || (len < WS_PROTOCOL_FRAG_HEADER_SIZE) ||
+      (buf[0] != WS_PROTOCOL_VERSION_FRAG)) {
+    return WS_FRAG_INVALID;
+  }
+
+  uint8_t seq = buf[2];
+  uint8_t index = (uint8_t)(buf[3] >> 4);
+  uint8_t total = (uint8_t)(buf[3] & 0x0FU);
+  uint8_t count = buf[4];
+  uint8_t first = (uint8_t)(index * WS_PROTOCOL_FRAG_MAX_READINGS);
+
+  if ((total == 0U) || (index >= total) || (count > WS_PROTOCOL_FRAG_MAX_READINGS) ||
+      (len < (WS_PROTOCOL_FRAG_HEADER_SIZE + (count * WS_PROTOCOL_RECORD_SIZE))) ||
+      (((index + 1U) < total) && (count != WS_PROTOCOL_FRAG_MAX_READINGS)) ||
+      ((total > 1U) && (count == 0U)) ||
+      ((first + count) > WS_MAX_READINGS)) {
+    return WS_FRAG_INVALID;
+  }
+
+  if ((fa->seq == seq) && (fa->complete != 0U)) {
+    return WS_FRAG_DUPLICATE;
+  }
+  if ((fa->collecting == 0U) || (fa->seq != seq) || (fa->total != total)) {
+    memset(fa, 0, sizeof(*fa));
+    fa->seq = seq;
+    fa->total = total;
+    fa->collecting = 1U;
+  }
+
+  uint16_t bit = (uint16_t)(1U << index);
+  if ((fa->received_mask & bit) != 0U) {
+    return WS_FRAG_DUPLICATE;
+  }
+
+  for (uint8_t i = 0U; i < count; i++) {
+    uint8_t off = (uint8_t)(WS_PROTOCOL_FRAG_HEADER_SIZE + (i * WS_PROTOCOL_RECORD_SIZE));
+    fa->readings.readings[first + i].channel_id = buf[off];
+    memcpy(&fa->readings.readings[first + i].value, &buf[off + 1U], sizeof(float));
+  }
+  fa->readings.sensor_status = buf[1];
+  fa->received_mask |= bit;
+  if ((index + 1U) == total) {
+    fa->readings.count = (uint8_t)(first + count);
+  }
+
+  if (fa->received_mask != (uint16_t)((1UL << total) - 1UL)) {
+    return WS_FRAG_PENDING;
+  }
+
+  fa->collecting = 0U;
+  fa->complete = 1U;
+  return WS_FRAG_COMPLETE;
+}
+
 /**
  * @brief   Looks up a channel value in decoded readings
  * @param   r          Readings structure to search
@@ -183,23 +807,226 @@ bool WS_Protocol_SelfCheck(void) {
     return false;
   }
 
-  if (!WS_Cmd_EncodeMeasureTo(7U, 0x01U, cmd, sizeof(cmd))) {
+  if (!WS_Cmd_EncodeMeasureEx(7U, 0x80000001UL, 0x00010004UL, cmd, sizeof(cmd))) {
     return false;
   }
   {
-    uint8_t mask = 0U;
+    WS_NodeMask_t mask = 0U;
     if (!WS_Cmd_DecodeMeasureEx(cmd, sizeof(cmd), &cycle_id, &mask) ||
-        (cycle_id != 7U) || (mask != 0x01U)) {
+        (cycle_id != 7U) || (mask != 0x80000001UL) || (WS_Cmd_KeyframeMask(cmd, sizeof(cmd)) != 0x00010004UL)) {
+      return false;
+    }
+    if ((WS_Cmd_GetClock(cmd, sizeof(cmd)) != 0U) || !WS_Cmd_SetClock(cmd, sizeof(cmd), 0x12345678UL) ||
+        (WS_Cmd_GetClock(cmd, sizeof(cmd)) != 0x12345678UL) ||
+        (WS_Cmd_KeyframeMask(cmd, sizeof(cmd)) != 0x00010004UL)) {
       return false;
     }
   }
   if (!WS_Cmd_IsDuplicateCycle(7U, 7U, 1U) || WS_Cmd_IsDuplicateCycle(8U, 7U, 1U)) {
     return false;
   }
-  if ((WS_Cycle_ExpectedMask(2U) != 0x03U) || !WS_Cycle_IsComplete(0x03U, 0x03U)) {
+  /* Partial polls never count as a gap; full ids wrap at 128. */
+  if (WS_Cmd_IsCycleGap(8U, 7U, 1U) || !WS_Cmd_IsCycleGap(9U, 7U, 1U) ||
+      WS_Cmd_IsCycleGap((uint8_t)(WS_CMD_CYCLE_PARTIAL | 3U), 7U, 1U) || WS_Cmd_IsCycleGap(0U, 127U, 1U) ||
+      WS_Cmd_IsCycleGap(9U, 7U, 0U)) {
+    return false;
+  }
+  if ((WS_Cycle_ExpectedMask(2U) != 0x03U) || (WS_Cycle_ExpectedMask(32U) != WS_CMD_TARGET_ALL) ||
+      !WS_Cycle_IsComplete(0x03U, 0x03U)) {
+    return false;
+  }
+
+  /* Slots: node 3 of {1, 3, 6} replies second; lead rounds up to 10 ms. */
+  {
+    uint16_t lead_ms = 0U;
+    uint8_t slot_ms = 0U;
+    if (WS_Cmd_GetSlots(cmd, sizeof(cmd), NULL, NULL) || !WS_Cmd_SetSlots(cmd, sizeof(cmd), 495U, 40U) ||
+        !WS_Cmd_GetSlots(cmd, sizeof(cmd), &lead_ms, &slot_ms) || (lead_ms != 500U) || (slot_ms != 40U) ||
+        WS_Cmd_SetSlots(cmd, sizeof(cmd), 2551U, 40U)) {
+      return false;
+    }
+    if ((WS_Cycle_SlotIndex(0x4AU, 0U, 3U) != 1U) || (WS_Cycle_SlotIndex(WS_CMD_TARGET_ALL, 0U, 5U) != 5U) ||
+        (WS_Cycle_WindowMs(0x4AU, lead_ms, slot_ms) != 620U)) {
+      return false;
+    }
+    /* Node 1 is late: 3 and 6 move up, 1 takes the last slot. */
+    if ((WS_Cmd_LateMask(cmd, sizeof(cmd)) != 0U) || !WS_Cmd_SetLateMask(cmd, sizeof(cmd), 0x02U) ||
+        (WS_Cmd_LateMask(cmd, sizeof(cmd)) != 0x02U) || (WS_Cycle_SlotIndex(0x4AU, 0x02U, 3U) != 0U) ||
+        (WS_Cycle_SlotIndex(0x4AU, 0x02U, 6U) != 1U) || (WS_Cycle_SlotIndex(0x4AU, 0x02U, 1U) != 2U)) {
+      return false;
+    }
+    /* Node 20 of {3, 20, 31} replies second; masks above bit 7 survive the wire. */
+    if ((WS_Cycle_SlotIndex(0x80100008UL, 0U, 20U) != 1U) || !WS_Cmd_SetLateMask(cmd, sizeof(cmd), 0x00100000UL) ||
+        (WS_Cmd_LateMask(cmd, sizeof(cmd)) != 0x00100000UL) ||
+        (WS_Cycle_SlotIndex(0x80100008UL, 0x00100000UL, 20U) != 2U)) {
+      return false;
+    }
+  }
+
+  /* Reply envelope: node id in front, frame unchanged behind it. */
+  {
+    const uint8_t frame[3] = {WS_PROTOCOL_VERSION_V2, 0x00U, 0x00U};
+    const uint8_t *inner = NULL;
+    uint8_t node_id = 0U;
+    if (!WS_Reply_Wrap(17U, frame, sizeof(frame), buf, sizeof(buf), &len) || (len != 4U) ||
+        !WS_Reply_Unwrap(buf, len, &node_id, &inner, &len) || (node_id != 17U) || (len != 3U) ||
+        (memcmp(inner, frame, sizeof(frame)) != 0)) {
+      return false;
+    }
+  }
+
+  /* v2: out-of-order input comes back in channel order with fixed-point precision. */
+  in.count = 3U;
+  in.readings[2].channel_id = WS_CH_BME280_HUM;
+  in.readings[2].value = 45.3f;
+  if (!WS_Protocol_EncodeV2(&in, buf, sizeof(buf), &len) ||
+      (len != WS_Protocol_V2EncodedSize(0x89U)) || (buf[2] != 0x89U)) {
+    return false;
+  }
+  if (!WS_Protocol_Decode(buf, len, &out) || (out.count != 3U) ||
+      (out.readings[0].channel_id != WS_CH_SI7021_TEMP) ||
+      (out.readings[2].channel_id != WS_CH_BME280_HUM)) {
+    return false;
+  }
+  if (!WS_Reading_Get(&out, WS_CH_BMP280_PRESS, &press) || (press != 1013.25f) ||
+      !WS_Reading_Get(&out, WS_CH_BME280_HUM, &temp) || (temp != 45.3f)) {
     return false;
   }
 
+  /* v2: non-finite values are rejected rather than saturated. */
+  in.readings[2].value = INFINITY;
+  if (WS_Protocol_EncodeV2(&in, buf, sizeof(buf), &len)) {
+    return false;
+  }
+  in.readings[2].value = -INFINITY;
+  if (WS_Protocol_EncodeV2(&in, buf, sizeof(buf), &len)) {
+    return false;
+  }
+
+  /* Fragments: 7 readings in 2 frames, delivered out of order and repeated. */
+  {
+    WS_FragAssembly_t fa;
+    uint8_t frag0[WS_PROTOCOL_MAX_PAYLOAD];
+    uint8_t len0 = 0U;
+    in.count = 7U;
+    for (uint8_t i = 0U; i < in.count; i++) {
+      in.readings[i].channel_id = (uint8_t)(i + 1U);
+      in.readings[i].value = (float)i;
+    }
+    WS_Frag_Reset(&fa);
+    if ((WS_Protocol_FragmentCount(in.count) != 2U) ||
+        !WS_Protocol_EncodeFragment(&in, 9U, 0U, frag0, sizeof(frag0), &len0) ||
+        !WS_Protocol_EncodeFragment(&in, 9U, 1U, buf, sizeof(buf), &len)) {
+      return false;
+    }
+    if ((WS_Frag_Accept(&fa, buf, len) != WS_FRAG_PENDING) ||
+        (WS_Frag_Accept(&fa, buf, len) != WS_FRAG_DUPLICATE) ||
+        (WS_Frag_Accept(&fa, frag0, len0) != WS_FRAG_COMPLETE) ||
+        (WS_Frag_Accept(&fa, frag0, len0) != WS_FRAG_DUPLICATE) ||
+        (fa.readings.count != 7U) ||
+        !WS_Reading_Get(&fa.readings, 7U, &temp) || (temp != 6.0f)) {
+      return false;
+    }
+  }
+
+  /* Keyframe then delta: the receiver rebuilds values from its copy of the key. */
+  {
+    WS_DeltaKey_t tx_key;
+    WS_DeltaKey_t rx_key;
+    memset(&rx_key, 0, sizeof(rx_key));
+    in.count = 2U;
+    in.readings[0].channel_id = WS_CH_SI7021_TEMP;
+    in.readings[0].value = 21.5f;
+    in.readings[1].channel_id = WS_CH_BMP280_PRESS;
+    in.readings[1].value = 1013.25f;
+    if (!WS_Protocol_EncodeKeyframe(&in, 11U, buf, sizeof(buf), &len, &tx_key) ||
+        !WS_Protocol_DecodeKeyed(buf, len, &rx_key, &out) || (rx_key.key_seq != 11U)) {
+      return false;
+    }
+    in.readings[0].value = 21.75f;
+    in.readings[1].value = 1012.5f;
+    if (!WS_Protocol_EncodeDelta(&in, &tx_key, buf, sizeof(buf), &len) ||
+        (len != (WS_PROTOCOL_KEY_HEADER_SIZE + 2U)) ||
+        !WS_Protocol_DecodeKeyed(buf, len, &rx_key, &out) ||
+        !WS_Reading_Get(&out, WS_CH_SI7021_TEMP, &temp) || (temp != 21.75f) ||
+        !WS_Reading_Get(&out, WS_CH_BMP280_PRESS, &press) || (press != 1012.5f)) {
+      return false;
+    }
+    /* A delta against a key the receiver never saw must be rejected. */
+    rx_key.key_seq = 12U;
+    if (WS_Protocol_DecodeKeyed(buf, len, &rx_key, &out)) {
+      return false;
+    }
+    in.readings[1].value = 1020.0f;
+    if (WS_Protocol_EncodeDelta(&in, &tx_key, buf, sizeof(buf), &len)) {
+      return false;
+    }
+  }
+
+  /* Backlog: age survives, and a live decoder must not mistake it for fresh data. */
+  {
+    uint16_t age_s = 0U;
+    if (!WS_Protocol_EncodeBacklog(&in, 300U, buf, sizeof(buf), &len) ||
+        WS_Protocol_Decode(buf, len, &out) ||
+        !WS_Protocol_DecodeBacklog(buf, len, &age_s, &out) || (age_s != 300U) ||
+        !WS_Reading_Get(&out, WS_CH_SI7021_TEMP, &temp) || (temp != 21.75f)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* ============================================================================
+ * Reply envelope
+ * ============================================================================ */
+
+/**
+ * @brief   Prefixes an encoded frame with the sender's node id
+ * @param   node_id    NODE_ID of the sending node
+ * @param   frame      Encoded frame (any WS_PROTOCOL_VERSION_*)
+ * @param   frame_len  Frame length, at most WS_PROTOCOL_MAX_FRAME
+ * @param   buf        Destination buffer (must not overlap @p frame)
+ * @param   buf_size   Buffer capacity
+ * @param   out_len    Receives the payload length on success
+ * @retval  true       Envelope written
+ * @retval  false      Invalid parameters, frame too long, or buffer too small
+ */
+bool WS_Reply_Wrap(uint8_t node_id, const uint8_t *frame, uint8_t frame_len, uint8_t *buf,
+                   uint8_t buf_size, uint8_t *out_len) {
+  if ((frame == NULL) || (buf == NULL) || (out_len == NULL) || (frame_len == 0U) ||
+      (frame_len > WS_PROTOCOL_MAX_FRAME) || (buf_size < (frame_len + WS_PROTOCOL_REPLY_HEADER_SIZE))) {
+    return false;
+  }
+
+  buf[0] = node_id;
+  memcpy(&buf[WS_PROTOCOL_REPLY_HEADER_SIZE], frame, frame_len);
+  *out_len = (uint8_t)(frame_len + WS_PROTOCOL_REPLY_HEADER_SIZE);
+  return true;
+}
+
+/**
+ * @brief   Splits a received reply payload into node id and frame
+ * @param   buf            Received payload
+ * @param   len            Payload length in bytes
+ * @param   out_node_id    Receives the sender's NODE_ID (may be NULL)
+ * @param   out_frame      Receives a pointer to the frame inside @p buf
+ * @param   out_frame_len  Receives the frame length
+ * @retval  true           Payload carries a node id and a non-empty frame
+ * @retval  false          Invalid parameters or payload too short
+ */
+bool WS_Reply_Unwrap(const uint8_t *buf, uint8_t len, uint8_t *out_node_id, const uint8_t **out_frame,
+                     uint8_t *out_frame_len) {
+  if ((buf == NULL) || (out_frame == NULL) || (out_frame_len == NULL) ||
+      (len <= WS_PROTOCOL_REPLY_HEADER_SIZE)) {
+    return false;
+  }
+
+  if (out_node_id != NULL) {
+    *out_node_id = buf[0];
+  }
+  *out_frame = &buf[WS_PROTOCOL_REPLY_HEADER_SIZE];
+  *out_frame_len = (uint8_t)(len - WS_PROTOCOL_REPLY_HEADER_SIZE);
   return true;
 }
 
@@ -208,7 +1035,31 @@ bool WS_Protocol_SelfCheck(void) {
  * ============================================================================ */
 
 /**
- * @brief   Encodes a broadcast measure command into an 8-byte nRF24 payload
+ * @brief   Writes a 32-bit value little-endian
+ * @param   dst    Destination (4 bytes)
+ * @param   value  Value to write
+ */
+static void ws_put_le32(uint8_t *dst, uint32_t value) {
+  for (uint8_t b = 0U; b < 4U; b++) {
+    dst[b] = (uint8_t)(value >> (8U * b));
+  }
+}
+
+/**
+ * @brief   Reads a 32-bit little-endian value
+ * @param   src  Source (4 bytes)
+ * @retval  uint32_t  Decoded value
+ */
+static uint32_t ws_get_le32(const uint8_t *src) {
+  uint32_t value = 0U;
+  for (uint8_t b = 0U; b < 4U; b++) {
+    value |= (uint32_t)src[b] << (8U * b);
+  }
+  return value;
+}
+
+/**
+ * @brief   Encodes a broadcast measure command into a WS_CMD_SIZE nRF24 payload
  * @param   cycle_id  Measurement cycle identifier (0–255, wraps)
  * @param   buf       Destination buffer (must be at least WS_CMD_SIZE bytes)
  * @param   buf_size  Capacity of @p buf
@@ -228,7 +1079,22 @@ bool WS_Cmd_EncodeMeasure(uint8_t cycle_id, uint8_t *buf, uint8_t buf_size) {
  * @retval  true         Command encoded
  * @retval  false        Invalid buffer or insufficient size
  */
-bool WS_Cmd_EncodeMeasureTo(uint8_t cycle_id, uint8_t target_mask, uint8_t *buf, uint8_t buf_size) {
+bool WS_Cmd_EncodeMeasureTo(uint8_t cycle_id, WS_NodeMask_t target_mask, uint8_t *buf, uint8_t buf_size) {
+  return WS_Cmd_EncodeMeasureEx(cycle_id, target_mask, 0U, buf, buf_size);
+}
+
+/**
+ * @brief   Encodes a measure command with target and keyframe request masks
+ * @param   cycle_id       Measurement cycle identifier
+ * @param   target_mask    Bit N set selects NODE_ID N; WS_CMD_TARGET_ALL = all nodes
+ * @param   keyframe_mask  Bit N set asks NODE_ID N to reply with a keyframe
+ * @param   buf            Destination buffer (must be at least WS_CMD_SIZE bytes)
+ * @param   buf_size       Capacity of @p buf
+ * @retval  true           Command encoded
+ * @retval  false          Invalid buffer or insufficient size
+ */
+bool WS_Cmd_EncodeMeasureEx(uint8_t cycle_id, WS_NodeMask_t target_mask, WS_NodeMask_t keyframe_mask,
+                            uint8_t *buf, uint8_t buf_size) {
   if ((buf == NULL) || (buf_size < WS_CMD_SIZE)) {
     return false;
   }
@@ -236,7 +1102,8 @@ bool WS_Cmd_EncodeMeasureTo(uint8_t cycle_id, uint8_t target_mask, uint8_t *buf,
   memset(buf, 0, WS_CMD_SIZE);
   buf[0] = WS_CMD_MEASURE;
   buf[WS_CMD_CYCLE_ID_OFFSET] = cycle_id;
-  buf[WS_CMD_TARGET_MASK_OFFSET] = target_mask;
+  ws_put_le32(&buf[WS_CMD_TARGET_MASK_OFFSET], target_mask);
+  ws_put_le32(&buf[WS_CMD_KEYFRAME_MASK_OFFSET], keyframe_mask);
   return true;
 }
 
@@ -262,7 +1129,7 @@ bool WS_Cmd_DecodeMeasure(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id
  * @retval  true             Valid WS_CMD_MEASURE frame
  * @retval  false            NULL buffer, too short, or wrong command byte
  */
-bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id, uint8_t *out_target_mask) {
+bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_id, WS_NodeMask_t *out_target_mask) {
   if ((buf == NULL) || (len < 2U) || (buf[0] != WS_CMD_MEASURE)) {
     return false;
   }
@@ -271,7 +1138,8 @@ bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_
     *out_cycle_id = buf[WS_CMD_CYCLE_ID_OFFSET];
   }
   if (out_target_mask != NULL) {
-    *out_target_mask = (len > WS_CMD_TARGET_MASK_OFFSET) ? buf[WS_CMD_TARGET_MASK_OFFSET] : WS_CMD_TARGET_ALL;
+    *out_target_mask = (len >= (WS_CMD_TARGET_MASK_OFFSET + 4U)) ? ws_get_le32(&buf[WS_CMD_TARGET_MASK_OFFSET])
+                                                                 : WS_CMD_TARGET_ALL;
     if (*out_target_mask == 0U) {
       *out_target_mask = WS_CMD_TARGET_ALL;
     }
@@ -279,6 +1147,122 @@ bool WS_Cmd_DecodeMeasureEx(const uint8_t *buf, uint8_t len, uint8_t *out_cycle_
   return true;
 }
 
+/**
+ * @brief   Reads the keyframe request mask of a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  WS_NodeMask_t  Bit N set when NODE_ID N must send a keyframe; 0 when absent
+ */
+WS_NodeMask_t WS_Cmd_KeyframeMask(const uint8_t *buf, uint8_t len) {
+  if ((buf == NULL) || (len < (WS_CMD_KEYFRAME_MASK_OFFSET + 4U))) {
+    return 0U;
+  }
+  return ws_get_le32(&buf[WS_CMD_KEYFRAME_MASK_OFFSET]);
+}
+
+/**
+ * @brief   Stamps the sender's clock into an encoded measure command
+ * @param   buf       Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size  Capacity of @p buf
+ * @param   clock_s   Indoor clock in seconds (0 = unknown)
+ * @retval  true      Clock written
+ * @retval  false     Invalid buffer or insufficient size
+ */
+bool WS_Cmd_SetClock(uint8_t *buf, uint8_t buf_size, uint32_t clock_s) {
+  if ((buf == NULL) || (buf_size < WS_CMD_SIZE)) {
+    return false;
+  }
+
+  ws_put_le32(&buf[WS_CMD_CLOCK_OFFSET], clock_s);
+  return true;
+}
+
+/**
+ * @brief   Reads the sender's clock from a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  uint32_t  Indoor clock in seconds; 0 when absent or unknown
+ */
+uint32_t WS_Cmd_GetClock(const uint8_t *buf, uint8_t len) {
+  if ((buf == NULL) || (len < (WS_CMD_CLOCK_OFFSET + 4U))) {
+    return 0U;
+  }
+  return ws_get_le32(&buf[WS_CMD_CLOCK_OFFSET]);
+}
+
+/**
+ * @brief   Writes the reply slot schedule into an encoded measure command
+ * @param   buf       Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size  Capacity of @p buf
+ * @param   lead_ms   Delay from command to the first slot (rounded up to WS_CMD_LEAD_UNIT_MS)
+ * @param   slot_ms   Length of every slot; 0 clears the schedule
+ * @retval  true      Schedule written
+ * @retval  false     Invalid buffer, insufficient size, or @p lead_ms too large
+ */
+bool WS_Cmd_SetSlots(uint8_t *buf, uint8_t buf_size, uint16_t lead_ms, uint8_t slot_ms) {
+  uint32_t lead = ((uint32_t)lead_ms + WS_CMD_LEAD_UNIT_MS - 1U) / WS_CMD_LEAD_UNIT_MS;
+  if ((buf == NULL) || (buf_size < WS_CMD_SIZE) || (lead > 0xFFU)) {
+    return false;
+  }
+
+  buf[WS_CMD_SLOT_LEAD_OFFSET] = (slot_ms != 0U) ? (uint8_t)lead : 0U;
+  buf[WS_CMD_SLOT_LEN_OFFSET] = slot_ms;
+  return true;
+}
+
+/**
+ * @brief   Reads the reply slot schedule from a measure command
+ * @param   buf          Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len          Buffer length in bytes
+ * @param   out_lead_ms  Receives the delay to the first slot (may be NULL)
+ * @param   out_slot_ms  Receives the slot length (may be NULL)
+ * @retval  true         Command carries a schedule
+ * @retval  false        Fields absent or slot length 0 (node picks its own delay)
+ */
+bool WS_Cmd_GetSlots(const uint8_t *buf, uint8_t len, uint16_t *out_lead_ms, uint8_t *out_slot_ms) {
+  if ((buf == NULL) || (len <= WS_CMD_SLOT_LEN_OFFSET) || (buf[WS_CMD_SLOT_LEN_OFFSET] == 0U)) {
+    return false;
+  }
+
+  if (out_lead_ms != NULL) {
+    *out_lead_ms = (uint16_t)(buf[WS_CMD_SLOT_LEAD_OFFSET] * WS_CMD_LEAD_UNIT_MS);
+  }
+  if (out_slot_ms != NULL) {
+    *out_slot_ms = buf[WS_CMD_SLOT_LEN_OFFSET];
+  }
+  return true;
+}
+
+/**
+ * @brief   Writes the late slot mask into an encoded measure command
+ * @param   buf        Command buffer from WS_Cmd_EncodeMeasureEx
+ * @param   buf_size   Capacity of @p buf
+ * @param   late_mask  Bit N set moves NODE_ID N behind every node not in the mask
+ * @retval  true       Mask written
+ * @retval  false      Invalid buffer or insufficient size
+ */
+bool WS_Cmd_SetLateMask(uint8_t *buf, uint8_t buf_size, WS_NodeMask_t late_mask) {
+  if ((buf == NULL) || (buf_size < WS_CMD_SIZE)) {
+    return false;
+  }
+
+  ws_put_le32(&buf[WS_CMD_SLOT_LATE_OFFSET], late_mask);
+  return true;
+}
+
+/**
+ * @brief   Reads the late slot mask of a measure command
+ * @param   buf  Source command buffer (already validated by WS_Cmd_DecodeMeasureEx)
+ * @param   len  Buffer length in bytes
+ * @retval  WS_NodeMask_t  Bit N set when NODE_ID N replies after the others; 0 when absent
+ */
+WS_NodeMask_t WS_Cmd_LateMask(const uint8_t *buf, uint8_t len) {
+  if ((buf == NULL) || (len < (WS_CMD_SLOT_LATE_OFFSET + 4U))) {
+    return 0U;
+  }
+  return ws_get_le32(&buf[WS_CMD_SLOT_LATE_OFFSET]);
+}
+
 /**
  * @brief   Detects a duplicate measurement cycle id
  * @param   cycle_id       Incoming cycle id from command payload
@@ -291,19 +1275,34 @@ bool WS_Cmd_IsDuplicateCycle(uint8_t cycle_id, uint8_t last_cycle_id, uint8_t ha
   return (have_last != 0U) && (cycle_id == last_cycle_id);
 }
 
+/**
+ * @brief   Detects a missed full measurement cycle
+ * @param   cycle_id      Incoming cycle id from command payload
+ * @param   last_full_id  Last accepted full-cycle id
+ * @param   have_last     Non-zero when @p last_full_id is valid
+ * @retval  true          Full-cycle id that does not follow @p last_full_id
+ * @retval  false         Partial poll (WS_CMD_CYCLE_PARTIAL), first cycle, or next id
+ */
+bool WS_Cmd_IsCycleGap(uint8_t cycle_id, uint8_t last_full_id, uint8_t have_last) {
+  if ((have_last == 0U) || ((cycle_id & WS_CMD_CYCLE_PARTIAL) != 0U)) {
+    return false;
+  }
+  return cycle_id != (uint8_t)((last_full_id + 1U) & WS_CMD_CYCLE_SEQ_MASK);
+}
+
 /**
  * @brief   Builds the expected response bitmask for a parallel measurement cycle
- * @param   node_count  Number of outdoor nodes (0–8)
- * @retval  uint8_t     Bit mask with bits 0..(node_count-1) set; 0xFF when node_count >= 8
+ * @param   node_count  Number of outdoor nodes (0–WS_NODE_MASK_BITS)
+ * @retval  WS_NodeMask_t  Bits 0..(node_count-1) set; all bits when node_count >= WS_NODE_MASK_BITS
  */
-uint8_t WS_Cycle_ExpectedMask(uint8_t node_count) {
+WS_NodeMask_t WS_Cycle_ExpectedMask(uint8_t node_count) {
   if (node_count == 0U) {
     return 0U;
   }
-  if (node_count >= 8U) {
-    return 0xFFU;
+  if (node_count >= WS_NODE_MASK_BITS) {
+    return WS_CMD_TARGET_ALL;
   }
-  return (uint8_t)((1U << node_count) - 1U);
+  return WS_NODE_BIT(node_count) - 1U;
 }
 
 /**
@@ -313,6 +1312,39 @@ uint8_t WS_Cycle_ExpectedMask(uint8_t node_count) {
  * @retval  true           Every expected bit is present in @p received_mask
  * @retval  false          At least one expected node has not responded
  */
-bool WS_Cycle_IsComplete(uint8_t expected_mask, uint8_t received_mask) {
+bool WS_Cycle_IsComplete(WS_NodeMask_t expected_mask, WS_NodeMask_t received_mask) {
   return ((received_mask & expected_mask) == expected_mask);
 }
+
+/**
+ * @brief   Returns the reply slot index of a node in a measure command
+ * @param   target_mask  Command target mask (WS_CMD_TARGET_ALL = all nodes)
+ * @param   late_mask    Nodes placed after all others (from WS_Cmd_LateMask)
+ * @param   node_id      NODE_ID of the replying node (0 .. WS_NODE_MASK_BITS - 1)
+ * @retval  uint8_t      Targeted nodes in the same group with a lower NODE_ID, plus
+ *                       every targeted node outside late_mask when @p node_id is late
+ */
+uint8_t WS_Cycle_SlotIndex(WS_NodeMask_t target_mask, WS_NodeMask_t late_mask, uint8_t node_id) {
+  WS_NodeMask_t early = target_mask & ~late_mask;
+  WS_NodeMask_t below;
+  if (node_id >= WS_NODE_MASK_BITS) {
+    return ws_mask_count(target_mask);
+  }
+
+  below = WS_NODE_BIT(node_id) - 1U;
+  if ((late_mask & WS_NODE_BIT(node_id)) == 0U) {
+    return ws_mask_count(early & below);
+  }
+  return (uint8_t)(ws_mask_count(early) + ws_mask_count(target_mask & late_mask & below));
+}
+
+/**
+ * @brief   Returns the time from command to the end of the last reply slot
+ * @param   target_mask  Command target mask (one slot per set bit)
+ * @param   lead_ms      Delay to the first slot
+ * @param   slot_ms      Slot length
+ * @retval  uint32_t     lead_ms + slot count * slot_ms
+ */
+uint32_t WS_Cycle_WindowMs(WS_NodeMask_t target_mask, uint16_t lead_ms, uint8_t slot_ms) {
+  return (uint32_t)lead_ms + ((uint32_t)ws_mask_count(target_mask) * slot_ms);
+}
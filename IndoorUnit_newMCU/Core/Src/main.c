@@ -44,9 +44,13 @@
 
 #include "weather_station_config.h"
 #include "debug_log.h"
+#include "uart_tx.h"
 #include "uart_cmd.h"
 #include "power_mgr.h"
 #include "sd_logger.h"
+#include "ws_event.h"
+#include "ws_profile.h"
+#include "user_diskio_spi.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -112,7 +116,9 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
-
+  /* CYCCNT times SD mount/transfers and NRF delays even with WS_PROFILE_ENABLE=0. */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -182,7 +188,9 @@ int main(void)
   DS3231_EnableAlarm2Interrupt(&rtc);
 
   /* UART + RTC are up: start debug log before SD so init messages are visible. */
+  UartTx_Init(&huart1);
   Debug_Init();
+  WS_Profile_Init();
 
   /* SD mount is best-effort — missing card must not block the station. */
   (void)SD_Logger_Init();
@@ -233,11 +241,16 @@ int main(void)
   wsRuntime.led_port = USER_LED_GPIO_Port;
   wsRuntime.led_pin = USER_LED_Pin;
   wsRuntime.channel = NRF_CHANNEL;
+  wsRuntime.data_rate = (uint8_t)NRF_DATA_RATE;
+  wsRuntime.pa_level = (uint8_t)NRF_PA_LEVEL;
   wsRuntime.cmd_measure = CMD_MEASURE;
   wsRuntime.cmd_size = NRF_CMD_SIZE;
   wsRuntime.payload_size = NRF_PAYLOAD_SIZE;
   wsRuntime.tx_irq_timeout_ms = NRF_TX_IRQ_TIMEOUT_MS;
   wsRuntime.rx_timeout_ms = NRF_RX_TIMEOUT_MS;
+  wsRuntime.slot_lead_ms = NRF_SLOT_LEAD_MS;
+  wsRuntime.slot_len_ms = NRF_SLOT_LEN_MS;
+  wsRuntime.slot_guard_ms = NRF_SLOT_GUARD_MS;
   wsRuntime.comm_watchdog_timeout_ms = NRF_COMM_WATCHDOG_TIMEOUT_MS;
   wsRuntime.huart_pico = &huart1;
   wsRuntime.broadcast_addr = NRF_BROADCAST_ADDR;
@@ -254,7 +267,7 @@ int main(void)
   /* Initialize UI context for weather station display functions */
   WS_UI_Init(&WS_UI, &wsCtx, &wsRuntime, &LCD, &menuContext, &encoder, &rtcNow, g_nrf_message, sizeof(g_nrf_message), &rtc);
 
-  UartCmd_Init(&huart1, &wsCtx);
+  UartCmd_Init(&huart1, &wsCtx, &wsRuntime);
 
   /* Force initial measurement display render (show time + placeholders) */
   WS_UI.chart_data_dirty = 1U;
@@ -279,21 +292,46 @@ int main(void)
     /* USER CODE BEGIN 3 */
 
     uint32_t now_tick = HAL_GetTick();
+    uint8_t nrf_event = 0U;
+    WS_Event_t event;
 
-    /* Flush buffered UART reply first so ACK reaches Pico before NRF logs. */
-    UartCmd_FlushReply();
-
-    /*  Process with NRF24  */
-    WS_ProcessEventHandler(&wsCtx, &wsRuntime, now_tick);
+    /* Dispatch only what the ISRs reported. UART commands come first so the
+     * ACK reaches the Pico before NRF logs. */
+    while (WS_Event_Get(&event))
+    {
+      switch (event.type)
+      {
+        case WS_EVT_UART_LINE:
+          UartCmd_Process();
+          break;
+        case WS_EVT_RTC_ALARM:
+          DS3231_EventHandler(&rtc, &rtcNow, RTC_alarm1, RTC_alarm2);
+          break;
+        case WS_EVT_NRF_IRQ:
+          nrf_event = 1U;
+          break;
+        default:
+          /* Button and encoder flags are consumed by ButtonTask / the view task. */
+          break;
+      }
+    }
 
-    /*    Process with RTC event     */
-    DS3231_EventHandler(&rtc, &rtcNow, RTC_alarm1, RTC_alarm2);
+    /*  Process with NRF24: on its IRQ, or while a cycle runs its timeouts  */
+    if ((nrf_event != 0U) || (WS_CanSleep(&wsCtx) == 0U))
+    {
+      WS_ProcessEventHandler(&wsCtx, &wsRuntime, now_tick);
+    }
 
-    /*    Process with button event routine    */
-    ButtonTask(&encoderSW);
+    /*    Process with button event routine (debounce needs polling until released)    */
+    if ((encoderSW.InterruptFlag != 0U) || (encoderSW.State != IDLE))
+    {
+      ButtonTask(&encoderSW);
+    }
 
     /* View state machine handles chart, status, measurement and menu views */
+    WS_PROFILE_BEGIN(WS_PROF_UI_VIEW);
     WS_UI_ViewTask();
+    WS_PROFILE_END(WS_PROF_UI_VIEW);
 
     /* Keep WWDG alive only while communication watchdog is healthy. */
     uint32_t wwdg_now_tick = HAL_GetTick();
@@ -308,12 +346,24 @@ int main(void)
         Debug_Heartbeat();
     #endif
 
+    /* Write queued SD lines only while the radio is idle; card busy-waits
+     * must not delay reply handling. */
+    if (WS_CanSleep(&wsCtx) != 0U)
+    {
+      WS_PROFILE_BEGIN(WS_PROF_SD_DRAIN);
+      SD_Logger_Task();
+      WS_PROFILE_END(WS_PROF_SD_DRAIN);
+    }
+
     if ((menuContext.state.InScreenSaver != 0U) &&
+        WS_Event_IsEmpty() &&
         (encoder.ButtonIRQ_Flag == 0U) &&
         (encoderSW.InterruptFlag == 0U) &&
+        (encoderSW.State == IDLE) &&
         (encoder.IRQ_Flag == 0U) &&
         (WS_CanSleep(&wsCtx) != 0U))
     {
+      SD_Logger_Flush();
       PowerMgr_EnterIdleStop(&nrf);
     }
 
@@ -368,6 +418,32 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim){
   if (htim->Instance == TIM1)
   {
     encoder.IRQ_Flag = IRQ_FLAG_SET;
+    (void)WS_Event_Post(WS_EVT_ENCODER);
+  }
+}
+
+/*      SPI1 DMA completion: SD card transfer, otherwise the LCD      */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if ((hspi == &SD_SPI_HANDLE) && (USER_SPI_DmaCallback(0U) == 0U))
+  {
+    PCD8544_TxCpltCallback(&LCD);
+  }
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  if (hspi == &SD_SPI_HANDLE)
+  {
+    (void)USER_SPI_DmaCallback(0U);
+  }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  if ((hspi == &SD_SPI_HANDLE) && (USER_SPI_DmaCallback(1U) == 0U))
+  {
+    PCD8544_TxCpltCallback(&LCD);
   }
 }
 
@@ -376,14 +452,23 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
   /*Encoder button IRQ handler*/
   ButtonIRQHandler(&encoderSW, GPIO_Pin);
+  if (GPIO_Pin == encoderSW.GpioPin)
+  {
+    (void)WS_Event_Post(WS_EVT_BUTTON);
+  }
 
   /* RTC SQW/INT pin IRQ handler */
   DS3231_IRQHandler(&rtc, GPIO_Pin);
+  if (GPIO_Pin == rtc.sqw_pin)
+  {
+    (void)WS_Event_Post(WS_EVT_RTC_ALARM);
+  }
 
   /* NRF24L01 IRQ pin (active low) */
   if (GPIO_Pin == NRF_IRQ_Pin)
   {
     WS_SetIrqFlag(&wsCtx);
+    (void)WS_Event_Post(WS_EVT_NRF_IRQ);
   }
 }
 
@@ -391,10 +476,10 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 
 /**
  * @brief Microsecond delay using DWT cycle counter.
+ * @note  CYCCNT is never reset here: ws_profile zones may be open around it.
  */
 static void NRF_DelayUs(uint32_t us) {
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
-  DWT->CYCCNT = 0;
   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   uint32_t cycles = (SystemCoreClock / 1000000U) * us;
@@ -412,7 +497,9 @@ void RTC_alarm1(void){
 
 /* RTC alarm function assign to callback */
 void RTC_alarm2(void){
-  WS_RequestMeasurementCycle(&wsCtx);
+  if (WS_IsMeasurementDue(&wsCtx, &rtcNow)) {
+    WS_RequestMeasurementCycle(&wsCtx);
+  }
 #ifdef DEBUG_LOG_RTC2_EVENTS
   Debug_LogRtcAlarm2();
 #endif
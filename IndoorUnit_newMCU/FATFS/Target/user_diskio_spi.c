@@ -13,7 +13,25 @@
  ******************************************************************************
  *
  * Based on kiwih/cubeide-sd-card, itself ported from ChaN's mmc_spi sample.
- * Adapted for STM32F103 SPI1 shared with a PCD8544 display.
+ * Adapted for STM32F103 SPI1 shared with a PCD8544 display: the card clock
+ * is applied when the card is selected and the bus clock configured in
+ * SD_SPI_HANDLE.Init (the LCD's) is restored when it is released.
+ *
+ * With USER_SPI_USE_CRC the card checks command and write CRCs (CMD59) and
+ * the driver checks the CRC-16 of every block it reads. The card clock is
+ * then chosen at initialization: sector 0 is read USER_SPI_PROBE_READS
+ * times at each prescaler from USER_SPI_MAX_PRESCALER down, and the fastest
+ * clean one is kept. The choice is stored in backup registers BKP DR1/DR2
+ * with a hash of the card's CID, so later mounts of the same card (after a
+ * reset or STOP mode, while VBAT holds) skip the probe. Each CRC or data
+ * token error at run time drops one prescaler step, down to
+ * USER_SPI_MIN_PRESCALER, and stores the new choice.
+ *
+ * With USER_SPI_USE_DMA the data phase of every block (512 bytes in
+ * CMD17/CMD18 reads and CMD24/CMD25 writes) runs on DMA1 channels 2/3.
+ * Reads clock out a single 0xFF byte with the TX channel's memory increment
+ * turned off. The CPU sleeps in WFI until the completion callback, so ISR
+ * events (nRF24 IRQ, encoder) are still taken during a transfer.
  */
 
 #include "user_diskio_spi.h"
@@ -21,11 +39,14 @@
 #include "main.h"
 #include "wwdg.h"
 
+#include <string.h>
+
 #define CMD0     0U          /* GO_IDLE_STATE */
 #define CMD1     1U          /* SEND_OP_COND (MMC) */
 #define ACMD41   (0x80U + 41U) /* SEND_OP_COND (SDC) */
 #define CMD8     8U          /* SEND_IF_COND */
 #define CMD9     9U          /* SEND_CSD */
+#define CMD10    10U         /* SEND_CID */
 #define CMD12    12U         /* STOP_TRANSMISSION */
 #define ACMD13   (0x80U + 13U) /* SD_STATUS */
 #define CMD16    16U         /* SET_BLOCKLEN */
@@ -36,6 +57,7 @@
 #define CMD25    25U         /* WRITE_MULTIPLE_BLOCK */
 #define CMD55    55U         /* APP_CMD */
 #define CMD58    58U         /* READ_OCR */
+#define CMD59    59U         /* CRC_ON_OFF */
 
 #define USER_SPI_INIT_TIMEOUT_MS 1000U
 #define USER_SPI_READY_TIMEOUT_MS 500U
@@ -44,10 +66,19 @@
 
 /*
  * SPI1 is clocked from APB2 at 72 MHz. /256 gives 281.25 kHz during card
- * initialization (the SD limit is 400 kHz), while /16 gives 4.5 MHz in use.
+ * initialization (the SD limit is 400 kHz). Probing starts at /4 (18 MHz,
+ * the STM32F103 SPI limit); /16 (4.5 MHz) is used when the card runs
+ * without CRC, and /64 (1.125 MHz) is the floor for error fallback.
  */
 #define USER_SPI_SLOW_PRESCALER SPI_BAUDRATEPRESCALER_256
+#define USER_SPI_MAX_PRESCALER  SPI_BAUDRATEPRESCALER_4
 #define USER_SPI_FAST_PRESCALER SPI_BAUDRATEPRESCALER_16
+#define USER_SPI_MIN_PRESCALER  SPI_BAUDRATEPRESCALER_64
+
+/* Clean sector 0 reads required to accept a probed clock. */
+#define USER_SPI_PROBE_READS 4U
+/* Marks BKP DR2 as holding a prescaler (low byte) for the CID in DR1. */
+#define USER_SPI_BKP_MAGIC 0x5D00U
 
 #define SD_CS_HIGH() HAL_GPIO_WritePin(SD_CS_GPIO_Port, SD_CS_Pin, GPIO_PIN_SET)
 #define SD_CS_LOW()                                                            \
@@ -62,6 +93,23 @@ static volatile DSTATUS Stat = STA_NOINIT;
 static BYTE CardType = 0U;
 static USER_SPI_Error LastError = USER_SPI_ERR_NONE;
 static uint8_t HalFailed = 0U;
+static USER_SPI_Stats Stats;
+/* Data clock after initialization; kept across remounts. */
+static uint32_t FastPrescaler = USER_SPI_FAST_PRESCALER;
+/* CRC-16 of the card's CID, keys the stored clock (0 = unknown card). */
+static WORD ClockKey = 0U;
+/* Card accepted CMD59: commands, reads and writes carry CRCs. */
+static uint8_t CrcOn = 0U;
+/* Clock applied while the card is selected (slow during initialization). */
+static uint32_t CardPrescaler = USER_SPI_SLOW_PRESCALER;
+
+#if USER_SPI_USE_DMA
+/* Set while a DMA transfer owns SPI1; cleared by USER_SPI_DmaCallback(). */
+static volatile uint8_t DmaBusy = 0U;
+static volatile uint8_t DmaFailed = 0U;
+/* TX source for DMA reads; the TX channel does not increment over it. */
+static const BYTE DmaFill = 0xFFU;
+#endif
 
 static void set_error(USER_SPI_Error error)
 {
@@ -70,14 +118,97 @@ static void set_error(USER_SPI_Error error)
   }
 }
 
+/* Only CR1 changes: Init.BaudRatePrescaler keeps the bus (LCD) clock. */
 static void set_spi_prescaler(uint32_t prescaler)
 {
+  if (READ_BIT(SD_SPI_HANDLE.Instance->CR1, SPI_CR1_BR) == prescaler) {
+    return;
+  }
   __HAL_SPI_DISABLE(&SD_SPI_HANDLE);
   MODIFY_REG(SD_SPI_HANDLE.Instance->CR1, SPI_CR1_BR, prescaler);
-  SD_SPI_HANDLE.Init.BaudRatePrescaler = prescaler;
   __HAL_SPI_ENABLE(&SD_SPI_HANDLE);
 }
 
+/* CRC-16/XMODEM (poly 0x1021, init 0) of SD data blocks, nibble table. */
+static WORD crc16(WORD crc, const BYTE *data, UINT length)
+{
+  static const WORD table[16] = {0x0000U, 0x1021U, 0x2042U, 0x3063U, 0x4084U, 0x50A5U, 0x60C6U, 0x70E7U,
+                                 0x8108U, 0x9129U, 0xA14AU, 0xB16BU, 0xC18CU, 0xD1ADU, 0xE1CEU, 0xF1EFU};
+
+  while (length-- > 0U) {
+    crc = (WORD)((crc << 4) ^ table[((crc >> 12) ^ (*data >> 4)) & 0x0FU]);
+    crc = (WORD)((crc << 4) ^ table[((crc >> 12) ^ *data) & 0x0FU]);
+    data++;
+  }
+  return crc;
+}
+
+/* CRC-7 of a command frame, returned as the final frame byte (with end bit). */
+static BYTE crc7(const BYTE *data, UINT length)
+{
+  BYTE crc = 0U;
+
+  while (length-- > 0U) {
+    BYTE value = *data++;
+    for (BYTE bit = 0U; bit < 8U; bit++) {
+      crc = (BYTE)(crc << 1);
+      if (((value ^ crc) & 0x80U) != 0U) {
+        crc ^= 0x09U;
+      }
+      value = (BYTE)(value << 1);
+    }
+  }
+  return (BYTE)((crc << 1) | 0x01U);
+}
+
+static void backup_enable(void)
+{
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+}
+
+/* Load the clock stored for this card; returns 0 when there is none. */
+static int clock_load(void)
+{
+  uint32_t stored;
+
+  if (ClockKey == 0U) {
+    return 0;
+  }
+  backup_enable();
+  stored = BKP->DR2 & 0xFFFFU;
+  if (((BKP->DR1 & 0xFFFFU) != ClockKey) || ((stored & 0xFF00U) != USER_SPI_BKP_MAGIC) ||
+      ((stored & ~SPI_CR1_BR & 0xFFU) != 0U) || ((stored & SPI_CR1_BR) < USER_SPI_MAX_PRESCALER) ||
+      ((stored & SPI_CR1_BR) > USER_SPI_MIN_PRESCALER)) {
+    return 0;
+  }
+  FastPrescaler = stored & SPI_CR1_BR;
+  return 1;
+}
+
+static void clock_store(void)
+{
+  if (ClockKey == 0U) {
+    return;
+  }
+  backup_enable();
+  BKP->DR1 = ClockKey;
+  BKP->DR2 = USER_SPI_BKP_MAGIC | FastPrescaler;
+}
+
+/* After a CRC or data token error, run the card one prescaler step slower. */
+static void clock_fallback(void)
+{
+  if (((LastError == USER_SPI_ERR_DATA) || (LastError == USER_SPI_ERR_CRC)) &&
+      (FastPrescaler < USER_SPI_MIN_PRESCALER)) {
+    FastPrescaler += SPI_CR1_BR_0;
+    CardPrescaler = FastPrescaler;
+    Stats.clock_fallbacks++;
+    clock_store();
+  }
+}
+
 static BYTE xchg_spi(BYTE value)
 {
   BYTE received = 0xFFU;
@@ -92,8 +223,66 @@ static BYTE xchg_spi(BYTE value)
   return received;
 }
 
+#if USER_SPI_USE_DMA
+static int dma_wait(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (DmaBusy != 0U) {
+    if ((HAL_GetTick() - start) >= USER_SPI_XFER_TIMEOUT_MS) {
+      (void)HAL_SPI_Abort(&SD_SPI_HANDLE);
+      DmaBusy = 0U;
+      HalFailed = 1U;
+      set_error(USER_SPI_ERR_TIMEOUT);
+      return 0;
+    }
+    /* PRIMASK closes the gap between the check and WFI; a pending
+     * interrupt still wakes the core and runs once it is re-enabled. */
+    __disable_irq();
+    if (DmaBusy != 0U) {
+      __WFI();
+    }
+    __enable_irq();
+    WWDG_TryRefresh();
+  }
+
+  if (DmaFailed != 0U) {
+    HalFailed = 1U;
+    set_error(USER_SPI_ERR_HAL);
+    return 0;
+  }
+  return 1;
+}
+
+static int receive_dma(BYTE *buffer, UINT count)
+{
+  DMA_Channel_TypeDef *tx_channel = SD_SPI_HANDLE.hdmatx->Instance;
+  int ok;
+
+  DmaFailed = 0U;
+  DmaBusy = 1U;
+  CLEAR_BIT(tx_channel->CCR, DMA_CCR_MINC);
+  if (HAL_SPI_TransmitReceive_DMA(&SD_SPI_HANDLE, &DmaFill, buffer,
+                                  (uint16_t)count) != HAL_OK) {
+    DmaBusy = 0U;
+    HalFailed = 1U;
+    set_error(USER_SPI_ERR_HAL);
+    ok = 0;
+  } else {
+    ok = dma_wait();
+  }
+  SET_BIT(tx_channel->CCR, DMA_CCR_MINC);
+  return ok;
+}
+#endif
+
 static int receive_multi(BYTE *buffer, UINT count)
 {
+#if USER_SPI_USE_DMA
+  if (count >= USER_SPI_DMA_MIN_BYTES) {
+    return receive_dma(buffer, count);
+  }
+#endif
   while (count > 0U) {
     *buffer++ = xchg_spi(0xFFU);
     if (HalFailed != 0U) {
@@ -107,6 +296,19 @@ static int receive_multi(BYTE *buffer, UINT count)
 #if _USE_WRITE == 1
 static int transmit_multi(const BYTE *buffer, UINT count)
 {
+#if USER_SPI_USE_DMA
+  if (count >= USER_SPI_DMA_MIN_BYTES) {
+    DmaFailed = 0U;
+    DmaBusy = 1U;
+    if (HAL_SPI_Transmit_DMA(&SD_SPI_HANDLE, buffer, (uint16_t)count) != HAL_OK) {
+      DmaBusy = 0U;
+      HalFailed = 1U;
+      set_error(USER_SPI_ERR_HAL);
+      return 0;
+    }
+    return dma_wait();
+  }
+#endif
   if (HAL_SPI_Transmit(&SD_SPI_HANDLE, (BYTE *)buffer, count,
                        USER_SPI_XFER_TIMEOUT_MS) != HAL_OK) {
     HalFailed = 1U;
@@ -117,9 +319,28 @@ static int transmit_multi(const BYTE *buffer, UINT count)
 }
 #endif
 
+/* Bucket a busy wait by its CYCCNT length (the counter is enabled in main). */
+static void record_wait(uint32_t cycles)
+{
+  uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+  uint32_t us = (cycles_per_us != 0U) ? (cycles / cycles_per_us) : 0U;
+  uint32_t limit = 64U;
+  uint8_t bucket = 0U;
+
+  while ((bucket < (USER_SPI_WAIT_BUCKETS - 1U)) && (us >= limit)) {
+    limit *= 4U;
+    bucket++;
+  }
+  Stats.wait_hist[bucket]++;
+  if (us > Stats.wait_max_us) {
+    Stats.wait_max_us = us;
+  }
+}
+
 static int wait_ready(UINT timeout_ms)
 {
   uint32_t start = HAL_GetTick();
+  uint32_t start_cycles = DWT->CYCCNT;
   BYTE value;
 
   do {
@@ -128,11 +349,13 @@ static int wait_ready(UINT timeout_ms)
       return 0;
     }
     if (value == 0xFFU) {
+      record_wait(DWT->CYCCNT - start_cycles);
       return 1;
     }
     WWDG_TryRefresh();
   } while ((HAL_GetTick() - start) < timeout_ms);
 
+  record_wait(DWT->CYCCNT - start_cycles);
   set_error(USER_SPI_ERR_TIMEOUT);
   return 0;
 }
@@ -141,10 +364,12 @@ static void deselect_card(void)
 {
   SD_CS_HIGH();
   (void)xchg_spi(0xFFU);
+  set_spi_prescaler(SD_SPI_HANDLE.Init.BaudRatePrescaler);
 }
 
 static int select_card(void)
 {
+  set_spi_prescaler(CardPrescaler);
   SD_CS_LOW();
   (void)xchg_spi(0xFFU);
   if ((HalFailed == 0U) && wait_ready(USER_SPI_READY_TIMEOUT_MS)) {
@@ -155,7 +380,7 @@ static int select_card(void)
   return 0;
 }
 
-static int receive_datablock(BYTE *buffer, UINT length)
+static int wait_data_token(void)
 {
   uint32_t start = HAL_GetTick();
   BYTE token;
@@ -170,22 +395,42 @@ static int receive_datablock(BYTE *buffer, UINT length)
            ((HAL_GetTick() - start) < USER_SPI_TOKEN_TIMEOUT_MS));
 
   if (token != 0xFEU) {
-    set_error(USER_SPI_ERR_TIMEOUT);
+    set_error((token == 0xFFU) ? USER_SPI_ERR_TIMEOUT : USER_SPI_ERR_DATA);
+    return 0;
+  }
+  return 1;
+}
+
+/* Read the CRC-16 that ends a data block and compare it with `crc`. */
+static int check_block_crc(WORD crc)
+{
+  WORD received = (WORD)(xchg_spi(0xFFU) << 8);
+
+  received |= xchg_spi(0xFFU);
+  if (HalFailed != 0U) {
     return 0;
   }
-  if (!receive_multi(buffer, length)) {
+  if ((CrcOn != 0U) && (received != crc)) {
+    Stats.crc_errors++;
+    set_error(USER_SPI_ERR_CRC);
     return 0;
   }
+  return 1;
+}
 
-  (void)xchg_spi(0xFFU);
-  (void)xchg_spi(0xFFU);
-  return (HalFailed == 0U) ? 1 : 0;
+static int receive_datablock(BYTE *buffer, UINT length)
+{
+  if (!wait_data_token() || !receive_multi(buffer, length)) {
+    return 0;
+  }
+  return check_block_crc((CrcOn != 0U) ? crc16(0U, buffer, length) : 0U);
 }
 
 #if _USE_WRITE == 1
 static int transmit_datablock(const BYTE *buffer, BYTE token)
 {
   BYTE response;
+  WORD crc = 0xFFFFU;
 
   if (!wait_ready(USER_SPI_READY_TIMEOUT_MS)) {
     return 0;
@@ -195,14 +440,26 @@ static int transmit_datablock(const BYTE *buffer, BYTE token)
   if (token == 0xFDU) {
     return (HalFailed == 0U) ? 1 : 0;
   }
-  if ((buffer == NULL) || !transmit_multi(buffer, 512U)) {
+  if (buffer == NULL) {
+    return 0;
+  }
+  if (CrcOn != 0U) {
+    crc = crc16(0U, buffer, 512U);
+  }
+  if (!transmit_multi(buffer, 512U)) {
     return 0;
   }
 
-  (void)xchg_spi(0xFFU);
-  (void)xchg_spi(0xFFU);
+  (void)xchg_spi((BYTE)(crc >> 8));
+  (void)xchg_spi((BYTE)crc);
   response = xchg_spi(0xFFU);
+  if ((response & 0x1FU) == 0x0BU) {
+    Stats.crc_errors++;
+    set_error(USER_SPI_ERR_CRC);
+    return 0;
+  }
   if ((response & 0x1FU) != 0x05U) {
+    set_error(USER_SPI_ERR_DATA);
     return 0;
   }
 
@@ -212,6 +469,7 @@ static int transmit_datablock(const BYTE *buffer, BYTE token)
 
 static BYTE send_command(BYTE command, DWORD argument)
 {
+  BYTE frame[5];
   BYTE attempts;
   BYTE response;
 
@@ -230,19 +488,15 @@ static BYTE send_command(BYTE command, DWORD argument)
     }
   }
 
-  (void)xchg_spi((BYTE)(0x40U | command));
-  (void)xchg_spi((BYTE)(argument >> 24));
-  (void)xchg_spi((BYTE)(argument >> 16));
-  (void)xchg_spi((BYTE)(argument >> 8));
-  (void)xchg_spi((BYTE)argument);
-
-  attempts = 0x01U;
-  if (command == CMD0) {
-    attempts = 0x95U;
-  } else if (command == CMD8) {
-    attempts = 0x87U;
+  frame[0] = (BYTE)(0x40U | command);
+  frame[1] = (BYTE)(argument >> 24);
+  frame[2] = (BYTE)(argument >> 16);
+  frame[3] = (BYTE)(argument >> 8);
+  frame[4] = (BYTE)argument;
+  for (BYTE i = 0U; i < sizeof(frame); i++) {
+    (void)xchg_spi(frame[i]);
   }
-  (void)xchg_spi(attempts);
+  (void)xchg_spi(crc7(frame, sizeof(frame)));
 
   if (command == CMD12) {
     (void)xchg_spi(0xFFU);
@@ -255,6 +509,62 @@ static BYTE send_command(BYTE command, DWORD argument)
   return response;
 }
 
+/* Read sector 0 USER_SPI_PROBE_READS times at `prescaler`, in DMA-sized
+ * chunks (no sector buffer on the stack). Returns 1 if every CRC matched. */
+static int probe_clock(uint32_t prescaler)
+{
+  BYTE chunk[USER_SPI_DMA_MIN_BYTES];
+  WORD crc;
+  int ok = 1;
+
+  CardPrescaler = prescaler;
+  for (BYTE pass = 0U; ok && (pass < USER_SPI_PROBE_READS); pass++) {
+    HalFailed = 0U;
+    ok = (send_command(CMD17, 0U) == 0U) && wait_data_token();
+    crc = 0U;
+    for (UINT n = 0U; ok && (n < 512U); n += sizeof(chunk)) {
+      ok = receive_multi(chunk, sizeof(chunk));
+      crc = crc16(crc, chunk, sizeof(chunk));
+    }
+    ok = ok && check_block_crc(crc);
+    deselect_card();
+    WWDG_TryRefresh();
+  }
+  return ok;
+}
+
+/* Pick the card clock: stored choice for this CID, else probe (CRC only). */
+static void select_clock(void)
+{
+  BYTE cid[16];
+  uint32_t prescaler = USER_SPI_MAX_PRESCALER;
+
+  ClockKey = 0U;
+  if ((send_command(CMD10, 0U) == 0U) && receive_datablock(cid, sizeof(cid))) {
+    ClockKey = crc16(0xFFFFU, cid, sizeof(cid));
+    if (ClockKey == 0U) {
+      ClockKey = 1U;
+    }
+  }
+  deselect_card();
+
+  if (CrcOn == 0U) {
+    FastPrescaler = USER_SPI_FAST_PRESCALER;
+    return;
+  }
+  if (clock_load() != 0) {
+    return;
+  }
+
+  Stats.clock_probes++;
+  while ((prescaler < USER_SPI_MIN_PRESCALER) && !probe_clock(prescaler)) {
+    prescaler += SPI_CR1_BR_0;
+  }
+  FastPrescaler = prescaler;
+  clock_store();
+  HalFailed = 0U;
+}
+
 DSTATUS USER_SPI_initialize(BYTE drive)
 {
   BYTE command;
@@ -286,6 +596,7 @@ DSTATUS USER_SPI_initialize(BYTE drive)
 
   SD_CS_HIGH();
   HAL_GPIO_WritePin(LCD_CE_GPIO_Port, LCD_CE_Pin, GPIO_PIN_SET);
+  CardPrescaler = USER_SPI_SLOW_PRESCALER;
   set_spi_prescaler(USER_SPI_SLOW_PRESCALER);
   for (n = 10U; n > 0U; n--) {
     (void)xchg_spi(0xFFU);
@@ -307,6 +618,10 @@ DSTATUS USER_SPI_initialize(BYTE drive)
             type = USER_SPI_CT_SD2;
             if ((ocr[0] & 0x40U) != 0U) {
               type |= USER_SPI_CT_BLOCK;
+            } else if (send_command(CMD16, 512U) != 0U) {
+              /* Byte-addressed SDv2 (SDSC) needs 512-byte blocks too. */
+              type = 0U;
+              set_error(USER_SPI_ERR_CMD16);
             }
           }
         } else {
@@ -341,8 +656,17 @@ DSTATUS USER_SPI_initialize(BYTE drive)
   }
 
   CardType = type;
+  CrcOn = 0U;
+#if USER_SPI_USE_CRC
+  if ((type != 0U) && (send_command(CMD59, 1U) == 0U)) {
+    CrcOn = 1U;
+  }
+#endif
+  if (type != 0U) {
+    select_clock();
+  }
+  CardPrescaler = FastPrescaler;
   deselect_card();
-  set_spi_prescaler(USER_SPI_FAST_PRESCALER);
 
   if (type != 0U) {
     Stat &= (DSTATUS)~STA_NOINIT;
@@ -371,6 +695,7 @@ DRESULT USER_SPI_read(BYTE drive, BYTE *buffer, DWORD sector, UINT count)
     sector *= 512U;
   }
 
+  Stats.sectors_read += count;
   if (count == 1U) {
     if ((send_command(CMD17, sector) == 0U) &&
         receive_datablock(buffer, 512U)) {
@@ -388,7 +713,13 @@ DRESULT USER_SPI_read(BYTE drive, BYTE *buffer, DWORD sector, UINT count)
   }
 
   deselect_card();
-  return (count == 0U) ? RES_OK : RES_ERROR;
+  if (count != 0U) {
+    Stats.sectors_read -= count;
+    Stats.errors++;
+    clock_fallback();
+    return RES_ERROR;
+  }
+  return RES_OK;
 }
 
 #if _USE_WRITE == 1
@@ -410,6 +741,7 @@ DRESULT USER_SPI_write(BYTE drive, const BYTE *buffer, DWORD sector, UINT count)
     sector *= 512U;
   }
 
+  Stats.sectors_written += count;
   if (count == 1U) {
     if ((send_command(CMD24, sector) == 0U) &&
         transmit_datablock(buffer, 0xFEU)) {
@@ -434,7 +766,13 @@ DRESULT USER_SPI_write(BYTE drive, const BYTE *buffer, DWORD sector, UINT count)
   }
 
   deselect_card();
-  return (count == 0U) ? RES_OK : RES_ERROR;
+  if (count != 0U) {
+    Stats.sectors_written -= count;
+    Stats.errors++;
+    clock_fallback();
+    return RES_ERROR;
+  }
+  return RES_OK;
 }
 #endif
 
@@ -498,12 +836,17 @@ DRESULT USER_SPI_ioctl(BYTE drive, BYTE command, void *buffer)
     if ((CardType & USER_SPI_CT_SD2) != 0U) {
       if (send_command(ACMD13, 0U) == 0U) {
         (void)xchg_spi(0xFFU);
-        if (receive_datablock(csd, sizeof(csd))) {
+        /* 64-byte SD status: keep the first 16, CRC covers all 64. */
+        if (wait_data_token() && receive_multi(csd, sizeof(csd))) {
+          WORD crc = crc16(0U, csd, sizeof(csd));
           for (n = 48U; n > 0U; n--) {
-            (void)xchg_spi(0xFFU);
+            BYTE value = xchg_spi(0xFFU);
+            crc = crc16(crc, &value, 1U);
+          }
+          if (check_block_crc(crc)) {
+            *(DWORD *)buffer = 16UL << (csd[10] >> 4);
+            result = RES_OK;
           }
-          *(DWORD *)buffer = 16UL << (csd[10] >> 4);
-          result = RES_OK;
         }
       }
     } else if ((send_command(CMD9, 0U) == 0U) &&
@@ -542,3 +885,32 @@ BYTE USER_SPI_get_card_type(void)
 {
   return CardType;
 }
+
+uint32_t USER_SPI_get_clock_hz(void)
+{
+  return HAL_RCC_GetPCLK2Freq() >> ((FastPrescaler >> SPI_CR1_BR_Pos) + 1U);
+}
+
+const USER_SPI_Stats *USER_SPI_get_stats(void)
+{
+  return &Stats;
+}
+
+void USER_SPI_reset_stats(void)
+{
+  (void)memset(&Stats, 0, sizeof(Stats));
+}
+
+#if USER_SPI_USE_DMA
+uint8_t USER_SPI_DmaCallback(uint8_t failed)
+{
+  if (DmaBusy == 0U) {
+    return 0U;
+  }
+  if (failed != 0U) {
+    DmaFailed = 1U;
+  }
+  DmaBusy = 0U;
+  return 1U;
+}
+#endif
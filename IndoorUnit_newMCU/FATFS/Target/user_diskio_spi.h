@@ -26,6 +26,25 @@ extern "C" {
 
 #define USER_SPI_PDRV 0U
 
+/**
+ * Move 512-byte data blocks with SPI DMA (needs SPI1 RX/TX DMA linked and
+ * USER_SPI_DmaCallback() called from the HAL SPI callbacks). 0 = polled.
+ */
+#ifndef USER_SPI_USE_DMA
+#define USER_SPI_USE_DMA 1
+#endif
+
+/**
+ * Enable CRC checking (CMD59) and pick the fastest clean card clock at
+ * initialization. 0 = no CRCs, fixed 4.5 MHz card clock.
+ */
+#ifndef USER_SPI_USE_CRC
+#define USER_SPI_USE_CRC 1
+#endif
+
+/** Shorter transfers (command responses, CSD) stay polled. */
+#define USER_SPI_DMA_MIN_BYTES 64U
+
 /** Card type flags returned by USER_SPI_get_card_type(). */
 #define USER_SPI_CT_MMC   0x01U
 #define USER_SPI_CT_SD1   0x02U
@@ -43,9 +62,26 @@ typedef enum {
   USER_SPI_ERR_INIT_TIMEOUT,
   USER_SPI_ERR_CMD58,
   USER_SPI_ERR_CMD16,
-  USER_SPI_ERR_TIMEOUT
+  USER_SPI_ERR_TIMEOUT,
+  USER_SPI_ERR_DATA,       /**< Bad data token or data response (clock falls back) */
+  USER_SPI_ERR_CRC         /**< Data block CRC mismatch (clock falls back) */
 } USER_SPI_Error;
 
+/** wait_ready() histogram buckets: < 64 us, then x4 per bucket, last >= 256 ms. */
+#define USER_SPI_WAIT_BUCKETS 8U
+
+/** Running transfer counters returned by USER_SPI_get_stats(). */
+typedef struct {
+  uint32_t sectors_read;      /**< Sectors read successfully */
+  uint32_t sectors_written;   /**< Sectors written successfully */
+  uint32_t errors;            /**< Failed read/write calls */
+  uint32_t crc_errors;        /**< Blocks failing the CRC-16 (read or write) */
+  uint32_t clock_fallbacks;   /**< Card clock steps lost to CRC/data errors */
+  uint32_t clock_probes;      /**< Clock probes at initialization */
+  uint32_t wait_max_us;       /**< Longest card-busy wait */
+  uint32_t wait_hist[USER_SPI_WAIT_BUCKETS]; /**< Busy waits by duration */
+} USER_SPI_Stats;
+
 DSTATUS USER_SPI_initialize(BYTE pdrv);
 DSTATUS USER_SPI_status(BYTE pdrv);
 DRESULT USER_SPI_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count);
@@ -58,6 +94,20 @@ DRESULT USER_SPI_ioctl(BYTE pdrv, BYTE cmd, void *buff);
 
 USER_SPI_Error USER_SPI_get_last_error(void);
 BYTE USER_SPI_get_card_type(void);
+/** Card data clock in Hz (after initialization and any fallback). */
+uint32_t USER_SPI_get_clock_hz(void);
+const USER_SPI_Stats *USER_SPI_get_stats(void);
+void USER_SPI_reset_stats(void);
+
+#if USER_SPI_USE_DMA
+/**
+ * Completion hook for SD_SPI_HANDLE: call from HAL_SPI_TxCpltCallback and
+ * HAL_SPI_TxRxCpltCallback with failed = 0, from HAL_SPI_ErrorCallback with
+ * failed = 1. Returns 1 if the transfer was the SD driver's, 0 otherwise
+ * (e.g. a PCD8544 DMA update sharing SPI1).
+ */
+uint8_t USER_SPI_DmaCallback(uint8_t failed);
+#endif
 
 #ifdef __cplusplus
 }
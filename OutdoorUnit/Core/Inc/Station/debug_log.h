@@ -21,6 +21,15 @@
  */
 #define DEBUG_LOG_ENABLE
 
+/**
+ * @brief Tokenized binary records instead of text lines
+ * @details Each call sends its message string's flash address, the tick and
+ *          the integer arguments (ws_logtok.h) and skips snprintf; lines are
+ *          3-4x shorter on UART. Decode with tools/ws_protocol_host
+ *          `ws_logdecode` and the ELF of the same build.
+ */
+//#define DEBUG_LOG_TOKENIZED
+
 /**
  * @brief Enable individual log categories
  * @details Comment out specific categories to reduce log verbosity
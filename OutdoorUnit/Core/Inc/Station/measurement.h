@@ -183,13 +183,21 @@ void Measurement_WakeupSensors(Measurement_Context_t *ctx);
 bool Measurement_BuildReadings(const Measurement_Context_t *ctx, WS_Readings_t *out);
 
 /**
- * @brief   Encodes measurement data into nRF24 wire buffer
- * @param   ctx       Pointer to measurement context structure
- * @param   buf       Destination buffer
- * @param   buf_size  Buffer capacity
- * @retval  Encoded length in bytes, 0 on failure
- */
-uint8_t Measurement_EncodePayload(const Measurement_Context_t *ctx, uint8_t *buf, uint8_t buf_size);
+ * @brief   Encodes measurement data into one or more nRF24 wire frames
+ * @param   ctx         Pointer to measurement context structure
+ * @param   seq         Sequence number stamped on fragments and keyframes (measure cycle id)
+ * @param   key         Acknowledged keyframe to send a delta against, or NULL
+ * @param   key_out     Receives the keyframe state when a keyframe is sent (may be NULL)
+ * @param   frames      Destination frames, each WS_PROTOCOL_MAX_PAYLOAD bytes;
+ *                      frames stay within WS_PROTOCOL_MAX_FRAME for the reply envelope
+ * @param   lens        Receives the encoded length of each frame
+ * @param   max_frames  Capacity of @p frames / @p lens
+ * @retval  Number of frames encoded, 0 on failure
+ */
+uint8_t Measurement_EncodeFrames(const Measurement_Context_t *ctx, uint8_t seq,
+                                 const WS_DeltaKey_t *key, WS_DeltaKey_t *key_out,
+                                 uint8_t frames[][WS_PROTOCOL_MAX_PAYLOAD], uint8_t *lens,
+                                 uint8_t max_frames);
 
 /**
  * @brief   Gets the latest measurement data directly
@@ -26,13 +26,17 @@
 #define USE_UART_LOGGING      1     /**< Enable UART debug logging */
 #define CHECK_I2C_DEVICES     0     /**< Scan I2C bus on startup (debug) */
 #define USE_TIMER_PROFILING   1     /**< Enable timing measurements for profiling */
+#define USE_PROTOCOL_V2       1     /**< Send fixed-point v2 frames (0 = v1 float records) */
+#define USE_DELTA_FRAMES      1     /**< Send deltas against acknowledged keyframes (needs v2 channels) */
+#define NRF_DYNAMIC_PAYLOAD   1     /**< Dynamic payload length on replies (IndoorUnit must match) */
+#define USE_OFFLINE_BACKLOG   1     /**< Buffer unacknowledged measurements, upload after the link recovers */
 
 /* ============================================================================
  * Node Configuration
  * ============================================================================ */
 /* Undef first: stale cmake -DNODE_ID=1U must not override this header. */
 #undef NODE_ID
-/** @brief Node identity — set per board before building (0 or 1 for WS_NODE_COUNT=2). */
+/** @brief Node identity — set per board before building (0 .. WS_NODE_COUNT-1 on IndoorUnit, max 31). */
 #define NODE_ID               1U
 
 /* ============================================================================
@@ -46,17 +50,38 @@
 #define NRF_INIT_MAX_RETRIES      3U      /**< Max NRF init retry attempts */
 #define NRF_INIT_RETRY_DELAY_MS   200U    /**< Delay between init retries */
 #define NRF_REINIT_INTERVAL_MS    10000U  /**< Periodic reinit when NRF is missing */
-/** @brief Minimum delay after measure before reply (Indoor must be in RX after broadcast). */
+/**
+ * @brief Minimum delay after measure before reply (Indoor must be in RX after broadcast).
+ * @note  Used only when the measure command carries no slot schedule.
+ */
 #define NRF_RESPONSE_BASE_MS      80U
-/** @brief Extra stagger: NODE_ID * this delay (collision avoidance between outdoors). */
+/** @brief Extra stagger: NODE_ID * this delay; also the slot length without a schedule. */
 #define NRF_RESPONSE_SLOT_MS      100U
+/** @brief Slot time one TX burst needs with auto-retries; no TX starts closer to slot end */
+#define NRF_SLOT_TX_MIN_MS        10U
 /**
  * @brief Local NRF RX pipe for broadcast measure commands (same on every outdoor unit).
  * @note  Not NODE_ID — pipe 2 on IndoorUnit is node 1's reply pipe, not the command pipe.
  */
 #define NRF_PIPE_CMD              1U
+/** @brief Auto-retransmits per frame (SETUP_RETR ARC) */
+#define NRF_AUTO_RETR_COUNT       10U
+/** @brief Shortest auto-retransmit delay step; ARD = (step + 1) * 250 us */
+#define NRF_ARD_STEP_MIN          1U
+/** @brief Longest auto-retransmit delay step; a 3-frame burst must still fit one slot */
+#define NRF_ARD_STEP_MAX          3U
+/** @brief Retransmits per frame (moving average x16) above which ARD is lengthened */
+#define NRF_ARC_AVG_HIGH_Q4       (2U * 16U)
+/** @brief Retransmits per frame (moving average x16) below which ARD is shortened */
+#define NRF_ARC_AVG_LOW_Q4        (16U / 2U)
 /** @brief Max reply TX attempts before link recovery */
 #define NRF_TX_MAX_ATTEMPTS       3U
+/** @brief Max frames per reply, loaded back-to-back (nRF24 TX FIFO depth) */
+#define NRF_TX_MAX_FRAMES         3U
+/** @brief Delta replies between keyframes; also refreshes the key after value drift */
+#define NRF_KEYFRAME_INTERVAL     16U
+/** @brief Unacknowledged measurements kept in RAM (oldest dropped when full) */
+#define OUTDOOR_BACKLOG_DEPTH     24U
 
 /** Shared command address — must match IndoorUnit NRF_BROADCAST_ADDR */
 static const uint8_t NRF_BROADCAST_ADDR[5] = {0xB0U, 0xB0U, 0xB0U, 0xB0U, 0xB0U};
@@ -70,7 +95,8 @@ static const uint8_t NRF_BROADCAST_ADDR[5] = {0xB0U, 0xB0U, 0xB0U, 0xB0U, 0xB0U}
 /**
  * @brief Channels transmitted by this outdoor unit (edit per station hardware).
  * @note  Must match sensors included in measurement.h (BMP280_H vs BME280_H).
- *        Max WS_MAX_READINGS (5) entries per frame.
+ *        Up to WS_MAX_READINGS (8) entries; all fit in one v2 frame, while
+ *        v1 (USE_PROTOCOL_V2 = 0) splits more than 5 into fragment frames.
  */
 #if defined(BMP280_H)
 static const uint8_t ENABLED_CHANNELS[] = {
@@ -108,9 +134,21 @@ typedef enum {
   OUT_LINK_IDLE = 0,          /**< RX mode, waiting for commands */
   OUT_LINK_MEASURING,         /**< Running measurement state machine */
   OUT_LINK_TX_SENDING,        /**< Transmitting data, waiting for ACK/timeout */
+  OUT_LINK_BACKLOG_SENDING,   /**< Uploading buffered measurements after a live reply */
   OUT_LINK_RECOVERY,          /**< Error recovery: reset NRF and return to IDLE */
 } OutdoorLinkStateEnum_t;
 
+/**
+ * @brief Reply link statistics from the nRF24 auto-retransmit counters
+ */
+typedef struct {
+  uint16_t tx_frames;              /**< Frames acknowledged by the indoor unit */
+  uint16_t tx_retransmits;         /**< Auto-retransmits of acknowledged frames (OBSERVE_TX ARC_CNT) */
+  uint16_t tx_lost;                /**< Frames dropped after MAX_RT (what OBSERVE_TX PLOS_CNT counts) */
+  uint8_t arc_avg_q4;              /**< Moving average of retransmits per frame, x16 */
+  uint8_t ard_step;                /**< Auto-retransmit delay step in use */
+} OutdoorLinkStats_t;
+
 /**
  * @brief OutdoorLink context structure for state machine management
  */
@@ -125,14 +163,36 @@ typedef struct {
   uint8_t last_status;             /**< Last NRF status register snapshot */
   uint8_t last_cycle_id;           /**< Last accepted measure cycle id */
   uint8_t have_last_cycle_id;      /**< 1 when last_cycle_id is valid */
-  uint8_t tx_delay_armed;          /**< Waiting for NODE_ID response slot */
+  uint8_t last_full_cycle_id;      /**< Last accepted full-cycle id (no WS_CMD_CYCLE_PARTIAL) */
+  uint8_t have_last_full_cycle_id; /**< 1 when last_full_cycle_id is valid */
+  uint8_t tx_delay_armed;          /**< Waiting for the response slot */
+  uint8_t slot_assigned;           /**< 1 when the last command carried a slot schedule */
   uint8_t tx_attempt_count;        /**< Reply TX attempts in current cycle */
+  uint8_t key_request;             /**< Next reply must be a keyframe (boot or indoor request) */
+  uint8_t key_age;                 /**< Delta replies acknowledged since the last keyframe */
+  uint8_t tx_acked_frames;         /**< Frames acknowledged in the current TX burst */
+  uint32_t cmd_clock_s;            /**< Indoor clock from the last accepted command (s, 0 = unknown) */
+  uint32_t cmd_rx_tick;            /**< Tick when the last command was accepted */
+  uint32_t slot_start_tick;        /**< Start of the assigned reply slot (slot_assigned) */
+  uint32_t slot_end_tick;          /**< End of the reply slot; TX, retries and backlog stop here */
   uint32_t tx_start_tick;          /**< Tick when TX was initiated */
   uint32_t meas_start_tick;        /**< Tick when measurement cycle began */
   uint32_t tx_ready_tick;          /**< Earliest tick allowed to send response */
+  OutdoorLinkStats_t stats;        /**< Reply link quality and retransmit tuning */
   OutdoorLinkStateEnum_t state;    /**< Current link state machine state */
 } OutdoorLinkContext_t;
 
+/**
+ * @brief Measurement whose reply was never acknowledged (offline backlog)
+ * @details Stored as a v2 fixed-point frame; re-encoded as a backlog frame
+ *          with its age against the indoor clock when the link is back.
+ */
+typedef struct {
+  uint32_t clock_s;                        /**< Indoor clock of the measure command (s) */
+  uint8_t len;                             /**< Length of @ref frame */
+  uint8_t frame[WS_PROTOCOL_V2_MAX_SIZE];  /**< Readings as a v2 frame */
+} OutdoorBacklogRecord_t;
+
 /**
  * @brief OutdoorUnit operation status codes
  */
@@ -149,8 +209,9 @@ typedef enum {
 /* ============================================================================
  * External Variables (defined in outdoor_station.c)
  * ============================================================================ */
-extern uint8_t txPayload[WS_PROTOCOL_MAX_PAYLOAD]; /**< NRF TX wire buffer */
-extern uint8_t txPayloadLen;                     /**< Encoded payload length */
+extern uint8_t txPayload[NRF_TX_MAX_FRAMES][WS_PROTOCOL_MAX_PAYLOAD]; /**< NRF TX wire frames */
+extern uint8_t txPayloadLen[NRF_TX_MAX_FRAMES];  /**< Encoded length of each frame */
+extern uint8_t txPayloadCount;                   /**< Frames in the current reply */
 extern char Message[128];             /**< Message buffer for UART transfer */
 extern uint8_t Length;                /**< Message length */
 
@@ -164,16 +225,17 @@ extern OutdoorLinkContext_t outLink;  /**< OutdoorLink state machine context */
  * NRF24L01 Address Configuration (Multiceiver)
  * ============================================================================
  * Indoor central station:
- *   Broadcast TX   = {0xB0, 0xB0, 0xB0, 0xB0, 0xB0} (parallel measure, NoAck)
- *   Unicast TX[n]  = {0xE7+n, 0xE7, 0xE7, 0xE7, 0xE7} (single-node measure)
- *   RX Pipe 1..4   = {0xC2+n, 0xC2, ...} node reply pipes
+ *   Broadcast TX   = {0xB0, 0xB0, 0xB0, 0xB0, 0xB0} (every measure command, NoAck;
+ *                    single-node polls set one bit of target_mask)
+ *   RX Pipe 1..5   = {0xC2+p, 0xC2, ...} reply pipes, shared by nodes p, p+5, ...
  *
  * This outdoor unit (NODE_ID):
- *   TX_ADDR = {0xC2+NODE_ID, 0xC2, ...} -> Indoor reply RX pipe (1+NODE_ID)
+ *   TX_ADDR = {0xC2+(NODE_ID % 5), 0xC2, ...} -> Indoor reply RX pipe WS_REPLY_PIPE(NODE_ID)
+ *   Replies carry NODE_ID in their first byte (WS_Reply_Wrap) so Indoor can
+ *   tell nodes on the same pipe apart; TDMA slots keep them off the air together.
  *   Pipe 0 = TX_ADDR (auto-ACK for replies)
  *   Pipe NRF_PIPE_CMD (1) = broadcast command address (shared by all outdoors)
  * ============================================================================ */
 extern const uint8_t NRF_TX_ADDR[5];  /**< TX address for this outdoor unit */
-extern const uint8_t NRF_RX_ADDR[5];  /**< Legacy unique RX (unused for commands; kept for reference) */
 
 #endif /* MEASUREMENT_UNIT_CONFIG_H */
\ No newline at end of file
@@ -0,0 +1,68 @@
+/**
+ * @file    uart_tx.h
+ * @brief   Non-blocking USART1 transmit through a ring buffer
+ * @details Debug lines, profile dumps and error messages share USART1.
+ *          Writers copy their bytes into the ring and return at once; the
+ *          TXE interrupt drains the ring one contiguous chunk at a time,
+ *          restarted from HAL_UART_TxCpltCallback(). A
+ *          message that does not fit is dropped whole and counted instead of
+ *          waiting for space.
+ */
+
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stdint.h>
+
+#include "usart.h"
+
+/** @brief Ring capacity in bytes (power of two) */
+#define UART_TX_BUFFER_SIZE 512U
+
+/**
+ * @brief Drain the ring with DMA (1) or the TXE interrupt (0)
+ * @details USART1_TX is hard-wired to DMA1 channel 4, which this unit uses
+ *          for I2C2_TX (BME280/BMP280 DMA transfers), so TX stays interrupt
+ *          driven. At 115200 baud that is one short IRQ per byte.
+ */
+#define UART_TX_USE_DMA 0
+
+/** @brief Flush timeout before STOP mode or a halt (a full ring takes 45 ms) */
+#define UART_TX_FLUSH_TIMEOUT_MS 100U
+
+/** @brief Timeout of blocking transmits on UARTs other than the ring's */
+#define UART_TX_BLOCKING_TIMEOUT_MS 100U
+
+/**
+ * @brief   Binds the ring to a UART
+ * @param   huart  Initialised UART handle (NULL disables queued TX)
+ */
+void UartTx_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief   Queues bytes for transmission
+ * @param   huart  Destination UART; any UART other than the bound one is
+ *                 written with a blocking HAL_UART_Transmit()
+ * @param   data   Bytes to send (copied before returning)
+ * @param   len    Number of bytes
+ * @retval  0 Queued (or sent)
+ * @retval  1 Invalid parameters, or ring full and the message dropped
+ * @note    Safe from interrupt handlers.
+ */
+uint8_t UartTx_Write(UART_HandleTypeDef *huart, const void *data, uint16_t len);
+
+/**
+ * @brief   Waits until every queued byte has been sent
+ * @param   timeout_ms  Upper bound on the wait
+ * @details Call before STOP mode or a halt. With interrupts masked the
+ *          transfer is driven by polling the DMA and UART handlers, and the
+ *          timeout is approximated from the core clock.
+ */
+void UartTx_Flush(uint32_t timeout_ms);
+
+/**
+ * @brief   Returns the number of messages dropped because the ring was full
+ */
+uint32_t UartTx_GetDropped(void);
+
+#endif /* UART_TX_H */
@@ -1,6 +1,9 @@
 /**
  * @file debug_log.c
  * @brief Simple UART debug logging implementation
+ * @details Lines are queued on the uart_tx ring and sent in the background,
+ *          so logging never waits for the UART. With `DEBUG_LOG_TOKENIZED`
+ *          the same calls send ws_logtok records stamped with the tick.
  */
 
 #include "debug_log.h"
@@ -9,6 +12,8 @@
 
 #include "usart.h"
 #include "main.h"
+#include "uart_tx.h"
+#include "ws_logtok.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -21,14 +26,47 @@ extern UART_HandleTypeDef huart1;
 static char debug_buffer[128];
 static uint32_t last_heartbeat_tick = 0;
 static uint32_t heartbeat_count = 0;
+static uint32_t tx_dropped_reported = 0;
 
 /* ============================================================================
  * PRIVATE FUNCTIONS
  * ========================================================================== */
 
+/* Reports the lines lost to a full ring once a line fits again. */
 static void debug_send(const char *str, uint16_t len) {
-  HAL_UART_Transmit(&huart1, (uint8_t *)str, len, 100);
+  if ((UartTx_Write(&huart1, str, len) == 0U) && (UartTx_GetDropped() != tx_dropped_reported)) {
+    tx_dropped_reported = UartTx_GetDropped();
+    Debug_LogValue("LOG:TX_DROPPED=", (int32_t)tx_dropped_reported);
+  }
+}
+
+#ifdef DEBUG_LOG_TOKENIZED
+/* The decoder reads strings from the ELF, so only flash addresses work as ids. */
+static uint8_t debug_in_flash(const char *str) {
+  uint32_t addr = (uint32_t)(uintptr_t)str;
+  return ((addr >= FLASH_BASE) && (addr <= FLASH_BANK1_END)) ? 1U : 0U;
+}
+
+/* Sends one record; returns 1 when str is not in flash (send text instead). */
+static uint8_t debug_token(WS_LogTokKind_t kind, const char *str, uint8_t nargs, int32_t a0, int32_t a1) {
+  WS_LogTok_Record_t rec;
+  uint8_t line[WS_LOGTOK_LINE_MAX];
+  uint16_t len;
+
+  if (debug_in_flash(str) == 0U) {
+    return 1U;
+  }
+  rec.kind = (uint8_t)kind;
+  rec.nargs = nargs;
+  rec.id = (uint32_t)(uintptr_t)str - WS_LOGTOK_ID_BASE;
+  rec.tick = HAL_GetTick();
+  rec.args[0] = a0;
+  rec.args[1] = a1;
+  len = WS_LogTok_Encode(&rec, line, sizeof(line));
+  debug_send((const char *)line, len);
+  return 0U;
 }
+#endif
 
 static void debug_format_uptime(uint32_t *hours, uint32_t *minutes, uint32_t *seconds) {
   uint32_t total_sec = HAL_GetTick() / 1000U;
@@ -108,11 +146,17 @@ void Debug_Init(void) {
 
 void Debug_Log(const char *msg) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_TEXT, msg, 0U, 0, 0) == 0U) return;
+#endif
   debug_print_timestamped(msg);
 }
 
 void Debug_LogValue(const char *msg, int32_t value) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_VALUE, msg, 1U, value, 0) == 0U) return;
+#endif
 
   uint32_t hours;
   uint32_t minutes;
@@ -130,6 +174,9 @@ void Debug_LogValue(const char *msg, int32_t value) {
 
 void Debug_LogHex(const char *msg, uint32_t value) {
   if (msg == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_HEX, msg, 1U, (int32_t)value, 0) == 0U) return;
+#endif
 
   uint32_t hours;
   uint32_t minutes;
@@ -151,6 +198,9 @@ void Debug_LogNrfInit(uint8_t success) {
 }
 
 void Debug_LogNrfInitRetry(uint8_t attempt, uint8_t max) {
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_FMT, "NRF:INIT_RETRY %u/%u", 2U, attempt, max) == 0U) return;
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "NRF:INIT_RETRY %u/%u", attempt, max);
   if (len > 0 && len < (int)sizeof(debug_buffer)) {
@@ -212,6 +262,12 @@ void Debug_LogSystemReady(uint8_t sensor_error_code) {
 
 void Debug_LogSensorError(uint8_t error_flag, const char *name) {
   if (name == NULL) return;
+#ifdef DEBUG_LOG_TOKENIZED
+  if ((debug_in_flash(name) != 0U) &&
+      (debug_token(WS_LOGTOK_FMT, "INIT:SENSOR_FAIL %s (0x%02X)", 2U, (int32_t)(uintptr_t)name, error_flag) == 0U)) {
+    return;
+  }
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "INIT:SENSOR_FAIL %s (0x%02X)", name, error_flag);
   if (len > 0 && len < (int)sizeof(debug_buffer)) {
@@ -242,6 +298,9 @@ void Debug_LogMeasDone(void) {
 }
 
 void Debug_LogMeasRetry(uint8_t attempt, uint8_t max) {
+#ifdef DEBUG_LOG_TOKENIZED
+  if (debug_token(WS_LOGTOK_FMT, "MEAS:RETRY %u/%u", 2U, attempt, max) == 0U) return;
+#endif
   int len = snprintf(debug_buffer, sizeof(debug_buffer),
                      "MEAS:RETRY %u/%u", attempt, max);
   if (len > 0 && len < (int)sizeof(debug_buffer)) {
@@ -7,6 +7,7 @@
 
 #include "measurement.h"
 #include "measurement_unit_config.h"
+#include "ws_profile.h"
 #include "stm32f1xx_hal_def.h"
 #include "stm32f1xx_hal_dma.h"
 #include <stdio.h>
@@ -484,6 +485,7 @@ static void Measurement_ReadBME280(Measurement_Context_t *ctx) {
  * @retval  None
  */
 static void Measurement_ReadAllSensors(Measurement_Context_t *ctx) {
+    WS_PROFILE_BEGIN(WS_PROF_MEAS_READ);
 #ifdef SI7021_H
     Measurement_ReadSi7021(ctx);
 #endif
@@ -502,6 +504,7 @@ static void Measurement_ReadAllSensors(Measurement_Context_t *ctx) {
 
     /* All sensors read, measurement cycle complete */
     ctx->state = MEAS_DONE;
+    WS_PROFILE_END(WS_PROF_MEAS_READ);
 }
 
 /**
@@ -834,6 +837,10 @@ static float Measurement_GetChannelValue(const Measurement_Data_t *data, uint8_t
     }
 }
 
+/* Every enabled channel must fit in WS_Readings_t; nothing is dropped at runtime. */
+_Static_assert(sizeof(ENABLED_CHANNELS) <= WS_MAX_READINGS,
+               "ENABLED_CHANNELS exceeds WS_MAX_READINGS");
+
 /**
  * @brief   Builds tagged readings from the latest measurement context data
  * @param   ctx   Pointer to measurement context structure
@@ -858,10 +865,6 @@ bool Measurement_BuildReadings(const Measurement_Context_t *ctx, WS_Readings_t *
             continue;
         }
 
-        if (out->count >= WS_MAX_READINGS) {
-            break;
-        }
-
         out->readings[out->count].channel_id = channel_id;
         out->readings[out->count].value = Measurement_GetChannelValue(&ctx->data, channel_id);
         out->count++;
@@ -871,25 +874,70 @@ bool Measurement_BuildReadings(const Measurement_Context_t *ctx, WS_Readings_t *
 }
 
 /**
- * @brief   Encodes measurement data into nRF24 wire buffer
- * @param   ctx       Pointer to measurement context structure
- * @param   buf       Destination buffer for encoded payload
- * @param   buf_size  Buffer capacity in bytes
- * @retval  uint8_t   Encoded length in bytes, 0 on failure
+ * @brief   Encodes measurement data into one or more nRF24 wire frames
+ * @param   ctx         Pointer to measurement context structure
+ * @param   seq         Sequence number stamped on fragments and keyframes (measure cycle id)
+ * @param   key         Acknowledged keyframe to send a delta against, or NULL
+ * @param   key_out     Receives the keyframe state when a keyframe is sent (may be NULL)
+ * @param   frames      Destination frames, each WS_PROTOCOL_MAX_PAYLOAD bytes;
+ *                      frames stay within WS_PROTOCOL_MAX_FRAME for the reply envelope
+ * @param   lens        Receives the encoded length of each frame
+ * @param   max_frames  Capacity of @p frames / @p lens
+ * @retval  uint8_t     Number of frames encoded, 0 on failure
+ * @details With USE_DELTA_FRAMES, sends a delta against @p key when every
+ *          channel stays within int8 counts of it, else a keyframe when
+ *          @p key_out is given. Otherwise prefers a single v2 fixed-point
+ *          frame (USE_PROTOCOL_V2), then a single v1 frame when the readings
+ *          fit, else v1 fragments sharing @p seq so the indoor unit can
+ *          reassemble them.
  */
-uint8_t Measurement_EncodePayload(const Measurement_Context_t *ctx, uint8_t *buf, uint8_t buf_size) {
+uint8_t Measurement_EncodeFrames(const Measurement_Context_t *ctx, uint8_t seq,
+                                 const WS_DeltaKey_t *key, WS_DeltaKey_t *key_out,
+                                 uint8_t frames[][WS_PROTOCOL_MAX_PAYLOAD], uint8_t *lens,
+                                 uint8_t max_frames) {
     WS_Readings_t readings;
-    uint8_t encoded_len = 0U;
 
-    if (!Measurement_BuildReadings(ctx, &readings)) {
+    if ((frames == NULL) || (lens == NULL) || (max_frames == 0U) ||
+        !Measurement_BuildReadings(ctx, &readings)) {
         return 0U;
     }
 
-    if (!WS_Protocol_Encode(&readings, buf, buf_size, &encoded_len)) {
+#if USE_DELTA_FRAMES
+    if ((key != NULL) &&
+        WS_Protocol_EncodeDelta(&readings, key, frames[0], WS_PROTOCOL_MAX_FRAME, &lens[0])) {
+        return 1U;
+    }
+    if ((key_out != NULL) &&
+        WS_Protocol_EncodeKeyframe(&readings, seq, frames[0], WS_PROTOCOL_MAX_FRAME, &lens[0], key_out)) {
+        return 1U;
+    }
+#else
+    (void)key;
+    (void)key_out;
+#endif
+
+#if USE_PROTOCOL_V2
+    if (WS_Protocol_EncodeV2(&readings, frames[0], WS_PROTOCOL_MAX_FRAME, &lens[0])) {
+        return 1U;
+    }
+#endif
+
+    if (readings.count <= WS_PROTOCOL_V1_MAX_READINGS) {
+        return WS_Protocol_Encode(&readings, frames[0], WS_PROTOCOL_MAX_FRAME, &lens[0]) ? 1U : 0U;
+    }
+
+    uint8_t total = WS_Protocol_FragmentCount(readings.count);
+    if (total > max_frames) {
         return 0U;
     }
 
-    return encoded_len;
+    for (uint8_t i = 0U; i < total; i++) {
+        if (!WS_Protocol_EncodeFragment(&readings, seq, i, frames[i], WS_PROTOCOL_MAX_FRAME, &lens[i])) {
+            return 0U;
+        }
+    }
+
+    return total;
 }
 
 /**
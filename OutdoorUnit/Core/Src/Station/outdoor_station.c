@@ -19,14 +19,33 @@
 #include "usart.h"
 #include "ws_protocol.h"
 #include "debug_log.h"
+#include "ws_profile.h"
 
 /** @brief Measurement context for sensor data acquisition */
 static Measurement_Context_t measCtx;
 
-/** @brief NRF TX wire buffer (encoded measurement payload) */
-uint8_t txPayload[WS_PROTOCOL_MAX_PAYLOAD];
-/** @brief Length of encoded payload in txPayload */
-uint8_t txPayloadLen;
+/** @brief NRF TX wire frames (encoded measurement reply) */
+uint8_t txPayload[NRF_TX_MAX_FRAMES][WS_PROTOCOL_MAX_PAYLOAD];
+/** @brief Length of each encoded frame in txPayload */
+uint8_t txPayloadLen[NRF_TX_MAX_FRAMES];
+/** @brief Number of frames in txPayload for the current reply */
+uint8_t txPayloadCount;
+
+#if USE_DELTA_FRAMES
+/** @brief Keyframe acknowledged by the indoor unit (delta reference) */
+static WS_DeltaKey_t txKey;
+/** @brief Keyframe in flight; becomes txKey once acknowledged */
+static WS_DeltaKey_t txKeyPending;
+#endif
+
+#if USE_OFFLINE_BACKLOG
+/** @brief Unacknowledged measurements, ring ordered oldest first */
+static OutdoorBacklogRecord_t backlog[OUTDOOR_BACKLOG_DEPTH];
+/** @brief Index of the oldest backlog record */
+static uint8_t backlog_head = 0U;
+/** @brief Number of queued backlog records */
+static uint8_t backlog_count = 0U;
+#endif
 
 /** @brief Message buffer for UART transfer */
 char Message[128];
@@ -45,11 +64,12 @@ static uint8_t nrf_available = 0U;
 /** @brief Tick of last periodic NRF reinit attempt */
 static uint32_t nrf_last_reinit_tick = 0U;
 
-/** @brief NRF TX address (multiceiver — derived from NODE_ID) */
-const uint8_t NRF_TX_ADDR[5] = {0xC2 + NODE_ID, 0xC2, 0xC2, 0xC2, 0xC2};
+#if NODE_ID >= WS_NODE_MASK_BITS
+#error "NODE_ID must fit in a WS_NodeMask_t"
+#endif
 
-/** @brief NRF RX address (multiceiver — derived from NODE_ID) */
-const uint8_t NRF_RX_ADDR[5] = {0xE7 + NODE_ID, 0xE7, 0xE7, 0xE7, 0xE7};
+/** @brief NRF TX address (multiceiver — address of the indoor reply pipe WS_REPLY_PIPE(NODE_ID)) */
+const uint8_t NRF_TX_ADDR[5] = {0xC2 + (NODE_ID % WS_REPLY_PIPES), 0xC2, 0xC2, 0xC2, 0xC2};
 
 #if CHECK_I2C_DEVICES
 static HAL_StatusTypeDef I2C_CheckAddress(I2C_HandleTypeDef *i2c);
@@ -67,7 +87,16 @@ static void OutdoorStation_TryReinitNrf(void);
 static void OutdoorStation_StartReceive(void);
 static void OutdoorStation_HandleIRQ(void);
 static void OutdoorStation_SendMeasurementData(void);
+static void OutdoorStation_StartTx(void);
+#if USE_OFFLINE_BACKLOG
+static void OutdoorStation_BacklogPush(void);
+static void OutdoorStation_BacklogPop(uint8_t count);
+static void OutdoorStation_SendBacklog(void);
+#endif
 static uint8_t OutdoorStation_TrySendAfterSlot(void);
+static uint8_t OutdoorStation_SlotHasRoom(void);
+static void OutdoorStation_TrackRetransmits(uint8_t arc);
+static void OutdoorStation_AdaptRetransmitDelay(void);
 static void OutdoorStation_InitLink(void);
 
 /* ============================================================================
@@ -368,15 +397,37 @@ void OutdoorStation_Process(void)
       {
         outLink.tx_done = 0;
         outLink.tx_in_progress = 0;
+        OutdoorStation_AdaptRetransmitDelay();
 
         if (outLink.tx_ok)
         {
           Debug_LogNrfTxResult(1U);
+#if USE_DELTA_FRAMES
+          if (txPayload[0][0] == WS_PROTOCOL_VERSION_KEY)
+          {
+            txKey = txKeyPending;
+            outLink.key_request = 0U;
+            outLink.key_age = 0U;
+          }
+          else if (txPayload[0][0] == WS_PROTOCOL_VERSION_DELTA)
+          {
+            outLink.key_age++;
+          }
+#endif
 #if USE_LED_INDICATOR
           Outdoor_LedOff();
 #endif
 #if USE_TIMER_PROFILING
           Debug_LogElapsedMs(HAL_GetTick() - outLink.tx_start_tick);
+#endif
+#if USE_OFFLINE_BACKLOG
+          /* Indoor is reachable again: upload what was missed right behind the reply. */
+          if ((backlog_count > 0U) && (OutdoorStation_SlotHasRoom() != 0U))
+          {
+            OutdoorStation_SendBacklog();
+            outLink.state = OUT_LINK_BACKLOG_SENDING;
+            break;
+          }
 #endif
           OutdoorStation_StartReceive();
           outLink.state = OUT_LINK_IDLE;
@@ -385,7 +436,7 @@ void OutdoorStation_Process(void)
 
         /* No ACK — retry a few times before recovery (Indoor may still be switching to RX). */
         Debug_LogNrfTxResult(0U);
-        if (outLink.tx_attempt_count < NRF_TX_MAX_ATTEMPTS)
+        if ((outLink.tx_attempt_count < NRF_TX_MAX_ATTEMPTS) && (OutdoorStation_SlotHasRoom() != 0U))
         {
           OutdoorStation_SendMeasurementData();
           break;
@@ -396,6 +447,9 @@ void OutdoorStation_Process(void)
 #endif
 #if USE_TIMER_PROFILING
         Debug_LogElapsedMs(HAL_GetTick() - outLink.tx_start_tick);
+#endif
+#if USE_OFFLINE_BACKLOG
+        OutdoorStation_BacklogPush();
 #endif
         OutdoorStation_StartReceive();
         outLink.state = OUT_LINK_IDLE;
@@ -419,16 +473,59 @@ void OutdoorStation_Process(void)
         Debug_LogElapsedMs(HAL_GetTick() - outLink.tx_start_tick);
 #endif
 
-        if (outLink.tx_attempt_count < NRF_TX_MAX_ATTEMPTS)
+        if ((outLink.tx_attempt_count < NRF_TX_MAX_ATTEMPTS) && (OutdoorStation_SlotHasRoom() != 0U))
         {
           OutdoorStation_SendMeasurementData();
           break;
         }
 
+#if USE_OFFLINE_BACKLOG
+        OutdoorStation_BacklogPush();
+#endif
         outLink.state = OUT_LINK_RECOVERY;
       }
       break;
 
+#if USE_OFFLINE_BACKLOG
+    case OUT_LINK_BACKLOG_SENDING:
+      if (!outLink.tx_done)
+      {
+        uint8_t st = NRF24_GetStatus(&nrf);
+        if (st & (NRF24_STATUS_TX_DS | NRF24_STATUS_MAX_RT))
+        {
+          OutdoorStation_HandleIRQ();
+        }
+      }
+
+      if (outLink.tx_done)
+      {
+        outLink.tx_done = 0;
+        outLink.tx_in_progress = 0;
+        OutdoorStation_AdaptRetransmitDelay();
+
+        /* Frames ahead of a MAX_RT were acknowledged; keep only the rest. */
+        OutdoorStation_BacklogPop(outLink.tx_acked_frames);
+        if (outLink.tx_ok && (backlog_count > 0U) && (OutdoorStation_SlotHasRoom() != 0U))
+        {
+          OutdoorStation_SendBacklog();
+          break;
+        }
+
+        Debug_LogValue("NRF:BACKLOG_LEFT=", (int32_t)backlog_count);
+        OutdoorStation_StartReceive();
+        outLink.state = OUT_LINK_IDLE;
+        break;
+      }
+
+      if (outLink.tx_in_progress && (HAL_GetTick() - outLink.tx_start_tick) > NRF_TX_TIMEOUT_MS)
+      {
+        OutdoorStation_BacklogPop(outLink.tx_acked_frames);
+        Debug_LogNrfTimeout();
+        outLink.state = OUT_LINK_RECOVERY;
+      }
+      break;
+#endif
+
     case OUT_LINK_RECOVERY:
 
 #if USE_LED_INDICATOR
@@ -519,9 +616,8 @@ static void Outdoor_LedOff(void)
  */
 static void NRF_DelayUs(uint32_t us)
 {
-  /* Enable DWT if not already enabled */
+  /* Enable DWT if not already enabled; never reset CYCCNT (ws_profile zones) */
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
-  DWT->CYCCNT = 0;
   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   uint32_t cycles = (SystemCoreClock / 1000000U) * us;
@@ -558,7 +654,7 @@ static HAL_StatusTypeDef OutdoorStation_InitCommunication(void)
     NRF24_SetPALevel(&nrf, NRF24_PA_MAX);
     NRF24_SetCRC(&nrf, NRF24_CRC_2B);
     NRF24_SetAddressWidth(&nrf, NRF24_AW_5);
-    NRF24_SetAutoRetr(&nrf, 1, 10);
+    NRF24_SetAutoRetr(&nrf, NRF_ARD_STEP_MIN, NRF_AUTO_RETR_COUNT);
 
     /* Configure addresses (multiceiver - derived from NODE_ID) */
     NRF24_SetTXAddress(&nrf, NRF_TX_ADDR, 5);
@@ -573,6 +669,10 @@ static HAL_StatusTypeDef OutdoorStation_InitCommunication(void)
     NRF24_EnablePipe(&nrf, NRF_PIPE_CMD, 1);
     NRF24_SetPayloadSize(&nrf, 0, NRF_PAYLOAD_SIZE);
     NRF24_SetPayloadSize(&nrf, NRF_PIPE_CMD, NRF_CMD_SIZE);
+#if NRF_DYNAMIC_PAYLOAD
+    /* PTX needs DPL on pipe 0; the command pipe keeps its static WS_CMD_SIZE width. */
+    NRF24_EnableDynamicPayload(&nrf, 0, 1);
+#endif
 
     Debug_LogNrfInit(1U);
     Debug_LogNrfListening();
@@ -647,6 +747,7 @@ static void OutdoorStation_StartReceive(void)
  */
 static void OutdoorStation_HandleIRQ(void)
 {
+  WS_PROFILE_BEGIN(WS_PROF_NRF_IRQ);
   uint8_t status = NRF24_GetStatus(&nrf);
   outLink.last_status = status;
 
@@ -667,14 +768,14 @@ static void OutdoorStation_HandleIRQ(void)
     }
 
     uint8_t cycle_id = 0U;
-    uint8_t target_mask = WS_CMD_TARGET_ALL;
+    WS_NodeMask_t target_mask = WS_CMD_TARGET_ALL;
     if (!WS_Cmd_DecodeMeasureEx(rx_data, NRF_CMD_SIZE, &cycle_id, &target_mask))
     {
       Debug_Log("NRF:RX_DROP_DECODE");
     }
     else
     {
-      uint8_t node_bit = (uint8_t)(1U << NODE_ID);
+      WS_NodeMask_t node_bit = WS_NODE_BIT(NODE_ID);
       Debug_LogNrfRxCmd();
       if ((target_mask != WS_CMD_TARGET_ALL) && ((target_mask & node_bit) == 0U))
       {
@@ -686,8 +787,36 @@ static void OutdoorStation_HandleIRQ(void)
       }
       else
       {
+        /* Full cycles number consecutively; a gap means missed commands, so
+           resync on a fresh keyframe. Retry and single-node polls count apart. */
+        if (WS_Cmd_IsCycleGap(cycle_id, outLink.last_full_cycle_id, outLink.have_last_full_cycle_id))
+        {
+          outLink.key_request = 1U;
+        }
+        if ((cycle_id & WS_CMD_CYCLE_PARTIAL) == 0U)
+        {
+          outLink.last_full_cycle_id = cycle_id;
+          outLink.have_last_full_cycle_id = 1U;
+        }
+        if ((WS_Cmd_KeyframeMask(rx_data, NRF_CMD_SIZE) & node_bit) != 0U)
+        {
+          outLink.key_request = 1U;
+        }
         outLink.last_cycle_id = cycle_id;
         outLink.have_last_cycle_id = 1U;
+        outLink.cmd_clock_s = WS_Cmd_GetClock(rx_data, NRF_CMD_SIZE);
+
+        /* TDMA: slots count from command reception, ordered by NODE_ID within target_mask. */
+        uint16_t lead_ms = 0U;
+        uint8_t slot_ms = 0U;
+        outLink.cmd_rx_tick = HAL_GetTick();
+        outLink.slot_assigned = WS_Cmd_GetSlots(rx_data, NRF_CMD_SIZE, &lead_ms, &slot_ms) ? 1U : 0U;
+        if (outLink.slot_assigned != 0U)
+        {
+          uint8_t slot = WS_Cycle_SlotIndex(target_mask, WS_Cmd_LateMask(rx_data, NRF_CMD_SIZE), NODE_ID);
+          outLink.slot_start_tick = outLink.cmd_rx_tick + lead_ms + ((uint32_t)slot * slot_ms);
+          outLink.slot_end_tick = outLink.slot_start_tick + slot_ms;
+        }
         outLink.cmd_received = 1;
       }
     }
@@ -695,12 +824,23 @@ static void OutdoorStation_HandleIRQ(void)
   NRF24_ClearIRQ(&nrf, NRF24_STATUS_RX_DR);
   status = NRF24_GetStatus(&nrf);
 
-  /* TX complete (ACK received) */
+  /* TX complete (ACK received) — a multi-frame reply is done once the FIFO drains */
   if (status & NRF24_STATUS_TX_DS)
   {
     NRF24_ClearIRQ(&nrf, NRF24_STATUS_TX_DS);
-    outLink.tx_ok = 1;
-    outLink.tx_done = 1;
+    outLink.tx_acked_frames++;
+    outLink.stats.tx_frames++;
+    OutdoorStation_TrackRetransmits(NRF24_GetObserveTX(&nrf) & 0x0FU);
+    if ((NRF24_GetFIFOStatus(&nrf) & NRF24_FIFO_TX_EMPTY) != 0U)
+    {
+      outLink.tx_ok = 1;
+      outLink.tx_done = 1;
+    }
+    else
+    {
+      /* SetMode(TX) pulses CE, which sends exactly one queued frame. */
+      NRF24_SetMode(&nrf, NRF24_MODE_TX);
+    }
   }
 
   /* Max retries reached (no ACK) */
@@ -708,36 +848,69 @@ static void OutdoorStation_HandleIRQ(void)
   {
     NRF24_ClearIRQ(&nrf, NRF24_STATUS_MAX_RT);
     NRF24_FlushTX(&nrf);
+    outLink.stats.tx_lost++;
+    OutdoorStation_TrackRetransmits(NRF_AUTO_RETR_COUNT);
     outLink.tx_ok = 0;
     outLink.tx_done = 1;
   }
+
+  WS_PROFILE_END(WS_PROF_NRF_IRQ);
 }
 
 /**
  * @brief   Encodes measurement data and starts NRF24 TX
  * @retval  None
  * @details Sends header-only frame when no channel readings are available.
+ *          Multi-frame replies are loaded into the TX FIFO back-to-back; a
+ *          retry resends every fragment and the indoor unit drops duplicates.
+ *          With USE_DELTA_FRAMES the reply is a delta against the last
+ *          acknowledged keyframe unless a keyframe is due.
  */
 static void OutdoorStation_SendMeasurementData(void)
 {
-  uint8_t wire[NRF_PAYLOAD_SIZE] = {0};
-
-  txPayloadLen = Measurement_EncodePayload(&measCtx, txPayload, sizeof(txPayload));
-  if (txPayloadLen == 0U)
+  WS_PROFILE_BEGIN(WS_PROF_TX_ENCODE);
+#if USE_DELTA_FRAMES
+  const WS_DeltaKey_t *key = NULL;
+  if ((txKey.valid != 0U) && (outLink.key_request == 0U) && (outLink.key_age < NRF_KEYFRAME_INTERVAL))
+  {
+    key = &txKey;
+  }
+  txPayloadCount = Measurement_EncodeFrames(&measCtx, outLink.last_cycle_id, key, &txKeyPending,
+                                            txPayload, txPayloadLen, NRF_TX_MAX_FRAMES);
+#else
+  txPayloadCount = Measurement_EncodeFrames(&measCtx, outLink.last_cycle_id, NULL, NULL,
+                                            txPayload, txPayloadLen, NRF_TX_MAX_FRAMES);
+#endif
+  if (txPayloadCount == 0U)
   {
     /* ponytail: header-only frame still carries sensor_status */
     WS_Readings_t readings = {.sensor_status = measCtx.data.sensorStatus, .count = 0U};
-    (void)WS_Protocol_Encode(&readings, txPayload, sizeof(txPayload), &txPayloadLen);
+    (void)WS_Protocol_Encode(&readings, txPayload[0], WS_PROTOCOL_MAX_FRAME, &txPayloadLen[0]);
+    txPayloadCount = 1U;
   }
 
-  memcpy(wire, txPayload, txPayloadLen);
+  outLink.tx_attempt_count++;
+  OutdoorStation_StartTx();
+  WS_PROFILE_END(WS_PROF_TX_ENCODE);
+}
+
+/**
+ * @brief   Loads txPayload frames into the TX FIFO and starts transmission
+ * @retval  None
+ * @details The first frame goes out immediately; HandleIRQ pulses the rest
+ *          on each TX_DS and counts them in tx_acked_frames.
+ */
+static void OutdoorStation_StartTx(void)
+{
+  uint8_t wire[NRF_PAYLOAD_SIZE];
+  uint8_t wire_len = 0U;
 
   /* Prepare TX state */
   outLink.irq_flag = 0;
   outLink.tx_done = 0;
   outLink.tx_ok = 0;
   outLink.tx_in_progress = 1;
-  outLink.tx_attempt_count++;
+  outLink.tx_acked_frames = 0U;
   outLink.tx_start_tick = HAL_GetTick();
 
   /* Re-assert reply address (Pipe0 must match TX_ADDR for Auto-ACK). */
@@ -746,35 +919,220 @@ static void OutdoorStation_SendMeasurementData(void)
   NRF24_SetRXAddress(&nrf, 0, NRF_TX_ADDR, 5);
   NRF24_FlushTX(&nrf);
   NRF24_ClearIRQ(&nrf, NRF24_STATUS_IRQ_MASK);
-  NRF24_WritePayload(&nrf, wire, NRF_PAYLOAD_SIZE);
+  for (uint8_t i = 0U; i < txPayloadCount; i++)
+  {
+    /* Reply pipes are shared between nodes: Indoor demultiplexes on the node id byte. */
+    memset(wire, 0, sizeof(wire));
+    if (!WS_Reply_Wrap(NODE_ID, txPayload[i], txPayloadLen[i], wire, sizeof(wire), &wire_len))
+    {
+      Debug_LogValue("NRF:TX_DROP_FRAME len=", (int32_t)txPayloadLen[i]);
+      continue;
+    }
+#if NRF_DYNAMIC_PAYLOAD
+    /* DPL: only the encoded bytes go on air (a delta is a fraction of 32 B). */
+    NRF24_WritePayload(&nrf, wire, wire_len);
+#else
+    NRF24_WritePayload(&nrf, wire, NRF_PAYLOAD_SIZE);
+#endif
+  }
   NRF24_SetMode(&nrf, NRF24_MODE_TX);
 }
 
+#if USE_OFFLINE_BACKLOG
 /**
- * @brief   Arms NODE_ID response slot and sends when the slot is due
+ * @brief   Queues the current measurement after its reply was never acknowledged
+ * @retval  None
+ * @details Stored as a v2 frame stamped with the command's indoor clock; when
+ *          the ring is full the oldest record is overwritten.
+ */
+static void OutdoorStation_BacklogPush(void)
+{
+  WS_Readings_t readings;
+  OutdoorBacklogRecord_t rec;
+
+  (void)Measurement_BuildReadings(&measCtx, &readings);
+  if (!WS_Protocol_EncodeV2(&readings, rec.frame, sizeof(rec.frame), &rec.len))
+  {
+    return;
+  }
+  rec.clock_s = outLink.cmd_clock_s;
+
+  if (backlog_count == OUTDOOR_BACKLOG_DEPTH)
+  {
+    backlog_head = (uint8_t)((backlog_head + 1U) % OUTDOOR_BACKLOG_DEPTH);
+    backlog_count--;
+    Debug_Log("NRF:BACKLOG_DROP");
+  }
+  backlog[(backlog_head + backlog_count) % OUTDOOR_BACKLOG_DEPTH] = rec;
+  backlog_count++;
+  Debug_LogValue("NRF:BACKLOG_PUSH n=", (int32_t)backlog_count);
+}
+
+/**
+ * @brief   Drops the oldest backlog records after they were acknowledged
+ * @param   count  Number of records to drop (clamped to the queue size)
+ * @retval  None
+ */
+static void OutdoorStation_BacklogPop(uint8_t count)
+{
+  if (count > backlog_count)
+  {
+    count = backlog_count;
+  }
+  backlog_head = (uint8_t)((backlog_head + count) % OUTDOOR_BACKLOG_DEPTH);
+  backlog_count = (uint8_t)(backlog_count - count);
+}
+
+/**
+ * @brief   Encodes the oldest backlog records and sends them as one burst
+ * @retval  None
+ * @details Up to NRF_TX_MAX_FRAMES backlog frames are queued in the TX FIFO;
+ *          each carries its age against the current command's indoor clock.
+ */
+static void OutdoorStation_SendBacklog(void)
+{
+  WS_Readings_t readings;
+
+  txPayloadCount = 0U;
+  for (uint8_t i = 0U; (i < backlog_count) && (txPayloadCount < NRF_TX_MAX_FRAMES); i++)
+  {
+    const OutdoorBacklogRecord_t *rec = &backlog[(backlog_head + i) % OUTDOOR_BACKLOG_DEPTH];
+    uint32_t age_s = 0U;
+
+    /* Age is unknown (0) unless both ends of the interval came from the indoor RTC. */
+    if ((rec->clock_s != 0U) && (outLink.cmd_clock_s >= rec->clock_s))
+    {
+      age_s = outLink.cmd_clock_s - rec->clock_s;
+    }
+    if (age_s > 0xFFFFU)
+    {
+      age_s = 0xFFFFU;
+    }
+
+    if (!WS_Protocol_Decode(rec->frame, rec->len, &readings) ||
+        !WS_Protocol_EncodeBacklog(&readings, (uint16_t)age_s, txPayload[txPayloadCount],
+                                   WS_PROTOCOL_MAX_FRAME, &txPayloadLen[txPayloadCount]))
+    {
+      break;
+    }
+    txPayloadCount++;
+  }
+
+  if (txPayloadCount == 0U)
+  {
+    /* Unencodable head record: drop it so the queue cannot stall. */
+    OutdoorStation_BacklogPop(1U);
+    outLink.tx_acked_frames = 0U;
+    outLink.tx_ok = 0;
+    outLink.tx_done = 1;
+    return;
+  }
+
+  OutdoorStation_StartTx();
+}
+#endif
+
+/**
+ * @brief   Arms the reply slot and sends when the slot is due
  * @retval  1U  TX was started
- * @retval  0U  Still waiting for the staggered response window
- * @details First call arms tx_ready_tick using NRF_RESPONSE_BASE_MS and
- *          NODE_ID * NRF_RESPONSE_SLOT_MS; subsequent calls start TX once due.
+ * @retval  0U  Still waiting for the slot, or the slot was missed (link back to IDLE)
+ * @details With a slot schedule in the command the slot is fixed relative to
+ *          command reception. Without one, the first call arms tx_ready_tick
+ *          NRF_RESPONSE_BASE_MS + NODE_ID * NRF_RESPONSE_SLOT_MS after the
+ *          measurement and the slot lasts NRF_RESPONSE_SLOT_MS. A measurement that
+ *          overruns its slot is not sent live: it would collide with the next node.
  */
 static uint8_t OutdoorStation_TrySendAfterSlot(void)
 {
   if (!outLink.tx_delay_armed)
   {
     outLink.tx_delay_armed = 1U;
-    /* Base delay: Indoor must leave broadcast TX and enter Multiceiver RX. */
-    outLink.tx_ready_tick = HAL_GetTick() + NRF_RESPONSE_BASE_MS + (NODE_ID * NRF_RESPONSE_SLOT_MS);
+    if (outLink.slot_assigned != 0U)
+    {
+      outLink.tx_ready_tick = outLink.slot_start_tick;
+    }
+    else
+    {
+      /* Base delay: Indoor must leave broadcast TX and enter Multiceiver RX. */
+      outLink.tx_ready_tick = HAL_GetTick() + NRF_RESPONSE_BASE_MS + (NODE_ID * NRF_RESPONSE_SLOT_MS);
+      outLink.slot_end_tick = outLink.tx_ready_tick + NRF_RESPONSE_SLOT_MS;
+    }
   }
 
-  if (HAL_GetTick() < outLink.tx_ready_tick)
+  if ((int32_t)(HAL_GetTick() - outLink.tx_ready_tick) < 0)
   {
     return 0U;
   }
 
+  if (OutdoorStation_SlotHasRoom() == 0U)
+  {
+    Debug_LogValue("NRF:SLOT_MISSED late_ms=", (int32_t)(HAL_GetTick() - outLink.slot_end_tick));
+#if USE_LED_INDICATOR
+    Outdoor_LedOff();
+#endif
+#if USE_OFFLINE_BACKLOG
+    OutdoorStation_BacklogPush();
+#endif
+    OutdoorStation_StartReceive();
+    outLink.state = OUT_LINK_IDLE;
+    return 0U;
+  }
+
   OutdoorStation_SendMeasurementData();
   return 1U;
 }
 
+/**
+ * @brief   Checks whether one more TX burst fits before the reply slot ends
+ * @retval  1U  At least NRF_SLOT_TX_MIN_MS of the slot is left
+ * @retval  0U  Slot over; sending now would overlap the next node's slot
+ */
+static uint8_t OutdoorStation_SlotHasRoom(void)
+{
+  return ((int32_t)(outLink.slot_end_tick - HAL_GetTick()) >= (int32_t)NRF_SLOT_TX_MIN_MS) ? 1U : 0U;
+}
+
+/**
+ * @brief   Folds one frame's auto-retransmit count into the link average
+ * @param   arc  Retransmits of the frame (ARC_CNT; NRF_AUTO_RETR_COUNT when lost)
+ * @retval  None
+ */
+static void OutdoorStation_TrackRetransmits(uint8_t arc)
+{
+  outLink.stats.tx_retransmits += arc;
+  /* avg += (16 * arc - avg) / 8, kept in integer x16 form */
+  outLink.stats.arc_avg_q4 = (uint8_t)(outLink.stats.arc_avg_q4 - (outLink.stats.arc_avg_q4 >> 3U) + (arc << 1U));
+}
+
+/**
+ * @brief   Adjusts the auto-retransmit delay to the observed retransmit rate
+ * @retval  None
+ * @details Frequent retransmits mean interference or collisions: a longer ARD
+ *          spreads the retries past the disturbance. A clean link steps back
+ *          to the shortest ARD so a burst leaves the slot as early as possible.
+ *          Called between bursts; the radio is re-armed right after.
+ */
+static void OutdoorStation_AdaptRetransmitDelay(void)
+{
+  uint8_t step = outLink.stats.ard_step;
+
+  if ((outLink.stats.arc_avg_q4 > NRF_ARC_AVG_HIGH_Q4) && (step < NRF_ARD_STEP_MAX))
+  {
+    step++;
+  }
+  else if ((outLink.stats.arc_avg_q4 < NRF_ARC_AVG_LOW_Q4) && (step > NRF_ARD_STEP_MIN))
+  {
+    step--;
+  }
+
+  if (step != outLink.stats.ard_step)
+  {
+    outLink.stats.ard_step = step;
+    NRF24_SetAutoRetr(&nrf, step, NRF_AUTO_RETR_COUNT);
+    Debug_LogValue("NRF:ARD_STEP=", (int32_t)step);
+  }
+}
+
 /**
  * @brief   Resets OutdoorLink context to idle defaults
  * @retval  None
@@ -791,8 +1149,20 @@ static void OutdoorStation_InitLink(void)
   outLink.last_status = 0U;
   outLink.last_cycle_id = 0U;
   outLink.have_last_cycle_id = 0U;
+  outLink.last_full_cycle_id = 0U;
+  outLink.have_last_full_cycle_id = 0U;
   outLink.tx_delay_armed = 0U;
   outLink.tx_attempt_count = 0U;
+  outLink.key_request = 1U;
+  outLink.key_age = 0U;
+  outLink.tx_acked_frames = 0U;
+  outLink.cmd_clock_s = 0U;
+  outLink.slot_assigned = 0U;
+  outLink.cmd_rx_tick = 0U;
+  outLink.slot_start_tick = 0U;
+  outLink.slot_end_tick = 0U;
+  memset(&outLink.stats, 0, sizeof(outLink.stats));
+  outLink.stats.ard_step = NRF_ARD_STEP_MIN;
   outLink.tx_start_tick = 0U;
   outLink.meas_start_tick = 0U;
   outLink.tx_ready_tick = 0U;
@@ -11,6 +11,7 @@
 #include "power_mgr.h"
 
 #include "debug_log.h"
+#include "uart_tx.h"
 
 /**
  * @brief True when NRF IRQ already requests a wake (pin low or EXTI pending)
@@ -50,6 +51,8 @@ void PowerMgr_EnterIdleStop(void)
   }
 
   Debug_Log("PWR:ENTER");
+  /* STOP halts the USART mid-byte and wakes on HSI: finish queued lines. */
+  UartTx_Flush(UART_TX_FLUSH_TIMEOUT_MS);
   PowerMgr_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
 
   SystemClock_Config();
@@ -0,0 +1,142 @@
+/**
+ * @file ws_logtok.c
+ * @brief Tokenized debug log record encoding and decoding
+ * @details Shared verbatim with the host decoder; no HAL calls.
+ */
+
+#include "ws_logtok.h"
+
+/** @brief CRC-8 (poly 0x07, init 0) over @p len bytes */
+static uint8_t ws_logtok_crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0U;
+
+  for (size_t i = 0U; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0U; bit < 8U; bit++) {
+      crc = ((crc & 0x80U) != 0U) ? (uint8_t)((crc << 1) ^ 0x07U) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+/** @brief Appends a LEB128 varint; returns the new length */
+static size_t ws_logtok_put_varint(uint8_t *body, size_t pos, uint32_t value) {
+  while (value >= 0x80U) {
+    body[pos++] = (uint8_t)((value & 0x7FU) | 0x80U);
+    value >>= 7;
+  }
+  body[pos++] = (uint8_t)value;
+  return pos;
+}
+
+/** @brief Reads a LEB128 varint of at most 5 bytes */
+static bool ws_logtok_get_varint(const uint8_t *body, size_t len, size_t *pos, uint32_t *value) {
+  uint32_t result = 0U;
+
+  for (uint8_t shift = 0U; shift < 35U; shift += 7U) {
+    uint8_t byte;
+    if (*pos >= len) {
+      return false;
+    }
+    byte = body[(*pos)++];
+    result |= (uint32_t)(byte & 0x7FU) << shift;
+    if ((byte & 0x80U) == 0U) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Whether a body byte must be escaped on the wire */
+static bool ws_logtok_needs_escape(uint8_t byte) {
+  return (byte == (uint8_t)'\n') || (byte == (uint8_t)'\r') || (byte == WS_LOGTOK_ESC) ||
+         (byte == WS_LOGTOK_SYNC);
+}
+
+uint16_t WS_LogTok_Encode(const WS_LogTok_Record_t *rec, uint8_t *buf, size_t size) {
+  uint8_t body[WS_LOGTOK_BODY_MAX];
+  size_t body_len = 0U;
+  size_t out = 0U;
+
+  if ((rec == NULL) || (buf == NULL) || (rec->kind >= (uint8_t)WS_LOGTOK_KIND_COUNT) ||
+      (rec->nargs > WS_LOGTOK_MAX_ARGS)) {
+    return 0U;
+  }
+
+  body[body_len++] = (uint8_t)(rec->kind | (uint8_t)(rec->nargs << 4));
+  body_len = ws_logtok_put_varint(body, body_len, rec->id);
+  body_len = ws_logtok_put_varint(body, body_len, rec->tick);
+  for (uint8_t i = 0U; i < rec->nargs; i++) {
+    uint32_t v = (uint32_t)rec->args[i];
+    body_len = ws_logtok_put_varint(body, body_len, (v << 1) ^ ((rec->args[i] < 0) ? 0xFFFFFFFFUL : 0U));
+  }
+  body[body_len] = ws_logtok_crc8(body, body_len);
+  body_len++;
+
+  if (size < 2U) {
+    return 0U;
+  }
+  buf[out++] = WS_LOGTOK_SYNC;
+  for (size_t i = 0U; i < body_len; i++) {
+    if (ws_logtok_needs_escape(body[i])) {
+      if ((out + 2U) > (size - 1U)) {
+        return 0U;
+      }
+      buf[out++] = WS_LOGTOK_ESC;
+      buf[out++] = (uint8_t)(body[i] ^ 0x20U);
+    } else {
+      if ((out + 1U) > (size - 1U)) {
+        return 0U;
+      }
+      buf[out++] = body[i];
+    }
+  }
+  buf[out++] = (uint8_t)'\n';
+  return (uint16_t)out;
+}
+
+bool WS_LogTok_Decode(const uint8_t *line, size_t len, WS_LogTok_Record_t *out) {
+  uint8_t body[WS_LOGTOK_BODY_MAX];
+  size_t body_len = 0U;
+  size_t pos = 1U;
+
+  if ((line == NULL) || (out == NULL) || (len < 2U) || (line[0] != WS_LOGTOK_SYNC)) {
+    return false;
+  }
+
+  for (size_t i = 1U; i < len; i++) {
+    uint8_t byte = line[i];
+    if (byte == WS_LOGTOK_ESC) {
+      if (++i >= len) {
+        return false;
+      }
+      byte = (uint8_t)(line[i] ^ 0x20U);
+    }
+    if (body_len >= sizeof(body)) {
+      return false;
+    }
+    body[body_len++] = byte;
+  }
+
+  if ((body_len < 4U) || (ws_logtok_crc8(body, body_len - 1U) != body[body_len - 1U])) {
+    return false;
+  }
+  body_len--;
+
+  out->kind = (uint8_t)(body[0] & 0x0FU);
+  out->nargs = (uint8_t)((body[0] >> 4) & 0x07U);
+  if ((out->kind >= (uint8_t)WS_LOGTOK_KIND_COUNT) || (out->nargs > WS_LOGTOK_MAX_ARGS) ||
+      !ws_logtok_get_varint(body, body_len, &pos, &out->id) ||
+      !ws_logtok_get_varint(body, body_len, &pos, &out->tick)) {
+    return false;
+  }
+  for (uint8_t i = 0U; i < out->nargs; i++) {
+    uint32_t zz;
+    if (!ws_logtok_get_varint(body, body_len, &pos, &zz)) {
+      return false;
+    }
+    out->args[i] = (int32_t)((zz >> 1) ^ (0U - (zz & 1U)));
+  }
+  return pos == body_len;
+}
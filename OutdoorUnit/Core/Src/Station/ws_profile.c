@@ -0,0 +1,103 @@
+/**
+ * @file    ws_profile.c
+ * @brief   Zone statistics on the DWT cycle counter
+ * @details Compiled only when `WS_PROFILE_ENABLE` is set. Output format:
+ *          `PROF:<zone> n=<count> min=<cyc> avg=<cyc> max=<cyc> max_us=<us>`.
+ */
+
+#include "ws_profile.h"
+
+#if WS_PROFILE_ENABLE
+
+#include "uart_tx.h"
+
+#include <stdio.h>
+
+/** @brief Zone names, indexed by WS_ProfileZone_t */
+static const char *const WS_PROFILE_ZONE_NAMES[WS_PROF_ZONE_COUNT] = {
+  "NRF_IRQ",
+  "MEAS_READ",
+  "TX_ENCODE",
+};
+
+static WS_ProfileStats_t ws_profile_stats[WS_PROF_ZONE_COUNT];
+/** Scratch buffer for one dump line. */
+static char ws_profile_line[80];
+/** WS_PROF_MEAS_READ count at the last periodic dump. */
+static uint32_t ws_profile_last_dump_cycles;
+
+void WS_Profile_Init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  WS_Profile_Reset();
+}
+
+void WS_Profile_Task(UART_HandleTypeDef *huart) {
+  uint32_t cycles = ws_profile_stats[WS_PROF_MEAS_READ].count;
+
+  if ((cycles - ws_profile_last_dump_cycles) >= WS_PROFILE_DUMP_EVERY_CYCLES) {
+    ws_profile_last_dump_cycles = cycles;
+    WS_Profile_Dump(huart);
+  }
+}
+
+void WS_Profile_Reset(void) {
+  for (uint8_t i = 0U; i < (uint8_t)WS_PROF_ZONE_COUNT; i++) {
+    ws_profile_stats[i].count = 0U;
+    ws_profile_stats[i].min_cycles = UINT32_MAX;
+    ws_profile_stats[i].max_cycles = 0U;
+    ws_profile_stats[i].total_cycles = 0U;
+  }
+  ws_profile_last_dump_cycles = 0U;
+}
+
+void WS_Profile_Record(WS_ProfileZone_t zone, uint32_t cycles) {
+  if ((uint8_t)zone >= (uint8_t)WS_PROF_ZONE_COUNT) {
+    return;
+  }
+
+  WS_ProfileStats_t *stats = &ws_profile_stats[zone];
+  stats->count++;
+  stats->total_cycles += cycles;
+  if (cycles < stats->min_cycles) {
+    stats->min_cycles = cycles;
+  }
+  if (cycles > stats->max_cycles) {
+    stats->max_cycles = cycles;
+  }
+}
+
+const WS_ProfileStats_t *WS_Profile_GetStats(WS_ProfileZone_t zone) {
+  if ((uint8_t)zone >= (uint8_t)WS_PROF_ZONE_COUNT) {
+    return NULL;
+  }
+  return &ws_profile_stats[zone];
+}
+
+void WS_Profile_Dump(UART_HandleTypeDef *huart) {
+  uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+  if ((huart == NULL) || (cycles_per_us == 0U)) {
+    return;
+  }
+
+  for (uint8_t i = 0U; i < (uint8_t)WS_PROF_ZONE_COUNT; i++) {
+    const WS_ProfileStats_t *stats = &ws_profile_stats[i];
+    uint32_t min_cycles = (stats->count != 0U) ? stats->min_cycles : 0U;
+    uint32_t avg_cycles = (stats->count != 0U) ? (uint32_t)(stats->total_cycles / stats->count) : 0U;
+
+    int len = snprintf(ws_profile_line, sizeof(ws_profile_line),
+                       "PROF:%s n=%lu min=%lu avg=%lu max=%lu max_us=%lu\r\n",
+                       WS_PROFILE_ZONE_NAMES[i],
+                       (unsigned long)stats->count,
+                       (unsigned long)min_cycles,
+                       (unsigned long)avg_cycles,
+                       (unsigned long)stats->max_cycles,
+                       (unsigned long)(stats->max_cycles / cycles_per_us));
+    if ((len > 0) && (len < (int)sizeof(ws_profile_line))) {
+      (void)UartTx_Write(huart, ws_profile_line, (uint16_t)len);
+    }
+  }
+}
+
+#endif /* WS_PROFILE_ENABLE */
@@ -29,8 +29,10 @@
 #include "outdoor_station.h"
 #include "power_mgr.h"
 #include "debug_log.h"
+#include "uart_tx.h"
 #include "measurement.h"
 #include "measurement_unit_config.h"
+#include "ws_profile.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -105,7 +107,9 @@ int main(void)
   MX_SPI1_Init();
   /* USER CODE BEGIN 2 */
 
+  UartTx_Init(&huart1);
   Debug_Init();
+  WS_Profile_Init();
 
   if (OutdoorStation_Init() != HAL_OK)
   {
@@ -132,6 +136,8 @@ int main(void)
     Debug_Heartbeat();
 #endif
 
+    WS_Profile_Task(&huart1);
+
   }
   /* USER CODE END 3 */
 }
@@ -182,6 +188,8 @@ void Error_Handler_WithName(const char *function_name)
 #if USE_UART_LOGGING
   char error_msg[80];
   snprintf(error_msg, sizeof(error_msg), "ERROR: Failure in function '%s'\r\n", function_name);
+  /* Let queued debug lines finish; the UART is idle afterwards. */
+  UartTx_Flush(UART_TX_FLUSH_TIMEOUT_MS);
   HAL_UART_Transmit(&huart1, (uint8_t *)error_msg, strlen(error_msg), HAL_MAX_DELAY);
 #else
   (void)function_name; /* Suppress unused parameter warning */
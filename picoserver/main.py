@@ -22,8 +22,11 @@ UART_ID = 0
 UART_BAUDRATE = 115200
 UART_TX_PIN = 0
 UART_RX_PIN = 1
-MAX_UART_LINE_BYTES = 240
+# Exported STM32 log lines arrive as RSP:<json> (up to ~320 bytes).
+MAX_UART_LINE_BYTES = 400
 UART_EXCHANGE_TIMEOUT_S = 5
+# CMD:EXPORT pages (16 lines each) fetched per /api/backfill request at most.
+BACKFILL_MAX_PAGES = 120
 
 # API and storage settings
 RANGE_SECONDS = {
@@ -98,6 +101,7 @@ STATION_DATA = {}
 AGGREGATE_STATE = {}
 _aggregate_cleanup_days = {}
 _uart_response_line = None
+_uart_response_lines = None
 _uart_cmd_lock = None
 _api_heavy_lock = None
 _MEM_FREE_MIN = None
@@ -310,7 +314,11 @@ def _parse_uart_measurement_line(line):
 
 def _deliver_uart_response(line):
     global _uart_response_line
-    if _uart_response_line is None:
+    if _uart_response_lines is not None:
+        _uart_response_lines.append(line)
+        return
+    # RSP/END lines of an abandoned multi-line reply are not an answer.
+    if _uart_response_line is None and not line.startswith("RSP:") and not line.startswith("END:"):
         _uart_response_line = line
 
 
@@ -339,6 +347,42 @@ async def uart_exchange(cmd_line, timeout_s=UART_EXCHANGE_TIMEOUT_S):
         raise asyncio.TimeoutError()
 
 
+async def uart_exchange_lines(cmd_line, timeout_s=UART_EXCHANGE_TIMEOUT_S):
+    """Send a command answered by ACK, RSP lines and END (or ERR); return all lines.
+
+    The timeout restarts with every received line, so long replies only time
+    out when the STM32 stops sending.
+    """
+    global _uart_response_lines
+
+    async with _get_uart_cmd_lock():
+        lines = []
+        _uart_response_lines = lines
+        try:
+            uart.write((cmd_line + "\r\n").encode())
+            try:
+                uart.flush()
+            except AttributeError:
+                pass
+
+            print("UART TX:", cmd_line)
+
+            seen = 0
+            deadline = time.ticks_add(time.ticks_ms(), int(timeout_s * 1000))
+            while time.ticks_diff(deadline, time.ticks_ms()) > 0:
+                if len(lines) != seen:
+                    seen = len(lines)
+                    if ws_uart.is_uart_reply_end(lines[-1]):
+                        return lines
+                    deadline = time.ticks_add(time.ticks_ms(), int(timeout_s * 1000))
+                await asyncio.sleep_ms(10)
+        finally:
+            _uart_response_lines = None
+
+        print("UART timeout waiting for response to:", cmd_line)
+        raise asyncio.TimeoutError()
+
+
 def _verify_sd_write_ready():
     if not _is_sd_available():
         return False
@@ -1058,6 +1102,147 @@ async def api_ping(request):
         return {"status": "error", "error": str(e)}, 500
 
 
+def _station_index(station_id):
+    # Node mask width; the STM32 replies ERR:UNKNOWN past its own node count.
+    if len(station_id) < 2 or station_id[0] != "S":
+        return None
+    try:
+        index = int(station_id[1:])
+    except ValueError:
+        return None
+    if index < 0 or index > 31:
+        return None
+    return index
+
+
+def _uart_error_reply(cmd, response):
+    if response == "ERR:BUSY":
+        return {"status": "busy", "command": cmd, "response": response}, 409
+    if response.startswith("ERR:"):
+        return {"status": "error", "command": cmd, "response": response}, 400
+    return {"status": "unexpected", "command": cmd, "response": response}, 502
+
+
+@app.route("/api/config", methods=["GET", "POST"])
+async def api_config(request):
+    """Read (GET) or change (POST ?interval=&nodes=&radio=ch,pa,rate) STM32 settings."""
+    gc.collect()
+    if _get_uart_cmd_lock().locked():
+        return {"status": "busy", "error": "uart exchange in progress"}, 409
+
+    config = {}
+    cmd = ""
+    try:
+        for name in ws_uart.CFG_NAMES:
+            value = None
+            if request.method == "POST":
+                value = request.args.get(name.lower(), "") or None
+            cmd = ws_uart.build_cfg_cmd(name, value)
+            response = str(await uart_exchange(cmd)).strip()
+            key, text = ws_uart.parse_cfg_ack(response)
+            if key != name:
+                return _uart_error_reply(cmd, response)
+            config[name.lower()] = text
+        return {"status": "ok", "config": config}
+    except asyncio.TimeoutError:
+        return {"status": "timeout", "command": cmd}, 504
+    except Exception as e:
+        return {"status": "error", "error": str(e)}, 500
+
+
+@app.route("/api/stats")
+async def api_stats(request):
+    gc.collect()
+    if _get_uart_cmd_lock().locked():
+        return {"status": "busy", "error": "uart exchange in progress"}, 409
+
+    try:
+        lines = await uart_exchange_lines(ws_uart.CMD_STATS)
+        if not lines[-1].startswith("END:"):
+            return _uart_error_reply(ws_uart.CMD_STATS, lines[-1])
+        nodes = []
+        for line in lines:
+            node, stats = ws_uart.parse_stats_line(line)
+            if node is not None:
+                stats["node"] = node
+                nodes.append(stats)
+        return {"status": "ok", "nodes": nodes}
+    except asyncio.TimeoutError:
+        return {"status": "timeout", "command": ws_uart.CMD_STATS}, 504
+    except Exception as e:
+        return {"status": "error", "error": str(e)}, 500
+
+
+@app.route("/api/backfill", methods=["POST"])
+async def api_backfill(request):
+    """Copy one day of the STM32 SD log into the station log (?station=S0&day=YYYYMMDD).
+
+    Entries whose timestamp is already logged are skipped, so the call fills
+    gaps left while the Pico was offline. Aggregates are not rebuilt.
+    """
+    station = _safe_station_id(request.args.get("station", ""))
+    index = _station_index(station)
+    day = request.args.get("day", "")
+    if index is None:
+        return {"error": "invalid station id"}, 400
+    if len(day) != 8 or not day.isdigit():
+        return {"error": "invalid day, expected YYYYMMDD"}, 400
+    if not SD_WRITE_READY or not _is_sd_available():
+        return {"status": "error", "error": "sd_unavailable"}, 503
+    if _get_uart_cmd_lock().locked():
+        return {"status": "busy", "error": "uart exchange in progress"}, 409
+
+    async with _get_api_heavy_lock():
+        known = set()
+        for entry in _iter_sd_log_entries(station):
+            if _timestamp_day_key(entry.get("timestamp", "")) == day:
+                known.add(entry["timestamp"])
+        gc.collect()
+
+        part = None
+        offset = 0
+        received = 0
+        added = 0
+        complete = False
+        cmd = ""
+        try:
+            for _ in range(BACKFILL_MAX_PAGES):
+                cmd = ws_uart.build_export_cmd(index, day, part, offset)
+                lines = await uart_exchange_lines(cmd)
+                end = ws_uart.parse_export_end(lines[-1])
+                if end is None:
+                    if lines[-1] == "ERR:NOFILE":
+                        complete = True
+                        break
+                    return _uart_error_reply(cmd, lines[-1])
+                for line in lines:
+                    if not line.startswith("RSP:"):
+                        continue
+                    received += 1
+                    entry, _ = _entry_from_json_line(line[4:])
+                    if entry is None or entry["timestamp"] in known:
+                        continue
+                    known.add(entry["timestamp"])
+                    log_station_to_sd(station, entry)
+                    added += 1
+                part = end["part"]
+                offset = end["offset"]
+                if end["eof"]:
+                    complete = True
+                    break
+                gc.collect()
+        except asyncio.TimeoutError:
+            return {"status": "timeout", "command": cmd, "received": received, "added": added}, 504
+
+        return {
+            "status": "ok" if complete else "partial",
+            "station": station,
+            "day": day,
+            "received": received,
+            "added": added,
+        }
+
+
 @app.route("/api/logs")
 async def api_logs(request):
     station = request.args.get("station", "all")
@@ -1142,6 +1327,8 @@ async def uart_reading_task():
                 if chunk:
                     for byte in chunk:
                         if byte == 10 or byte == 13:
+                            if buffer and buffer[0] == ws_uart.UART_LOG_TOKEN_SYNC:
+                                buffer = bytearray()
                             if buffer:
                                 try:
                                     line = buffer.decode().strip()
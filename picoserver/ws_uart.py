@@ -1,11 +1,23 @@
-"""Weather Station UART protocol: tagged DATA lines and CMD/ACK text commands."""
+"""Weather Station UART protocol: tagged DATA lines and CMD/ACK text commands.
+
+Multi-line replies (CMD:STATS, CMD:EXPORT) are ACK:<NAME>, RSP:<data> lines,
+then END:<NAME>=<summary>, or ERR:<reason> instead of the END line.
+"""
 
 UART_DATA_PREFIX = "DATA:"
 UART_LOG_PREFIXES = ("LOG:", "INFO:", "DBG:", "TRACE:", "SYS:")
-UART_CONTROL_PREFIXES = ("ACK:", "ERR:")
+UART_CONTROL_PREFIXES = ("ACK:", "ERR:", "RSP:", "END:")
+# First byte of a tokenized debug record (DEBUG_LOG_TOKENIZED firmware builds);
+# decoded on a PC with tools/ws_protocol_host/ws_logdecode, not here.
+UART_LOG_TOKEN_SYNC = 0x1E
 
 CMD_MEASURE = "CMD:MEASURE"
 CMD_PING = "CMD:PING"
+CMD_STATS = "CMD:STATS"
+CMD_EXPORT = "CMD:EXPORT"
+CMD_CFG = "CMD:CFG:"
+CFG_NAMES = ("INTERVAL", "NODES", "RADIO")
+STATS_FIELDS = ("polls", "replies", "timeouts", "miss_streak", "success_q8", "backoff")
 
 CHANNEL_FIELDS = {
     0x01: "si7021_temp",
@@ -76,6 +88,74 @@ def build_measure_cmd(node=None):
     return CMD_MEASURE + ":" + str(int(node))
 
 
+def build_cfg_cmd(name, value=None):
+    name = str(name).upper()
+    if name not in CFG_NAMES:
+        raise ValueError("unknown setting")
+    if value is None:
+        return CMD_CFG + name
+    return CMD_CFG + name + "=" + str(value)
+
+
+def build_export_cmd(station_index, day_key, part=None, offset=None):
+    cmd = "{}:{}:{}".format(CMD_EXPORT, int(station_index), int(day_key))
+    if part is not None:
+        cmd += ":{}:{}".format(int(part), int(offset or 0))
+    return cmd
+
+
+def is_uart_reply_end(line):
+    upper = str(line).strip().upper()
+    return upper.startswith("END:") or upper.startswith("ERR:")
+
+
+def parse_cfg_ack(line):
+    """ACK:<NAME>=<value> -> (name, value text), or (None, None)."""
+    raw = str(line).strip()
+    if not raw.startswith("ACK:") or "=" not in raw:
+        return None, None
+    name, value = raw[4:].split("=", 1)
+    return name, value
+
+
+def parse_stats_line(line):
+    """RSP:N<i>=polls,replies,... -> (node, dict), or (None, None)."""
+    raw = str(line).strip()
+    if not raw.startswith("RSP:N") or "=" not in raw:
+        return None, None
+    node_text, values_text = raw[5:].split("=", 1)
+    values = values_text.split(",")
+    if len(values) != len(STATS_FIELDS):
+        return None, None
+    try:
+        node = int(node_text)
+        stats = {}
+        for index in range(len(STATS_FIELDS)):
+            stats[STATS_FIELDS[index]] = int(values[index])
+    except ValueError:
+        return None, None
+    return node, stats
+
+
+def parse_export_end(line):
+    """END:EXPORT=<lines>,<part>,<offset>[,EOF] -> dict, or None."""
+    raw = str(line).strip()
+    if not raw.startswith("END:EXPORT="):
+        return None
+    fields = raw[len("END:EXPORT="):].split(",")
+    if len(fields) not in (3, 4) or (len(fields) == 4 and fields[3] != "EOF"):
+        return None
+    try:
+        return {
+            "lines": int(fields[0]),
+            "part": int(fields[1]),
+            "offset": int(fields[2]),
+            "eof": len(fields) == 4,
+        }
+    except ValueError:
+        return None
+
+
 def _extract_measurement_frame(line):
     raw = str(line).strip()
     if not raw:
@@ -294,4 +374,22 @@ def self_check():
     assert build_measure_cmd(2) == "CMD:MEASURE:2"
     assert is_uart_control_line("ACK:PING")
     assert is_uart_control_line("ERR:BUSY")
+    assert is_uart_control_line('RSP:{"station_id":"S0"}')
+    assert is_uart_reply_end("END:STATS=2")
+    assert not is_uart_reply_end("RSP:N0=1,1,0,0,255,0")
+
+    assert build_cfg_cmd("interval") == "CMD:CFG:INTERVAL"
+    assert build_cfg_cmd("NODES", "0x3") == "CMD:CFG:NODES=0x3"
+    assert parse_cfg_ack("ACK:RADIO=76,3,1") == ("RADIO", "76,3,1")
+    assert build_export_cmd(1, 20260509) == "CMD:EXPORT:1:20260509"
+    assert build_export_cmd(1, 20260509, 2, 4096) == "CMD:EXPORT:1:20260509:2:4096"
+
+    node, stats = parse_stats_line("RSP:N1=12,10,2,0,230,1")
+    assert node == 1
+    assert stats["timeouts"] == 2 and stats["success_q8"] == 230
+
+    end = parse_export_end("END:EXPORT=16,0,5120")
+    assert end == {"lines": 16, "part": 0, "offset": 5120, "eof": False}
+    assert parse_export_end("END:EXPORT=3,1,900,EOF")["eof"]
+    assert parse_export_end("END:EXPORT=3,1") is None
     return True
@@ -0,0 +1,257 @@
+/**
+ * @file ws_binlog2json.c
+ * @brief Converts binary SD day files (Sn_YYMMDD.wsb) back to JSON Lines
+ * @details Uses the firmware's ws_logfmt.c, so every line is formatted by
+ *          the same code that writes log_Sn.json on the indoor unit.
+ *          --from / --to limit output to a time-of-day window; the header's
+ *          hourly index is used to seek to the first record of the window.
+ *          Backlog records (measured during a link outage, logged late) sit
+ *          after the index position of their hour and are still found,
+ *          because the scan always runs to the header's record count. Bytes
+ *          after that count are unused preallocation and are never read;
+ *          records before it whose sequence or CRC fails are reported and
+ *          skipped.
+ *          Usage: ws_binlog2json [--from HH:MM] [--to HH:MM] file.wsb...
+ *                 ws_binlog2json --self-test
+ */
+
+#include "ws_logfmt.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BINLOG_LINE_MAX 320U
+
+/** @brief Parses HH:MM into seconds of the day; returns -1 on error */
+static long binlog_parse_hhmm(const char *s) {
+  unsigned int h = 0U;
+  unsigned int m = 0U;
+  if ((sscanf(s, "%u:%u", &h, &m) != 2) || (h > 23U) || (m > 59U)) {
+    return -1L;
+  }
+  return (long)((h * 3600U) + (m * 60U));
+}
+
+/**
+ * @brief Prints the records of one day file whose time of day is in [from_s, to_s]
+ * @retval 0 Success, 1 unreadable or foreign file
+ */
+static int binlog_convert(FILE *f, const char *name, long from_s, long to_s, FILE *out) {
+  uint8_t header[WS_LOGFMT_BIN_HEADER_SIZE];
+  uint8_t record[WS_LOGFMT_BIN_RECORD_SIZE];
+  char line[BINLOG_LINE_MAX];
+  uint16_t first = WS_LOGFMT_BIN_INDEX_NONE;
+  uint32_t count;
+  uint32_t rec;
+  uint32_t day_epoch = 0U;
+  uint8_t file_station = 0U;
+
+  if ((fread(header, 1U, sizeof(header), f) != sizeof(header)) ||
+      !WS_LogFmt_BinCheckHeader(header, &file_station, &day_epoch)) {
+    fprintf(stderr, "%s: not a WSLB v%u day file\n", name, (unsigned int)WS_LOGFMT_BIN_VERSION);
+    return 1;
+  }
+
+  for (uint8_t h = (uint8_t)(from_s / 3600L); h < WS_LOGFMT_BIN_INDEX_SLOTS; h++) {
+    first = WS_LogFmt_BinIndexGet(header, h);
+    if (first != WS_LOGFMT_BIN_INDEX_NONE) {
+      break;
+    }
+  }
+  if ((first == WS_LOGFMT_BIN_INDEX_NONE) || (from_s == 0L)) {
+    first = 0U;
+  }
+  count = WS_LogFmt_BinCount(header);
+  if ((from_s > 0L) &&
+      (fseek(f, (long)WS_LOGFMT_BIN_HEADER_SIZE + ((long)first * WS_LOGFMT_BIN_RECORD_SIZE), SEEK_SET) != 0)) {
+    return 1;
+  }
+
+  for (rec = first; (rec < count) && (fread(record, 1U, sizeof(record), f) == sizeof(record)); rec++) {
+    WS_Readings_t readings;
+    WS_LogTime_t t;
+    uint32_t epoch = 0U;
+    uint8_t station = 0U;
+    uint16_t len = 0U;
+    long tod;
+
+    if (!WS_LogFmt_BinVerify(record, (uint16_t)rec, file_station, day_epoch)) {
+      fprintf(stderr, "%s: skipping corrupt record %lu\n", name, (unsigned long)rec);
+      continue;
+    }
+    if (!WS_LogFmt_BinDecode(record, &epoch, &station, &readings)) {
+      fprintf(stderr, "%s: skipping malformed record\n", name);
+      continue;
+    }
+    tod = (long)(epoch % WS_LOGFMT_DAY_S);
+    if ((tod < from_s) || (tod > to_s)) {
+      continue;
+    }
+    WS_LogFmt_EpochToTime(epoch, &t);
+    if (WS_LogFmt_Json(station, &t, &readings, line, sizeof(line), &len)) {
+      fwrite(line, 1U, len, out);
+    }
+  }
+  return 0;
+}
+
+/** @brief Checks epoch conversion against libc for every day of 2000..2099 */
+static int binlog_check_calendar(void) {
+  for (long day = 10957L; day < 47482L; day++) {
+    time_t when = (time_t)(day * 86400L + 45296L); /* 12:34:56 */
+    struct tm tm_utc;
+    WS_LogTime_t t;
+
+    gmtime_r(&when, &tm_utc);
+    WS_LogFmt_EpochToTime((uint32_t)when, &t);
+    if ((t.year != (uint8_t)(tm_utc.tm_year - 100)) || (t.month != (uint8_t)(tm_utc.tm_mon + 1)) ||
+        (t.date != (uint8_t)tm_utc.tm_mday) || (t.hours != 12U) || (t.minutes != 34U) ||
+        (t.seconds != 56U) || (WS_LogFmt_TimeToEpoch(&t) != (uint32_t)when)) {
+      fprintf(stderr, "calendar mismatch at day %ld\n", day);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Writes a day file, converts it back and compares with the firmware's JSON */
+static int binlog_self_test(void) {
+  static const WS_LogTime_t times[] = {
+      {26U, 5U, 9U, 0U, 0U, 0U},
+      {26U, 5U, 9U, 11U, 6U, 1U},
+      {26U, 5U, 9U, 23U, 59U, 59U},
+  };
+  char expected[3][BINLOG_LINE_MAX];
+  char actual[3 * BINLOG_LINE_MAX];
+  uint8_t buf[WS_LOGFMT_BIN_HEADER_SIZE];
+  uint16_t len = 0U;
+  size_t expected_len = 0U;
+  uint32_t day_epoch;
+  WS_Readings_t r;
+  FILE *f;
+
+  if (binlog_check_calendar() != 0) {
+    return 1;
+  }
+
+  f = tmpfile();
+  if (f == NULL) {
+    perror("tmpfile");
+    return 1;
+  }
+  day_epoch = WS_LogFmt_TimeToEpoch(&times[0]);
+  WS_LogFmt_BinHeader(0U, day_epoch, buf);
+  WS_LogFmt_BinSetCount(buf, 3U);
+  for (uint8_t i = 0U; i < 3U; i++) {
+    buf[WS_LOGFMT_BIN_INDEX_OFFSET(times[i].hours)] = i;
+    buf[WS_LOGFMT_BIN_INDEX_OFFSET(times[i].hours) + 1U] = 0U;
+  }
+  fwrite(buf, 1U, sizeof(buf), f);
+
+  for (uint8_t i = 0U; i < 3U; i++) {
+    uint8_t record[WS_LOGFMT_BIN_RECORD_SIZE];
+    r.sensor_status = (i == 1U) ? (uint8_t)(WS_SENSOR_ERR_SI7021 | WS_SENSOR_ERR_TSL2561) : (uint8_t)WS_SENSOR_OK;
+    r.count = 4U;
+    r.readings[0].channel_id = WS_CH_SI7021_TEMP;
+    r.readings[0].value = -4.37f + (float)i;
+    r.readings[1].channel_id = WS_CH_SI7021_HUM;
+    r.readings[1].value = 65.2f;
+    r.readings[2].channel_id = WS_CH_BMP280_PRESS;
+    r.readings[2].value = 1013.25f;
+    r.readings[3].channel_id = WS_CH_TSL2561_LUX;
+    r.readings[3].value = 120.0f;
+    if (!WS_LogFmt_BinEncode(WS_LogFmt_TimeToEpoch(&times[i]), 0U, &r, record) ||
+        !WS_LogFmt_Json(0U, &times[i], &r, expected[i], sizeof(expected[i]), &len)) {
+      fprintf(stderr, "encode failed\n");
+      return 1;
+    }
+    WS_LogFmt_BinSeal(record, i, day_epoch);
+    if (!WS_LogFmt_BinVerify(record, i, 0U, day_epoch) || WS_LogFmt_BinVerify(record, i + 1U, 0U, day_epoch) ||
+        WS_LogFmt_BinVerify(record, i, 1U, day_epoch) ||
+        WS_LogFmt_BinVerify(record, i, 0U, day_epoch + WS_LOGFMT_DAY_S)) {
+      fprintf(stderr, "seal/verify failed\n");
+      return 1;
+    }
+    fwrite(record, 1U, sizeof(record), f);
+    if (i == 2U) {
+      /* Stale record in the preallocated tail, past the record count. */
+      fwrite(record, 1U, sizeof(record), f);
+    }
+  }
+
+  for (long from = 0L; from <= 12L * 3600L; from += 12L * 3600L) {
+    FILE *out = tmpfile();
+    size_t n;
+    if (out == NULL) {
+      perror("tmpfile");
+      return 1;
+    }
+    rewind(f);
+    if (binlog_convert(f, "self-test", from, (long)WS_LOGFMT_DAY_S - 1L, out) != 0) {
+      return 1;
+    }
+    rewind(out);
+    n = fread(actual, 1U, sizeof(actual) - 1U, out);
+    actual[n] = '\0';
+    fclose(out);
+
+    expected_len = 0U;
+    for (uint8_t i = (from == 0L) ? 0U : 2U; i < 3U; i++) {
+      if (strncmp(&actual[expected_len], expected[i], strlen(expected[i])) != 0) {
+        fprintf(stderr, "mismatch (from %ld):\n%s\nexpected:\n%s", from, &actual[expected_len], expected[i]);
+        return 1;
+      }
+      expected_len += strlen(expected[i]);
+    }
+    if (n != expected_len) {
+      fprintf(stderr, "unexpected output length %zu (from %ld)\n", n, from);
+      return 1;
+    }
+  }
+  fclose(f);
+  printf("ws_binlog2json self-test OK\n");
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  long from_s = 0L;
+  long to_s = (long)WS_LOGFMT_DAY_S - 1L;
+  int rc = 0;
+  int i = 1;
+
+  if ((argc == 2) && (strcmp(argv[1], "--self-test") == 0)) {
+    return binlog_self_test();
+  }
+
+  for (; (i + 1 < argc) && (strncmp(argv[i], "--", 2) == 0); i += 2) {
+    long value = binlog_parse_hhmm(argv[i + 1]);
+    if (value < 0L) {
+      break;
+    }
+    if (strcmp(argv[i], "--from") == 0) {
+      from_s = value;
+    } else if (strcmp(argv[i], "--to") == 0) {
+      to_s = value + 59L;
+    } else {
+      break;
+    }
+  }
+  if (i >= argc) {
+    fprintf(stderr, "usage: %s [--from HH:MM] [--to HH:MM] file.wsb...\n"
+                    "       %s --self-test\n", argv[0], argv[0]);
+    return 2;
+  }
+
+  for (; i < argc; i++) {
+    FILE *f = fopen(argv[i], "rb");
+    if (f == NULL) {
+      perror(argv[i]);
+      return 2;
+    }
+    rc |= binlog_convert(f, argv[i], from_s, to_s, stdout);
+    fclose(f);
+  }
+  return rc;
+}
@@ -0,0 +1,456 @@
+/**
+ * @file ws_logdecode.c
+ * @brief Expands tokenized debug log records (DEBUG_LOG_TOKENIZED) into text
+ * @details Reads a UART capture or the indoor unit's SD `status_log`, passes
+ *          text lines through unchanged and formats every record line with
+ *          the strings of the firmware ELF that produced it (the record id is
+ *          the string's flash address). Records are parsed by the firmware's
+ *          ws_logtok.c. Lines look like the text mode output: with a TIME
+ *          record seen (indoor RTC) `LOG:[YYYY-MM-DD HH:MM:SS] ...`, before
+ *          that `LOG:[HH:MM:SS] ...` uptime. Use the ELF of the exact build
+ *          that wrote the log; an id outside its flash image prints as
+ *          `<id 0x...>`.
+ *          Usage: ws_logdecode firmware.elf [capture...]   (stdin without captures)
+ *                 ws_logdecode --self-test
+ */
+
+#include "ws_logtok.h"
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOGDEC_MAX_SEGMENTS 16U
+#define LOGDEC_LINE_MAX     512U
+#define LOGDEC_TEXT_MAX     320U
+
+/** @brief One loadable region of the firmware image */
+typedef struct {
+  uint32_t addr;
+  uint32_t size;
+  const uint8_t *data;
+} logdec_segment_t;
+
+/** @brief Firmware image the record ids point into */
+typedef struct {
+  logdec_segment_t seg[LOGDEC_MAX_SEGMENTS];
+  uint8_t count;
+  uint8_t *file;
+} logdec_image_t;
+
+/** @brief Wall-clock anchor from the last TIME record */
+typedef struct {
+  int have_time;
+  uint32_t tick;
+  time_t epoch;
+  unsigned long bad_records;
+} logdec_state_t;
+
+/**
+ * @brief Loads the PT_LOAD segments of a 32-bit little-endian ELF
+ * @retval 0 Success, 1 unreadable or not an ELF32 LE file
+ */
+static int logdec_load_elf(const char *path, logdec_image_t *img) {
+  FILE *f = fopen(path, "rb");
+  Elf32_Ehdr eh;
+  long size;
+
+  memset(img, 0, sizeof(*img));
+  if (f == NULL) {
+    perror(path);
+    return 1;
+  }
+  if ((fseek(f, 0L, SEEK_END) != 0) || ((size = ftell(f)) < (long)sizeof(eh)) || (fseek(f, 0L, SEEK_SET) != 0)) {
+    fclose(f);
+    fprintf(stderr, "%s: not an ELF file\n", path);
+    return 1;
+  }
+  img->file = malloc((size_t)size);
+  if ((img->file == NULL) || (fread(img->file, 1U, (size_t)size, f) != (size_t)size)) {
+    fclose(f);
+    fprintf(stderr, "%s: read failed\n", path);
+    return 1;
+  }
+  fclose(f);
+
+  memcpy(&eh, img->file, sizeof(eh));
+  if ((memcmp(eh.e_ident, ELFMAG, SELFMAG) != 0) || (eh.e_ident[EI_CLASS] != ELFCLASS32) ||
+      (eh.e_ident[EI_DATA] != ELFDATA2LSB) || (eh.e_phentsize != sizeof(Elf32_Phdr)) ||
+      ((unsigned long)eh.e_phoff + ((unsigned long)eh.e_phnum * sizeof(Elf32_Phdr)) > (unsigned long)size)) {
+    fprintf(stderr, "%s: not a 32-bit little-endian ELF file\n", path);
+    return 1;
+  }
+
+  for (uint16_t i = 0U; (i < eh.e_phnum) && (img->count < LOGDEC_MAX_SEGMENTS); i++) {
+    Elf32_Phdr ph;
+    memcpy(&ph, img->file + eh.e_phoff + ((size_t)i * sizeof(ph)), sizeof(ph));
+    if ((ph.p_type != PT_LOAD) || (ph.p_filesz == 0U) ||
+        ((unsigned long)ph.p_offset + ph.p_filesz > (unsigned long)size)) {
+      continue;
+    }
+    img->seg[img->count].addr = ph.p_vaddr;
+    img->seg[img->count].size = ph.p_filesz;
+    img->seg[img->count].data = img->file + ph.p_offset;
+    img->count++;
+  }
+  return 0;
+}
+
+/** @brief Returns the NUL-terminated string at flash address @p addr, or NULL */
+static const char *logdec_string(const logdec_image_t *img, uint32_t addr) {
+  for (uint8_t i = 0U; i < img->count; i++) {
+    const logdec_segment_t *s = &img->seg[i];
+    if ((addr >= s->addr) && ((addr - s->addr) < s->size)) {
+      const char *str = (const char *)&s->data[addr - s->addr];
+      if (memchr(str, '\0', s->size - (addr - s->addr)) != NULL) {
+        return str;
+      }
+    }
+  }
+  return NULL;
+}
+
+/** @brief Expands a printf format with integer and string-address arguments */
+static void logdec_format(const logdec_image_t *img, const char *fmt, const WS_LogTok_Record_t *rec,
+                          char *out, size_t size) {
+  size_t len = 0U;
+  uint8_t arg = 0U;
+
+  out[0] = '\0';
+  while ((*fmt != '\0') && (len + 1U < size)) {
+    char spec[16];
+    size_t n = 0U;
+    const char *conv;
+
+    if (*fmt != '%') {
+      out[len++] = *fmt++;
+      out[len] = '\0';
+      continue;
+    }
+    spec[n++] = *fmt++;
+    while ((*fmt != '\0') && (strchr("-+ #0123456789", *fmt) != NULL) && (n < sizeof(spec) - 3U)) {
+      spec[n++] = *fmt++;
+    }
+    while ((*fmt == 'l') || (*fmt == 'h')) {
+      fmt++;
+    }
+    conv = fmt;
+    if (*conv == '\0') {
+      break;
+    }
+    fmt++;
+    if (*conv == '%') {
+      out[len++] = '%';
+      out[len] = '\0';
+      continue;
+    }
+    if (arg >= rec->nargs) {
+      len += (size_t)snprintf(&out[len], size - len, "?");
+    } else if (*conv == 's') {
+      const char *s = logdec_string(img, (uint32_t)rec->args[arg]);
+      spec[n++] = 's';
+      spec[n] = '\0';
+      len += (size_t)snprintf(&out[len], size - len, spec, (s != NULL) ? s : "?");
+    } else if (strchr("di", *conv) != NULL) {
+      spec[n++] = 'l';
+      spec[n++] = *conv;
+      spec[n] = '\0';
+      len += (size_t)snprintf(&out[len], size - len, spec, (long)rec->args[arg]);
+    } else if (strchr("uxXc", *conv) != NULL) {
+      if (*conv != 'c') {
+        spec[n++] = 'l';
+      }
+      spec[n++] = *conv;
+      spec[n] = '\0';
+      if (*conv == 'c') {
+        len += (size_t)snprintf(&out[len], size - len, spec, (int)rec->args[arg]);
+      } else {
+        len += (size_t)snprintf(&out[len], size - len, spec, (unsigned long)(uint32_t)rec->args[arg]);
+      }
+    } else {
+      len += (size_t)snprintf(&out[len], size - len, "?");
+    }
+    arg++;
+    if (len >= size) {
+      len = size - 1U;
+    }
+  }
+}
+
+/** @brief Prints one decoded record as a text log line */
+static void logdec_print(const logdec_image_t *img, logdec_state_t *st, const WS_LogTok_Record_t *rec, FILE *out) {
+  char text[LOGDEC_TEXT_MAX];
+  const char *str = NULL;
+
+  if (rec->kind == (uint8_t)WS_LOGTOK_TIME) {
+    struct tm tm_utc;
+    if (rec->nargs < 2U) {
+      st->bad_records++;
+      return;
+    }
+    memset(&tm_utc, 0, sizeof(tm_utc));
+    tm_utc.tm_year = (int)(rec->args[0] / 10000) - 1900;
+    tm_utc.tm_mon = (int)((rec->args[0] / 100) % 100) - 1;
+    tm_utc.tm_mday = (int)(rec->args[0] % 100);
+    tm_utc.tm_hour = (int)(rec->args[1] / 10000);
+    tm_utc.tm_min = (int)((rec->args[1] / 100) % 100);
+    tm_utc.tm_sec = (int)(rec->args[1] % 100);
+    st->epoch = timegm(&tm_utc);
+    st->tick = rec->tick;
+    st->have_time = 1;
+    return;
+  }
+
+  str = logdec_string(img, (uint32_t)(rec->id + WS_LOGTOK_ID_BASE));
+  if (str == NULL) {
+    (void)snprintf(text, sizeof(text), "<id 0x%06lX>", (unsigned long)rec->id);
+  } else if ((rec->kind == (uint8_t)WS_LOGTOK_VALUE) && (rec->nargs >= 1U)) {
+    (void)snprintf(text, sizeof(text), "%s%ld", str, (long)rec->args[0]);
+  } else if ((rec->kind == (uint8_t)WS_LOGTOK_HEX) && (rec->nargs >= 1U)) {
+    (void)snprintf(text, sizeof(text), "%s0x%08lX", str, (unsigned long)(uint32_t)rec->args[0]);
+  } else if (rec->kind == (uint8_t)WS_LOGTOK_FMT) {
+    logdec_format(img, str, rec, text, sizeof(text));
+  } else {
+    (void)snprintf(text, sizeof(text), "%s", str);
+  }
+
+  if (st->have_time != 0) {
+    time_t when = st->epoch + (time_t)((int32_t)(rec->tick - st->tick) / 1000);
+    struct tm tm_utc;
+    gmtime_r(&when, &tm_utc);
+    fprintf(out, "LOG:[%04d-%02d-%02d %02d:%02d:%02d] %s\n", tm_utc.tm_year + 1900, tm_utc.tm_mon + 1,
+            tm_utc.tm_mday, tm_utc.tm_hour, tm_utc.tm_min, tm_utc.tm_sec, text);
+  } else {
+    unsigned long s = (unsigned long)(rec->tick / 1000U);
+    fprintf(out, "LOG:[%02lu:%02lu:%02lu] %s\n", s / 3600UL, (s / 60UL) % 60UL, s % 60UL, text);
+  }
+}
+
+/** @brief Decodes one stream; text lines pass through, record lines are expanded */
+static void logdec_stream(const logdec_image_t *img, logdec_state_t *st, FILE *in, FILE *out) {
+  uint8_t line[LOGDEC_LINE_MAX];
+  size_t len = 0U;
+  int c;
+
+  do {
+    c = fgetc(in);
+    if ((c != EOF) && (c != '\n')) {
+      if (len < sizeof(line)) {
+        line[len++] = (uint8_t)c;
+      }
+      continue;
+    }
+    if ((len > 0U) && (line[0] == WS_LOGTOK_SYNC)) {
+      WS_LogTok_Record_t rec;
+      if (WS_LogTok_Decode(line, len, &rec)) {
+        logdec_print(img, st, &rec, out);
+      } else {
+        st->bad_records++;
+      }
+    } else if (len > 0U) {
+      if (line[len - 1U] == '\r') {
+        len--;
+      }
+      fwrite(line, 1U, len, out);
+      fputc('\n', out);
+    }
+    len = 0U;
+  } while (c != EOF);
+}
+
+/** @brief Round-trips random records through the firmware encoder/decoder */
+static int logdec_check_roundtrip(void) {
+  uint8_t line[WS_LOGTOK_LINE_MAX];
+  WS_LogTok_Record_t rec;
+  WS_LogTok_Record_t back;
+  uint16_t len;
+
+  srand(1U);
+  for (uint32_t n = 0U; n < 100000U; n++) {
+    rec.kind = (uint8_t)((uint32_t)rand() % (uint32_t)WS_LOGTOK_KIND_COUNT);
+    rec.nargs = (uint8_t)((uint32_t)rand() % (WS_LOGTOK_MAX_ARGS + 1U));
+    rec.id = (n == 0U) ? 0xFFFFFFFFUL : ((uint32_t)rand() << 8) ^ (uint32_t)rand();
+    rec.tick = (n == 0U) ? 0xFFFFFFFFUL : ((uint32_t)rand() << 4) ^ (uint32_t)rand();
+    for (uint8_t i = 0U; i < WS_LOGTOK_MAX_ARGS; i++) {
+      rec.args[i] = (n == 0U) ? INT32_MIN : (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+    }
+    len = WS_LogTok_Encode(&rec, line, sizeof(line));
+    if ((len < 2U) || (line[len - 1U] != '\n') || (memchr(line, '\n', len - 1U) != NULL) ||
+        (memchr(line, '\r', len) != NULL) || !WS_LogTok_Decode(line, len - 1U, &back) ||
+        (back.kind != rec.kind) || (back.nargs != rec.nargs) || (back.id != rec.id) ||
+        (back.tick != rec.tick) || (memcmp(back.args, rec.args, rec.nargs * sizeof(rec.args[0])) != 0)) {
+      fprintf(stderr, "round trip failed at record %lu\n", (unsigned long)n);
+      return 1;
+    }
+    line[1U + ((uint32_t)rand() % (len - 2U))] ^= 0x01U;
+    if (WS_LogTok_Decode(line, len - 1U, &back) && (back.kind == rec.kind) && (back.id == rec.id) &&
+        (back.tick == rec.tick) && (back.nargs == rec.nargs) &&
+        (memcmp(back.args, rec.args, rec.nargs * sizeof(rec.args[0])) == 0)) {
+      fprintf(stderr, "corrupted record %lu decoded unchanged\n", (unsigned long)n);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Writes a one-segment ELF holding @p strings, captures records and checks the decoded text */
+static int logdec_self_test(void) {
+  static const char strings[] = "WEATHER STATION BOOT\0SD:WRITES=\0RESET:CSR=\0VIEW:%u->%u\0"
+                                "INIT:SENSOR_FAIL %s (0x%02X)\0BME280\0";
+  static const char expected[] =
+      "LOG:[00:00:01] WEATHER STATION BOOT\n"
+      "LOG:[00:00:02] SD:WRITES=-42\n"
+      "ACK:PING\n"
+      "LOG:[00:00:03] RESET:CSR=0x0A0D1B1E\n"
+      "LOG:[2026-05-09 11:06:01] VIEW:3->5\n"
+      "LOG:[2026-05-09 11:06:03] INIT:SENSOR_FAIL BME280 (0x08)\n"
+      "LOG:[2026-05-09 11:06:03] <id 0x7FFFFF>\n";
+  const uint32_t seg_addr = WS_LOGTOK_ID_BASE + 0x1000UL;
+  const uint32_t off_boot = 0U;
+  const uint32_t off_writes = 21U;
+  const uint32_t off_csr = 32U;
+  const uint32_t off_view = 43U;
+  const uint32_t off_fail = 55U;
+  const uint32_t off_bme = 84U;
+  const WS_LogTok_Record_t recs[] = {
+      {WS_LOGTOK_TEXT, 0U, 0x1000UL + off_boot, 1500U, {0}},
+      {WS_LOGTOK_VALUE, 1U, 0x1000UL + off_writes, 2000U, {-42}},
+      {WS_LOGTOK_HEX, 1U, 0x1000UL + off_csr, 3999U, {0x0A0D1B1E}},
+      {WS_LOGTOK_TIME, 2U, 0U, 5000U, {20260509, 110601}},
+      {WS_LOGTOK_FMT, 2U, 0x1000UL + off_view, 5000U, {3, 5}},
+      {WS_LOGTOK_FMT, 2U, 0x1000UL + off_fail, 7500U, {(int32_t)(seg_addr + off_bme), 8}},
+      {WS_LOGTOK_TEXT, 0U, 0x7FFFFFUL, 7999U, {0}},
+  };
+  char actual[1024];
+  char elf_path[] = "/tmp/ws_logdecode_XXXXXX";
+  logdec_image_t img;
+  logdec_state_t st;
+  Elf32_Ehdr eh;
+  Elf32_Phdr ph;
+  FILE *capture;
+  FILE *out;
+  FILE *f;
+  size_t n;
+  int fd;
+
+  if (logdec_check_roundtrip() != 0) {
+    return 1;
+  }
+  if ((strcmp(&strings[off_writes], "SD:WRITES=") != 0) || (strcmp(&strings[off_bme], "BME280") != 0)) {
+    fprintf(stderr, "string table offsets out of date\n");
+    return 1;
+  }
+
+  memset(&eh, 0, sizeof(eh));
+  memcpy(eh.e_ident, ELFMAG, SELFMAG);
+  eh.e_ident[EI_CLASS] = ELFCLASS32;
+  eh.e_ident[EI_DATA] = ELFDATA2LSB;
+  eh.e_ident[EI_VERSION] = EV_CURRENT;
+  eh.e_type = ET_EXEC;
+  eh.e_machine = EM_ARM;
+  eh.e_version = EV_CURRENT;
+  eh.e_phoff = sizeof(eh);
+  eh.e_ehsize = sizeof(eh);
+  eh.e_phentsize = sizeof(ph);
+  eh.e_phnum = 1U;
+  memset(&ph, 0, sizeof(ph));
+  ph.p_type = PT_LOAD;
+  ph.p_offset = sizeof(eh) + sizeof(ph);
+  ph.p_vaddr = seg_addr;
+  ph.p_paddr = seg_addr;
+  ph.p_filesz = sizeof(strings);
+  ph.p_memsz = sizeof(strings);
+
+  fd = mkstemp(elf_path);
+  f = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+  if (f == NULL) {
+    perror("mkstemp");
+    return 1;
+  }
+  fwrite(&eh, 1U, sizeof(eh), f);
+  fwrite(&ph, 1U, sizeof(ph), f);
+  fwrite(strings, 1U, sizeof(strings), f);
+  fclose(f);
+  n = (size_t)logdec_load_elf(elf_path, &img);
+  remove(elf_path);
+  if ((n != 0U) || (img.count != 1U)) {
+    fprintf(stderr, "ELF load failed\n");
+    return 1;
+  }
+
+  capture = tmpfile();
+  out = tmpfile();
+  if ((capture == NULL) || (out == NULL)) {
+    perror("tmpfile");
+    return 1;
+  }
+  for (size_t i = 0U; i < sizeof(recs) / sizeof(recs[0]); i++) {
+    uint8_t line[WS_LOGTOK_LINE_MAX];
+    uint16_t len = WS_LogTok_Encode(&recs[i], line, sizeof(line));
+    if (len == 0U) {
+      fprintf(stderr, "encode failed\n");
+      return 1;
+    }
+    fwrite(line, 1U, len, capture);
+    if (i == 1U) {
+      fputs("ACK:PING\r\n", capture);
+      line[2] ^= 0x40U;
+      fwrite(line, 1U, len, capture);
+    }
+  }
+
+  memset(&st, 0, sizeof(st));
+  rewind(capture);
+  logdec_stream(&img, &st, capture, out);
+  rewind(out);
+  n = fread(actual, 1U, sizeof(actual) - 1U, out);
+  actual[n] = '\0';
+  fclose(capture);
+  fclose(out);
+  free(img.file);
+
+  if ((strcmp(actual, expected) != 0) || (st.bad_records != 1U)) {
+    fprintf(stderr, "mismatch (%lu bad records):\n%s\nexpected:\n%s", st.bad_records, actual, expected);
+    return 1;
+  }
+  printf("ws_logdecode self-test OK\n");
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  logdec_image_t img;
+  logdec_state_t st;
+
+  if ((argc == 2) && (strcmp(argv[1], "--self-test") == 0)) {
+    return logdec_self_test();
+  }
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s firmware.elf [capture...]\n"
+                    "       %s --self-test\n", argv[0], argv[0]);
+    return 2;
+  }
+  if (logdec_load_elf(argv[1], &img) != 0) {
+    return 2;
+  }
+
+  memset(&st, 0, sizeof(st));
+  if (argc == 2) {
+    logdec_stream(&img, &st, stdin, stdout);
+  }
+  for (int i = 2; i < argc; i++) {
+    FILE *f = fopen(argv[i], "rb");
+    if (f == NULL) {
+      perror(argv[i]);
+      return 2;
+    }
+    logdec_stream(&img, &st, f, stdout);
+    fclose(f);
+  }
+  if (st.bad_records != 0U) {
+    fprintf(stderr, "%lu corrupt records skipped\n", st.bad_records);
+  }
+  free(img.file);
+  return 0;
+}
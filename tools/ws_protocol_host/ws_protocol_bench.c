@@ -0,0 +1,162 @@
+/**
+ * @file ws_protocol_bench.c
+ * @brief Host micro-benchmark for the shared nRF24 payload protocol
+ * @details Reports frames/sec and ns/frame for WS_Protocol_Encode (v1),
+ *          WS_Protocol_EncodeV2, WS_Protocol_Decode and WS_Reading_Get on
+ *          full frames.
+ *          Usage: ws_protocol_bench [iterations]
+ */
+
+#include "ws_protocol.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_ITERATIONS 1000000UL
+
+/** @brief Defeats dead-code elimination of benchmarked results */
+static volatile uint32_t bench_sink;
+
+static double bench_now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static void bench_report(const char *name, unsigned long iterations, double elapsed_s) {
+  double per_s = (elapsed_s > 0.0) ? ((double)iterations / elapsed_s) : 0.0;
+  double ns = (iterations > 0UL) ? ((elapsed_s * 1e9) / (double)iterations) : 0.0;
+  printf("%-24s %12.0f frames/s %10.1f ns/frame\n", name, per_s, ns);
+}
+
+/** @brief Builds a frame with up to @p max_count readings */
+static void bench_fill_readings(WS_Readings_t *r, uint8_t max_count) {
+  static const uint8_t channels[] = {
+      WS_CH_SI7021_TEMP, WS_CH_SI7021_HUM, WS_CH_BMP280_TEMP,
+      WS_CH_BMP280_PRESS, WS_CH_TSL2561_LUX, WS_CH_BME280_TEMP,
+      WS_CH_BME280_PRESS, WS_CH_BME280_HUM,
+  };
+  static const float values[] = {
+      21.53f, 48.2f, 21.61f, 1013.27f, 1250.0f, 21.47f, 1013.31f, 47.9f,
+  };
+
+  r->sensor_status = WS_SENSOR_OK;
+  r->count = 0U;
+  for (uint8_t i = 0U; (i < max_count) && (i < sizeof(channels)); i++) {
+    r->readings[i].channel_id = channels[i];
+    r->readings[i].value = values[i];
+    r->count++;
+  }
+}
+
+int main(int argc, char **argv) {
+  unsigned long iterations = BENCH_DEFAULT_ITERATIONS;
+  if (argc > 1) {
+    iterations = strtoul(argv[1], NULL, 0);
+    if (iterations == 0UL) {
+      fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (!WS_Protocol_SelfCheck()) {
+    fprintf(stderr, "WS_Protocol_SelfCheck failed\n");
+    return 1;
+  }
+
+  WS_Readings_t in;
+  WS_Readings_t in_v2;
+  WS_Readings_t out;
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t buf_v2[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t len = 0U;
+  uint8_t len_v2 = 0U;
+  bench_fill_readings(&in, WS_PROTOCOL_V1_MAX_READINGS);
+  bench_fill_readings(&in_v2, WS_MAX_READINGS);
+
+  if (!WS_Protocol_Encode(&in, buf, sizeof(buf), &len) || !WS_Protocol_Decode(buf, len, &out) ||
+      !WS_Protocol_EncodeV2(&in_v2, buf_v2, sizeof(buf_v2), &len_v2) ||
+      !WS_Protocol_Decode(buf_v2, len_v2, &out)) {
+    fprintf(stderr, "reference frame does not round-trip\n");
+    return 1;
+  }
+
+  printf("ws_protocol v1: %u readings, %u B frame\n", (unsigned)in.count, (unsigned)len);
+  printf("ws_protocol v2: %u readings, %u B frame\n", (unsigned)in_v2.count, (unsigned)len_v2);
+  printf("%lu iterations\n", iterations);
+
+  double t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    in.readings[0].value = (float)(i & 0xFFUL);
+    (void)WS_Protocol_Encode(&in, buf, sizeof(buf), &len);
+    bench_sink += buf[3U + 1U];
+  }
+  bench_report("WS_Protocol_Encode", iterations, bench_now_s() - t0);
+
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    buf[1] = (uint8_t)i;
+    (void)WS_Protocol_Decode(buf, len, &out);
+    bench_sink += out.sensor_status;
+  }
+  bench_report("WS_Protocol_Decode v1", iterations, bench_now_s() - t0);
+
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    in_v2.readings[0].value = (float)(i & 0xFFUL);
+    (void)WS_Protocol_EncodeV2(&in_v2, buf_v2, sizeof(buf_v2), &len_v2);
+    bench_sink += buf_v2[3];
+  }
+  bench_report("WS_Protocol_EncodeV2", iterations, bench_now_s() - t0);
+
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    buf_v2[1] = (uint8_t)i;
+    (void)WS_Protocol_Decode(buf_v2, len_v2, &out);
+    bench_sink += out.sensor_status;
+  }
+  bench_report("WS_Protocol_Decode v2", iterations, bench_now_s() - t0);
+
+  WS_DeltaKey_t tx_key;
+  WS_DeltaKey_t rx_key = {0};
+  uint8_t buf_key[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t len_key = 0U;
+  in_v2.readings[0].value = 21.53f;
+  if (!WS_Protocol_EncodeKeyframe(&in_v2, 1U, buf_key, sizeof(buf_key), &len_key, &tx_key) ||
+      !WS_Protocol_DecodeKeyed(buf_key, len_key, &rx_key, &out) ||
+      !WS_Protocol_EncodeDelta(&in_v2, &tx_key, buf, sizeof(buf), &len)) {
+    fprintf(stderr, "reference keyframe does not round-trip\n");
+    return 1;
+  }
+  printf("ws_protocol delta: %u readings, %u B frame (keyframe %u B)\n", (unsigned)in_v2.count,
+         (unsigned)len, (unsigned)len_key);
+
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    in_v2.readings[0].value = 21.53f + ((float)(i & 0x3FUL) * 0.01f);
+    (void)WS_Protocol_EncodeDelta(&in_v2, &tx_key, buf, sizeof(buf), &len);
+    bench_sink += buf[WS_PROTOCOL_KEY_HEADER_SIZE];
+  }
+  bench_report("WS_Protocol_EncodeDelta", iterations, bench_now_s() - t0);
+
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    buf[1] = (uint8_t)i;
+    (void)WS_Protocol_DecodeKeyed(buf, len, &rx_key, &out);
+    bench_sink += out.sensor_status;
+  }
+  bench_report("WS_Protocol_DecodeKeyed", iterations, bench_now_s() - t0);
+
+  /* Worst case for the linear lookup: last channel of a full frame. */
+  uint8_t last_channel = out.readings[out.count - 1U].channel_id;
+  t0 = bench_now_s();
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    float value = 0.0f;
+    bench_sink += (uint32_t)WS_Reading_Get(&out, last_channel, &value);
+    out.sensor_status = (uint8_t)i;
+  }
+  bench_report("WS_Reading_Get", iterations, bench_now_s() - t0);
+
+  return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file ws_protocol_fuzz.c
+ * @brief libFuzzer / AFL entry point for the shared nRF24 payload protocol
+ * @details Every input is fed to WS_Protocol_Decode, WS_Protocol_DecodeKeyed,
+ *          WS_Protocol_DecodeBacklog, WS_Frag_Accept and WS_Cmd_DecodeMeasureEx
+ *          exactly as the radios hand payloads over (length clamped to one
+ *          nRF24 payload). Accepted frames must re-encode (same version) and
+ *          decode to the same readings; any mismatch aborts so the fuzzer
+ *          records it.
+ */
+
+#include "ws_protocol.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void fuzz_check(bool cond) {
+  if (!cond) {
+    abort();
+  }
+}
+
+static void fuzz_readings(const uint8_t *data, uint8_t len) {
+  WS_Readings_t out;
+  if (!WS_Protocol_Decode(data, len, &out)) {
+    return;
+  }
+  fuzz_check(out.count <= WS_MAX_READINGS);
+
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t enc_len = 0U;
+  if (data[0] == WS_PROTOCOL_VERSION_V2) {
+    fuzz_check(WS_Protocol_EncodeV2(&out, buf, sizeof(buf), &enc_len));
+    fuzz_check(memcmp(buf, data, WS_PROTOCOL_V2_HEADER_SIZE) == 0);
+  } else {
+    fuzz_check(out.count <= WS_PROTOCOL_V1_MAX_READINGS);
+    fuzz_check(WS_Protocol_Encode(&out, buf, sizeof(buf), &enc_len));
+  }
+  fuzz_check(enc_len <= len);
+
+  WS_Readings_t again;
+  fuzz_check(WS_Protocol_Decode(buf, enc_len, &again));
+  fuzz_check((again.count == out.count) && (again.sensor_status == out.sensor_status));
+  for (uint8_t i = 0U; i < out.count; i++) {
+    fuzz_check(again.readings[i].channel_id == out.readings[i].channel_id);
+    if (data[0] == WS_PROTOCOL_VERSION_V2) {
+      /* Re-quantizing is exact below 2^21 counts and within one count above. */
+      fuzz_check(fabsf(again.readings[i].value - out.readings[i].value) <=
+                 (fabsf(out.readings[i].value) * 1e-6f));
+    } else {
+      /* Compare bit patterns: NaN payloads must survive the round trip too. */
+      fuzz_check(memcmp(&again.readings[i].value, &out.readings[i].value, sizeof(float)) == 0);
+    }
+    fuzz_check(WS_Reading_Get(&out, out.readings[i].channel_id, NULL));
+  }
+}
+
+static void fuzz_fragment(const uint8_t *data, uint8_t len) {
+  /* Persists across inputs so sequences of fragments exercise reassembly. */
+  static WS_FragAssembly_t fa;
+  WS_FragResult_t res = WS_Frag_Accept(&fa, data, len);
+  if (res != WS_FRAG_COMPLETE) {
+    return;
+  }
+  fuzz_check(fa.readings.count <= WS_MAX_READINGS);
+  fuzz_check(fa.received_mask == (uint16_t)((1UL << fa.total) - 1UL));
+
+  /* Re-fragmenting the result must reproduce the same frame count. */
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t enc_len = 0U;
+  fuzz_check(WS_Protocol_FragmentCount(fa.readings.count) == fa.total);
+  for (uint8_t i = 0U; i < fa.total; i++) {
+    fuzz_check(WS_Protocol_EncodeFragment(&fa.readings, fa.seq, i, buf, sizeof(buf), &enc_len));
+  }
+}
+
+static void fuzz_keyed(const uint8_t *data, uint8_t len) {
+  /* Persists across inputs so delta frames meet the keyframe they refer to. */
+  static WS_DeltaKey_t key;
+  WS_DeltaKey_t before = key;
+  WS_Readings_t out;
+  if (!WS_Protocol_DecodeKeyed(data, len, &key, &out)) {
+    fuzz_check(memcmp(&before, &key, sizeof(key)) == 0);
+    return;
+  }
+  fuzz_check(out.count <= WS_MAX_READINGS);
+  if ((data[0] != WS_PROTOCOL_VERSION_KEY) && (data[0] != WS_PROTOCOL_VERSION_DELTA)) {
+    return;
+  }
+  fuzz_check((key.valid != 0U) && (key.key_seq == data[2]) && (key.channel_mask == data[3]));
+
+  /* Re-encoding as a delta against the same key must decode to the same values. */
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t enc_len = 0U;
+  WS_Readings_t again;
+  if (!WS_Protocol_EncodeDelta(&out, &key, buf, sizeof(buf), &enc_len)) {
+    return;
+  }
+  fuzz_check(WS_Protocol_DecodeKeyed(buf, enc_len, &key, &again));
+  fuzz_check((again.count == out.count) && (again.sensor_status == out.sensor_status));
+  for (uint8_t i = 0U; i < out.count; i++) {
+    fuzz_check(again.readings[i].channel_id == out.readings[i].channel_id);
+    fuzz_check(fabsf(again.readings[i].value - out.readings[i].value) <=
+               (fabsf(out.readings[i].value) * 1e-6f));
+  }
+}
+
+static void fuzz_backlog(const uint8_t *data, uint8_t len) {
+  WS_Readings_t out;
+  uint16_t age_s = 0U;
+  if (!WS_Protocol_DecodeBacklog(data, len, &age_s, &out)) {
+    return;
+  }
+  fuzz_check(out.count <= WS_MAX_READINGS);
+
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t enc_len = 0U;
+  WS_Readings_t again;
+  uint16_t age_again = 0U;
+  fuzz_check(WS_Protocol_EncodeBacklog(&out, age_s, buf, sizeof(buf), &enc_len));
+  fuzz_check((enc_len <= len) && (memcmp(buf, data, WS_PROTOCOL_BACKLOG_HEADER_SIZE) == 0));
+  fuzz_check(WS_Protocol_DecodeBacklog(buf, enc_len, &age_again, &again) && (age_again == age_s));
+  fuzz_check(again.count == out.count);
+  for (uint8_t i = 0U; i < out.count; i++) {
+    fuzz_check(again.readings[i].channel_id == out.readings[i].channel_id);
+    fuzz_check(fabsf(again.readings[i].value - out.readings[i].value) <=
+               (fabsf(out.readings[i].value) * 1e-6f));
+  }
+}
+
+static void fuzz_reply(const uint8_t *data, uint8_t len) {
+  const uint8_t *frame = NULL;
+  uint8_t frame_len = 0U;
+  uint8_t node_id = 0U;
+  if (!WS_Reply_Unwrap(data, len, &node_id, &frame, &frame_len)) {
+    fuzz_check(len <= WS_PROTOCOL_REPLY_HEADER_SIZE);
+    return;
+  }
+  fuzz_check((frame == &data[WS_PROTOCOL_REPLY_HEADER_SIZE]) && (frame_len <= WS_PROTOCOL_MAX_FRAME));
+
+  uint8_t buf[WS_PROTOCOL_MAX_PAYLOAD];
+  uint8_t out_len = 0U;
+  fuzz_check(WS_Reply_Wrap(node_id, frame, frame_len, buf, sizeof(buf), &out_len));
+  fuzz_check((out_len == len) && (memcmp(buf, data, len) == 0));
+}
+
+static void fuzz_command(const uint8_t *data, uint8_t len) {
+  uint8_t cycle_id = 0U;
+  WS_NodeMask_t mask = 0U;
+  if (!WS_Cmd_DecodeMeasureEx(data, len, &cycle_id, &mask)) {
+    return;
+  }
+  fuzz_check(mask != 0U);
+
+  uint8_t cmd[WS_CMD_SIZE];
+  uint8_t cycle_again = 0U;
+  WS_NodeMask_t mask_again = 0U;
+  WS_NodeMask_t key_mask = WS_Cmd_KeyframeMask(data, len);
+  uint32_t clock_s = WS_Cmd_GetClock(data, len);
+  fuzz_check(WS_Cmd_EncodeMeasureEx(cycle_id, mask, key_mask, cmd, sizeof(cmd)));
+  fuzz_check(WS_Cmd_SetClock(cmd, sizeof(cmd), clock_s) && (WS_Cmd_GetClock(cmd, sizeof(cmd)) == clock_s));
+  fuzz_check(WS_Cmd_DecodeMeasureEx(cmd, sizeof(cmd), &cycle_again, &mask_again));
+  fuzz_check((cycle_again == cycle_id) && (mask_again == mask));
+  fuzz_check(WS_Cmd_KeyframeMask(cmd, sizeof(cmd)) == key_mask);
+
+  uint16_t lead_ms = 0U;
+  uint8_t slot_ms = 0U;
+  if (WS_Cmd_GetSlots(data, len, &lead_ms, &slot_ms)) {
+    uint16_t lead_again = 0U;
+    uint8_t slot_again = 0U;
+    fuzz_check(slot_ms != 0U);
+    fuzz_check(WS_Cmd_SetSlots(cmd, sizeof(cmd), lead_ms, slot_ms));
+    fuzz_check(WS_Cmd_GetSlots(cmd, sizeof(cmd), &lead_again, &slot_again));
+    fuzz_check((lead_again == lead_ms) && (slot_again == slot_ms));
+  }
+
+  /* Every targeted node gets its own slot inside the window, late or not. */
+  WS_NodeMask_t late_mask = WS_Cmd_LateMask(data, len);
+  WS_NodeMask_t slots_taken = 0U;
+  fuzz_check(WS_Cmd_SetLateMask(cmd, sizeof(cmd), late_mask) && (WS_Cmd_LateMask(cmd, sizeof(cmd)) == late_mask));
+  for (uint8_t id = 0U; id < WS_NODE_MASK_BITS; id++) {
+    if ((mask & WS_NODE_BIT(id)) == 0U) {
+      continue;
+    }
+    uint8_t slot = WS_Cycle_SlotIndex(mask, late_mask, id);
+    fuzz_check(slot < WS_NODE_MASK_BITS);
+    fuzz_check((uint32_t)lead_ms + ((uint32_t)(slot + 1U) * slot_ms) <= WS_Cycle_WindowMs(mask, lead_ms, slot_ms));
+    fuzz_check((slots_taken & WS_NODE_BIT(slot)) == 0U);
+    slots_taken |= WS_NODE_BIT(slot);
+  }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  uint8_t len = (size > WS_PROTOCOL_MAX_PAYLOAD) ? (uint8_t)WS_PROTOCOL_MAX_PAYLOAD : (uint8_t)size;
+
+  /* Copy into an exact-size heap block so ASan catches any over-read. */
+  uint8_t *frame = (uint8_t *)malloc((len > 0U) ? len : 1U);
+  if (frame == NULL) {
+    return 0;
+  }
+  if (len > 0U) {
+    memcpy(frame, data, len);
+  }
+
+  fuzz_readings(frame, len);
+  fuzz_keyed(frame, len);
+  fuzz_backlog(frame, len);
+  fuzz_fragment(frame, len);
+  fuzz_command(frame, len);
+  fuzz_reply(frame, len);
+
+  free(frame);
+  return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file ws_protocol_fuzz_main.c
+ * @brief Standalone driver for ws_protocol_fuzz when libFuzzer is not linked
+ * @details Usage:
+ *            ws_protocol_fuzz FILE...         replay corpus files (AFL: @@)
+ *            ws_protocol_fuzz                 read one input from stdin
+ *            ws_protocol_fuzz --random N      N pseudo-random frames (ctest smoke)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_MAX_INPUT 4096U
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static int fuzz_run_stream(FILE *f) {
+  static uint8_t input[FUZZ_MAX_INPUT];
+  size_t n = fread(input, 1U, sizeof(input), f);
+  return LLVMFuzzerTestOneInput(input, n);
+}
+
+/** @brief xorshift32; deterministic so ctest failures are reproducible */
+static uint32_t fuzz_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+static int fuzz_run_random(unsigned long iterations) {
+  uint32_t state = 0x57A710U;
+  uint8_t input[40];
+
+  for (unsigned long i = 0UL; i < iterations; i++) {
+    size_t len = fuzz_next(&state) % sizeof(input);
+    for (size_t b = 0U; b < len; b++) {
+      input[b] = (uint8_t)fuzz_next(&state);
+    }
+    /* Bias towards well-formed headers so the decoders get past the first check. */
+    if ((len > 0U) && ((i & 1UL) == 0UL)) {
+      input[0] = (uint8_t)(0x01U + ((i >> 2) % 6UL));
+      if ((len > 2U) && ((i & 2UL) == 0UL) && (input[0] == 0x01U)) {
+        input[2] = (uint8_t)(fuzz_next(&state) % 8U);
+      }
+      if ((len > 4U) && (input[0] == 0x03U)) {
+        /* Small sequence/index space so fragments of one set actually meet. */
+        input[2] = (uint8_t)(fuzz_next(&state) & 1U);
+        input[3] = (uint8_t)(((fuzz_next(&state) & 1U) << 4) | 2U);
+        input[4] = (uint8_t)(fuzz_next(&state) % 6U);
+      }
+      if ((len > 3U) && ((input[0] == 0x04U) || (input[0] == 0x05U))) {
+        /* Few keys and channel sets so deltas find a matching keyframe. */
+        input[2] = (uint8_t)(fuzz_next(&state) & 1U);
+        input[3] = (uint8_t)((fuzz_next(&state) & 1U) ? 0x09U : 0x1BU);
+      }
+    }
+    (void)LLVMFuzzerTestOneInput(input, len);
+  }
+  printf("ws_protocol_fuzz: %lu random inputs OK\n", iterations);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if ((argc == 3) && (strcmp(argv[1], "--random") == 0)) {
+    return fuzz_run_random(strtoul(argv[2], NULL, 0));
+  }
+
+  if (argc < 2) {
+    return fuzz_run_stream(stdin);
+  }
+
+  for (int i = 1; i < argc; i++) {
+    FILE *f = fopen(argv[i], "rb");
+    if (f == NULL) {
+      perror(argv[i]);
+      return 2;
+    }
+    (void)fuzz_run_stream(f);
+    fclose(f);
+  }
+  return 0;
+}